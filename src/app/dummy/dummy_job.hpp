@@ -27,6 +27,7 @@ public:
     void appl_dumpStats() override {}
     bool appl_isDestructible() override {return true;}
     void appl_memoryPanic() override {}
+    void appl_setNumActiveThreads(int) override {}
 };
 
 #endif
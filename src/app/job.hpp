@@ -4,6 +4,7 @@
 
 #include <string>
 #include <memory>
+#include <algorithm>
 #include "util/assert.hpp"
 #include <atomic>
 #include <list>
@@ -116,6 +117,12 @@ public:
     */
     virtual void appl_memoryPanic() = 0;
     /*
+    Run on the given number of threads (within [1, getNumThreads()]) from now on,
+    without restarting the job instance. Applications which cannot adjust their
+    number of threads on the fly may ignore this call.
+    */
+    virtual void appl_setNumActiveThreads(int nbThreads) = 0;
+    /*
     Return how many processes this job would like to run on based on its meta data 
     and its previous volume.
     This method must return an integer greater than 0 and no greater than _comm_size. 
@@ -161,6 +168,7 @@ private:
     bool _continuous_growth;
     int _max_demand;
     int _threads_per_job;
+    int _active_threads_per_job = -1;
     
     JobState _state;
     Mutex _job_manipulation_lock;
@@ -246,6 +254,14 @@ public:
     float getUsedCpuSeconds() const {return _used_cpu_seconds;}
     int getNumThreads() const {return _threads_per_job;}
     void setNumThreads(int nbThreads) {_threads_per_job = nbThreads;} 
+    int getNumActiveThreads() const {return _active_threads_per_job < 0 ? 
+        _threads_per_job : std::min(_active_threads_per_job, _threads_per_job);}
+    void setNumActiveThreads(int nbThreads) {
+        nbThreads = std::max(1, std::min(nbThreads, _threads_per_job));
+        if (nbThreads == getNumActiveThreads()) return;
+        _active_threads_per_job = nbThreads;
+        appl_setNumActiveThreads(nbThreads);
+    }
     int getBalancingEpochOfLastCommitment() const {return _balancing_epoch_of_last_commitment;}
     int getLastDemand() const {return _last_demand;}
     void setLastDemand(int demand) {_last_demand = demand;}
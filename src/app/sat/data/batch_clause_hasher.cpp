@@ -0,0 +1,128 @@
+
+#include "batch_clause_hasher.hpp"
+
+#include <cstdint>
+#include <immintrin.h>
+
+#include "clause.hpp"
+#include "util/assert.hpp"
+
+using namespace Mallob;
+
+namespace {
+
+    typedef void (*HashFunction)(const int*, int, size_t, size_t*, int);
+
+    void hashScalar(const int* lits, int clauseSize, size_t numClauses, size_t* out, int which) {
+        for (size_t i = 0; i < numClauses; i++)
+            out[i] = commutativeHash(lits + i*clauseSize, clauseSize, which);
+    }
+
+    // Each SIMD lane hashes one clause: the j-th literals of a group of consecutive clauses
+    // are gathered (stride: clause size), mapped to their terms lit * primes[(lit ^ which) & 15],
+    // and XORed into the lanes' hash values.
+
+    __attribute__((target("avx2")))
+    void hashAvx2(const int* lits, int clauseSize, size_t numClauses, size_t* out, int which) {
+        const __m256i primesLo = _mm256_loadu_si256((const __m256i*) COMMUTATIVE_HASH_PRIMES);
+        const __m256i primesHi = _mm256_loadu_si256((const __m256i*) (COMMUTATIVE_HASH_PRIMES+8));
+        const __m256i vWhich = _mm256_set1_epi32(which);
+        const __m256i vEight = _mm256_set1_epi32(8);
+        const __m256i offsets = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), 
+            _mm256_set1_epi32(clauseSize));
+        size_t i = 0;
+        for (; i+8 <= numClauses; i += 8) {
+            const int* group = lits + i*clauseSize;
+            __m256i h = _mm256_set1_epi32(1);
+            for (int j = 0; j < clauseSize; j++) {
+                __m256i vLits = _mm256_i32gather_epi32(group+j, offsets, 4);
+                __m256i idx = _mm256_xor_si256(vLits, vWhich);
+                // permutevar8x32 only uses the lowest three bits of each index:
+                // look up both halves of the table and select via the fourth bit
+                __m256i lo = _mm256_permutevar8x32_epi32(primesLo, idx);
+                __m256i hi = _mm256_permutevar8x32_epi32(primesHi, idx);
+                __m256i useHi = _mm256_cmpeq_epi32(_mm256_and_si256(idx, vEight), vEight);
+                __m256i primes = _mm256_blendv_epi8(lo, hi, useHi);
+                h = _mm256_xor_si256(h, _mm256_mullo_epi32(vLits, primes));
+            }
+            // Zero-extend the 32-bit hash values to size_t
+            _mm256_storeu_si256((__m256i*) (out+i), _mm256_cvtepu32_epi64(_mm256_castsi256_si128(h)));
+            _mm256_storeu_si256((__m256i*) (out+i+4), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(h, 1)));
+        }
+        hashScalar(lits + i*clauseSize, clauseSize, numClauses-i, out+i, which);
+    }
+
+    __attribute__((target("avx512f")))
+    void hashAvx512(const int* lits, int clauseSize, size_t numClauses, size_t* out, int which) {
+        const __m512i primes = _mm512_loadu_si512((const void*) COMMUTATIVE_HASH_PRIMES);
+        const __m512i vWhich = _mm512_set1_epi32(which);
+        const __m512i offsets = _mm512_mullo_epi32(_mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 
+            8, 9, 10, 11, 12, 13, 14, 15), _mm512_set1_epi32(clauseSize));
+        size_t i = 0;
+        for (; i+16 <= numClauses; i += 16) {
+            const int* group = lits + i*clauseSize;
+            __m512i h = _mm512_set1_epi32(1);
+            for (int j = 0; j < clauseSize; j++) {
+                __m512i vLits = _mm512_i32gather_epi32(offsets, group+j, 4);
+                // permutexvar uses the lowest four bits of each index, i.e., (lit ^ which) & 15
+                __m512i p = _mm512_permutexvar_epi32(_mm512_xor_si512(vLits, vWhich), primes);
+                h = _mm512_xor_si512(h, _mm512_mullo_epi32(vLits, p));
+            }
+            // Zero-extend the 32-bit hash values to size_t
+            _mm512_storeu_si512((void*) (out+i), _mm512_cvtepu32_epi64(_mm512_castsi512_si256(h)));
+            _mm512_storeu_si512((void*) (out+i+8), _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(h, 1)));
+        }
+        hashScalar(lits + i*clauseSize, clauseSize, numClauses-i, out+i, which);
+    }
+
+    HashFunction getHashFunction(BatchClauseHasher::Isa isa) {
+        switch (isa) {
+        case BatchClauseHasher::AVX512: return hashAvx512;
+        case BatchClauseHasher::AVX2: return hashAvx2;
+        default: return hashScalar;
+        }
+    }
+
+    BatchClauseHasher::Isa detectIsa() {
+        if (BatchClauseHasher::isSupported(BatchClauseHasher::AVX512)) return BatchClauseHasher::AVX512;
+        if (BatchClauseHasher::isSupported(BatchClauseHasher::AVX2)) return BatchClauseHasher::AVX2;
+        return BatchClauseHasher::SCALAR;
+    }
+
+    BatchClauseHasher::Isa _isa = detectIsa();
+    HashFunction _hash = getHashFunction(_isa);
+}
+
+void BatchClauseHasher::commutativeHashes(const int* lits, int clauseSize, size_t numClauses, size_t* out, int which) {
+    // (gather offsets must fit into 32-bit integers)
+    if (clauseSize <= 0 || clauseSize > (1<<20)) hashScalar(lits, clauseSize, numClauses, out, which);
+    else _hash(lits, clauseSize, numClauses, out, which);
+}
+
+BatchClauseHasher::Isa BatchClauseHasher::getIsa() {
+    return _isa;
+}
+
+bool BatchClauseHasher::isSupported(Isa isa) {
+    // May be called during static initialization
+    __builtin_cpu_init();
+    switch (isa) {
+    case AVX512: return __builtin_cpu_supports("avx512f");
+    case AVX2: return __builtin_cpu_supports("avx2");
+    default: return true;
+    }
+}
+
+void BatchClauseHasher::setIsa(Isa isa) {
+    assert(isSupported(isa));
+    _isa = isa;
+    _hash = getHashFunction(isa);
+}
+
+const char* BatchClauseHasher::getIsaName(Isa isa) {
+    switch (isa) {
+    case AVX512: return "avx512";
+    case AVX2: return "avx2";
+    default: return "scalar";
+    }
+}
@@ -0,0 +1,33 @@
+
+#pragma once
+
+#include <cstddef>
+
+namespace Mallob {
+
+    // Computes Mallob::commutativeHash for many clauses of the same length at once,
+    // as they occur in each bucket of a clause buffer. Each SIMD lane computes the hash
+    // of one clause, so a group of 8 (AVX2) or 16 (AVX-512) clauses is hashed with
+    // one vector operation per literal position. The results are bit-identical to
+    // commutativeHash, so the hashes can be mixed freely with hashes computed one clause
+    // at a time (also across machines which use different instruction sets).
+    // The instruction set (AVX-512, AVX2, or scalar) is selected once at runtime
+    // depending on the capabilities of the CPU.
+    class BatchClauseHasher {
+
+    public:
+        enum Isa {SCALAR, AVX2, AVX512};
+
+        // Writes the commutative hashes of numClauses consecutive clauses of clauseSize literals
+        // each (beginning at lits) to out[0], ..., out[numClauses-1].
+        static void commutativeHashes(const int* lits, int clauseSize, size_t numClauses, size_t* out, int which = 3);
+
+        // The instruction set used by commutativeHashes.
+        static Isa getIsa();
+        // Whether the provided instruction set is supported by this CPU.
+        static bool isSupported(Isa isa);
+        // Overrides the selected instruction set (which must be supported), e.g., for benchmarks.
+        static void setIsa(Isa isa);
+        static const char* getIsaName(Isa isa);
+    };
+}
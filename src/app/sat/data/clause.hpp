@@ -46,17 +46,19 @@ namespace Mallob {
         }
     };
 
+    inline constexpr unsigned int COMMUTATIVE_HASH_PRIMES[] = 
+        {2038072819, 2038073287, 2038073761, 2038074317,
+        2038072823,	2038073321,	2038073767, 2038074319,
+        2038072847,	2038073341,	2038073789,	2038074329,
+        2038074751,	2038075231,	2038075751,	2038076267};
+
+    // For hashing many clauses of the same length at once, see BatchClauseHasher
+    // (batch_clause_hasher.hpp) which computes identical hash values.
     inline size_t commutativeHash(const int* begin, int size, int which = 3) {
-        static unsigned const int primes [] = 
-            {2038072819, 2038073287, 2038073761, 2038074317,
-            2038072823,	2038073321,	2038073767, 2038074319,
-            2038072847,	2038073341,	2038073789,	2038074329,
-            2038074751,	2038075231,	2038075751,	2038076267};
-        
         size_t res = 1;
         for (auto it = begin; it != begin+size; it++) {
             int lit = *it;
-            res ^= lit * primes[abs((lit^which) & 15)];
+            res ^= lit * COMMUTATIVE_HASH_PRIMES[(lit^which) & 15];
         }
         return res;
     }
@@ -76,7 +78,8 @@ namespace Mallob {
         
         size_t res = robin_hood::hash_int(size * which);
         for (size_t i = 0; i < size; i++) {
-            hash_combine(res, begin[i]);
+            // same as hash_combine(res, begin[i]), without the static hasher object
+            res ^= robin_hood::hash_int(static_cast<uint64_t>(begin[i])) + 0x9e3779b9 + (res<<6) + (res>>2);
         }
         return res;
     }
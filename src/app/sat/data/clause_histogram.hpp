@@ -30,6 +30,10 @@ public:
         _total.fetch_add(by, std::memory_order_relaxed);
     }
 
+    unsigned long long getTotal() const {
+        return _total.load(std::memory_order_relaxed);
+    }
+
     std::string getReport() {
 
         // Find last position where actual information is stored
@@ -0,0 +1,136 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+// Counts of clauses offered to the solvers in clause sharing, and how many of them
+// were accepted, i.e., the receiving solver had the import budget to take them in.
+// This does not tell whether a solver went on to make use of an accepted clause:
+// the solver backends report no such counts.
+// Clauses which did not pass the global filter or which the receiving solver produced
+// itself are not counted: such redundancy is compensated for separately, by the
+// sharing compensation factor. The counts are kept per bucket of clause length
+// (1, 2, 3-4, 5-8, 9-16, 17+) and LBD (1-2, 3-4, 5+).
+struct ImportAcceptance {
+
+	static const int NUM_LENGTH_BUCKETS = 6;
+	static const int NUM_LBD_BUCKETS = 3;
+	static const int NUM_BUCKETS = NUM_LENGTH_BUCKETS * NUM_LBD_BUCKETS;
+	static const int SERIALIZED_SIZE = 2*NUM_BUCKETS;
+
+	unsigned long received[NUM_BUCKETS] = {0};
+	unsigned long accepted[NUM_BUCKETS] = {0};
+
+	static int getLengthBucket(int clauseLength) {
+		int bucket = 0;
+		while (bucket+1 < NUM_LENGTH_BUCKETS && clauseLength > (1 << bucket)) bucket++;
+		return bucket;
+	}
+	// (The last bucket has no upper limit.)
+	static int getMaxLength(int lengthBucket) {
+		return 1 << lengthBucket;
+	}
+	static int getLbdBucket(int lbd) {
+		int bucket = 0;
+		while (bucket+1 < NUM_LBD_BUCKETS && lbd > getMaxLbd(bucket)) bucket++;
+		return bucket;
+	}
+	// (The last bucket has no upper limit.)
+	static int getMaxLbd(int lbdBucket) {
+		return 2 * (lbdBucket+1);
+	}
+	static int getBucket(int clauseLength, int lbd) {
+		return getLengthBucket(clauseLength) * NUM_LBD_BUCKETS + getLbdBucket(lbd);
+	}
+
+	void add(int clauseLength, int lbd, bool isAccepted) {
+		int bucket = getBucket(clauseLength, lbd);
+		received[bucket]++;
+		if (isAccepted) accepted[bucket]++;
+	}
+
+	void aggregate(const ImportAcceptance& other) {
+		for (int b = 0; b < NUM_BUCKETS; b++) {
+			received[b] += other.received[b];
+			accepted[b] += other.accepted[b];
+		}
+	}
+
+	// Returns the counts collected since the given earlier state of the same counters.
+	// If the counters were reset in between (e.g., by a restarted process), all counts are returned.
+	ImportAcceptance getDifference(const ImportAcceptance& earlier) const {
+		ImportAcceptance diff;
+		for (int b = 0; b < NUM_BUCKETS; b++) {
+			if (received[b] < earlier.received[b] || accepted[b] < earlier.accepted[b]) return *this;
+			diff.received[b] = received[b] - earlier.received[b];
+			diff.accepted[b] = accepted[b] - earlier.accepted[b];
+		}
+		return diff;
+	}
+
+	unsigned long getNumReceived() const {
+		unsigned long sum = 0;
+		for (int b = 0; b < NUM_BUCKETS; b++) sum += received[b];
+		return sum;
+	}
+	unsigned long getNumAccepted() const {
+		unsigned long sum = 0;
+		for (int b = 0; b < NUM_BUCKETS; b++) sum += accepted[b];
+		return sum;
+	}
+	// Share of accepted clauses overall, within a length bucket (over all LBDs),
+	// or within an LBD bucket (over all lengths); -1 if there were no clauses
+	float getAcceptedShare() const {
+		return getShare([](int) {return true;});
+	}
+	float getAcceptedShareOfLength(int lengthBucket) const {
+		return getShare([&](int b) {return b / NUM_LBD_BUCKETS == lengthBucket;});
+	}
+	float getAcceptedShareOfLbd(int lbdBucket) const {
+		return getShare([&](int b) {return b % NUM_LBD_BUCKETS == lbdBucket;});
+	}
+
+	// Appends the counts to the given buffer.
+	void serializeTo(std::vector<int>& buffer) const {
+		for (int b = 0; b < NUM_BUCKETS; b++) {
+			buffer.push_back((int) received[b]);
+			buffer.push_back((int) accepted[b]);
+		}
+	}
+	// Reads the counts from the end of the given buffer and removes them.
+	void deserializeFrom(std::vector<int>& buffer) {
+		if (buffer.size() < SERIALIZED_SIZE) return;
+		size_t pos = buffer.size() - SERIALIZED_SIZE;
+		for (int b = 0; b < NUM_BUCKETS; b++) {
+			received[b] = (unsigned int) buffer[pos++];
+			accepted[b] = (unsigned int) buffer[pos++];
+		}
+		buffer.resize(buffer.size() - SERIALIZED_SIZE);
+	}
+
+	// Accepted / received clauses by length bucket, each with one entry per LBD bucket
+	std::string getReport() const {
+		std::string out;
+		for (int l = 0; l < NUM_LENGTH_BUCKETS; l++) {
+			if (l > 0) out += " ";
+			for (int b = l*NUM_LBD_BUCKETS; b < (l+1)*NUM_LBD_BUCKETS; b++) {
+				if (b > l*NUM_LBD_BUCKETS) out += ",";
+				out += std::to_string(accepted[b]) + "/" + std::to_string(received[b]);
+			}
+		}
+		return out;
+	}
+
+private:
+	template <typename Predicate>
+	float getShare(Predicate includesBucket) const {
+		unsigned long sumReceived = 0, sumAccepted = 0;
+		for (int b = 0; b < NUM_BUCKETS; b++) {
+			if (!includesBucket(b)) continue;
+			sumReceived += received[b];
+			sumAccepted += accepted[b];
+		}
+		return sumReceived == 0 ? -1 : (float)sumAccepted / sumReceived;
+	}
+};
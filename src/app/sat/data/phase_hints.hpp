@@ -0,0 +1,42 @@
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+
+#include "util/sys/threading.hpp"
+
+// The best (partial) assignment found by the local search solvers of a process
+// so far, offered to the process's CDCL solvers as variable phases.
+class PhaseHints {
+
+private:
+    Mutex _mtx;
+    // lit or -lit at position |lit|, zero at position zero
+    std::vector<int> _assignment;
+    // number of unsatisfied clauses under the assignment
+    int _num_unsat_clauses = -1;
+    std::atomic_int _version {0};
+
+public:
+    // Replaces the current hints if the provided assignment leaves fewer clauses unsatisfied.
+    void publish(std::vector<int>&& assignment, int numUnsatClauses) {
+        auto lock = _mtx.getLock();
+        if (_num_unsat_clauses >= 0 && numUnsatClauses >= _num_unsat_clauses) return;
+        _assignment = std::move(assignment);
+        _num_unsat_clauses = numUnsatClauses;
+        _version++;
+    }
+
+    int getVersion() const {return _version.load(std::memory_order_relaxed);}
+
+    // Copies the current hints to the output if they are newer than the given version,
+    // which is then updated. Returns whether hints were copied.
+    bool fetch(int& knownVersion, std::vector<int>& assignmentOut) {
+        if (getVersion() == knownVersion) return false;
+        auto lock = _mtx.getLock();
+        assignmentOut = _assignment;
+        knownVersion = _version;
+        return true;
+    }
+};
@@ -14,6 +14,7 @@ struct SolverStatistics {
 	double memPeak = 0;
 	unsigned long imported = 0;
 	unsigned long discarded = 0;
+	double loadTime = 0; // seconds spent handing the formula to the solver
 	
 	// clause export
 	ClauseHistogram* histProduced;
@@ -42,7 +43,8 @@ struct SolverStatistics {
 			+ " (flt:" + std::to_string(receivedClausesFiltered)
 			+ " digd:" + std::to_string(receivedClausesDigested)
 			+ " drp:" + std::to_string(receivedClausesDropped)
-			+ ") + intim:" + std::to_string(imported) + "/" + std::to_string(imported+discarded);
+			+ ") + intim:" + std::to_string(imported) + "/" + std::to_string(imported+discarded)
+			+ " ld:" + std::to_string(loadTime);
 	}
 
 	void aggregate(const SolverStatistics& other) {
@@ -51,6 +53,7 @@ struct SolverStatistics {
 		conflicts += other.conflicts;
 		restarts += other.restarts;
 		memPeak += other.memPeak;
+		loadTime += other.loadTime;
 		producedClauses += other.producedClauses;
 		producedClausesAdmitted += other.producedClausesAdmitted;
 		producedClausesFiltered += other.producedClausesFiltered;
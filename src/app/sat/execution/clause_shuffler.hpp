@@ -1,53 +1,79 @@
-
 #pragma once
 
+#include <vector>
+#include <climits>
+
 #include "util/shuffle.hpp"
+#include "util/permutation.hpp"
+#include "util/assert.hpp"
 
+// Feeds the clauses of a formula in a pseudo-random order, with the literals of each
+// clause in a random order, without copying the formula: the clause order is given
+// by a bijection over the clause indices (AdjustablePermutation), and the literals
+// of a clause are only permuted when the clause is written to an output batch.
+// Apart from the output batch, only the start position of each clause is stored.
 class ClauseShuffler {
 
 private:
-    std::vector<int> _input;
-    std::vector<std::pair<size_t, int*>> _clauses;
+    const int* _input = nullptr;
+    std::vector<size_t> _clause_starts; // position of each clause, plus the end of the input
+    AdjustablePermutation _permutation;
+    bool _permute_clauses;
+    bool _permute_literals;
 
     std::mt19937 _rng;
     std::uniform_real_distribution<float> _dist;
     std::function<float()> _rng_func;
 
-    size_t _it;
+    size_t _next_clause_idx = 0;
 
 public:
     ClauseShuffler(int seed = 0) : _rng(std::mt19937(seed)), _dist(std::uniform_real_distribution<float>(0, 1)) {
         _rng_func = [this]() {return _dist(_rng);};
     }
 
-    std::pair<const int*, size_t> doShuffle(const int* input, size_t inputSize, bool permuteClauses = true, bool permuteLiterals = true) {
+    // Sets up the shuffling of the given formula, which must consist of complete clauses.
+    void reset(const int* input, size_t inputSize, bool permuteClauses = true, bool permuteLiterals = true) {
 
-        _input = std::vector<int>(input, input+inputSize);
+        _input = input;
+        _permute_clauses = permuteClauses;
+        _permute_literals = permuteLiterals;
+        _next_clause_idx = 0;
 
-        // Build vector of clauses (size + pointer to data)
-        _clauses.clear();
-        size_t clauseStart = 0; // 1st clause always begins at position 0
-        size_t sumOfSizes = 0;
+        _clause_starts.clear();
+        _clause_starts.push_back(0); // 1st clause always begins at position 0
         for (size_t i = 0; i < inputSize; i++) { // for each literal
-            if (_input[i] == 0) {
-                // clause ends
-                size_t thisClauseSize = i-clauseStart;
-                _clauses.emplace_back(thisClauseSize, _input.data()+clauseStart);
-                clauseStart = i+1; // next clause begins at subsequent position
-                sumOfSizes += thisClauseSize;
-            }
+            // clause ends: next clause begins at subsequent position
+            if (input[i] == 0) _clause_starts.push_back(i+1);
         }
-        assert(sumOfSizes + _clauses.size() == inputSize);
+        assert(_clause_starts.back() == inputSize);
 
-        if (permuteClauses) {
-            // Shuffle order of clauses
-            shuffle(_clauses.data(), _clauses.size(), _rng_func);
-        }
-        if (permuteLiterals) {
-            // Shuffle order of literals within each clause
-            for (auto& [size, data] : _clauses) shuffle(data, size, _rng_func);
-        }
+        size_t numClauses = getNumClauses();
+        // (the permutation is defined over int values)
+        if (numClauses == 0 || numClauses > INT_MAX) _permute_clauses = false;
+        if (_permute_clauses) _permutation = AdjustablePermutation(numClauses, _rng());
+    }
+
+    size_t getNumClauses() const {return _clause_starts.size()-1;}
+    bool hasNext() const {return _next_clause_idx < getNumClauses();}
 
-        return std::pair<const int*, size_t>(_input.data(), _input.size());
+    // Writes the next clauses in shuffled order to the output (replacing its contents)
+    // until the output holds at least the given number of literals or no clauses are left.
+    // Returns the size of the output, which equals the number of input literals consumed.
+    size_t nextBatch(std::vector<int>& out, size_t minNumLits) {
+        out.clear();
+        while (hasNext() && out.size() < minNumLits) {
+            size_t clauseIdx = _permute_clauses ? _permutation.get(_next_clause_idx) : _next_clause_idx;
+            _next_clause_idx++;
+            size_t begin = _clause_starts[clauseIdx];
+            size_t end = _clause_starts[clauseIdx+1]; // position after the terminating zero
+            size_t outBegin = out.size();
+            out.insert(out.end(), _input+begin, _input+end);
+            if (_permute_literals) {
+                // Shuffle order of literals within the clause (excluding the zero)
+                shuffle(out.data()+outBegin, end-begin-1, _rng_func);
+            }
+        }
+        return out.size();
     }
 };
@@ -0,0 +1,118 @@
+
+#pragma once
+
+#include <vector>
+#include <list>
+#include <cstdlib>
+#include <algorithm>
+
+#include "util/sys/threading.hpp"
+
+// Splits the search space of the current revision into cubes over a few splitting
+// variables and hands them out to the solver threads of a process, which solve them
+// under assumptions. A thread fetches the next open cube as soon as it is done with
+// its former one, so threads which finish early take over the remaining work.
+// The revision is unsatisfiable as soon as each of its cubes has been refuted.
+// This is a process-local mode: the cubes are split among the threads of a single
+// process only and are not handed out to the other processes of a job. Each process
+// of a multi-process job thus still covers the entire search space (which keeps a
+// local refutation valid globally). Distributing cubes among the job's processes
+// via job messages, including cube stealing across processes, is not implemented.
+class CubeQueue {
+
+public:
+    enum Status {
+        CUBE, // a cube was fetched
+        GENERATE, // the caller is to supply the splitting variables for this revision
+        EXHAUSTED // all cubes of this revision were handed out
+    };
+
+private:
+    Mutex _mtx;
+    ConditionVariable _generated_cond;
+    const int _max_depth;
+
+    int _revision = -1;
+    bool _generating = false;
+    bool _generated = false;
+    std::list<std::vector<int>> _open_cubes;
+    size_t _num_unrefuted_cubes = 0;
+
+public:
+    CubeQueue(int maxDepth) : _max_depth(maxDepth) {}
+
+    int getMaxDepth() const {return _max_depth;}
+
+    // If another thread supplies the splitting variables for this revision right now,
+    // blocks until it is done (or the revision became obsolete).
+    Status fetch(int revision, std::vector<int>& cubeOut) {
+        auto lock = _mtx.getLock();
+        while (true) {
+            if (!updateRevision(revision)) return EXHAUSTED; // obsolete revision
+            if (_generated) break;
+            if (!_generating) {
+                _generating = true;
+                return GENERATE;
+            }
+            _generated_cond.waitWithLockedMutex(lock, [&]() {
+                return _generated || !_generating || _revision != revision;
+            });
+        }
+        if (_open_cubes.empty()) return EXHAUSTED;
+        cubeOut = std::move(_open_cubes.front());
+        _open_cubes.pop_front();
+        return CUBE;
+    }
+
+    // Creates a cube for each assignment to the provided splitting variables
+    // (at most getMaxDepth() of them, no duplicates).
+    void generate(int revision, const std::vector<int>& splitVars) {
+        auto lock = _mtx.getLock();
+        if (!updateRevision(revision) || _generated) return;
+        int depth = std::min((int) splitVars.size(), _max_depth);
+        for (size_t assignment = 0; assignment < (1ul << depth); assignment++) {
+            std::vector<int> cube;
+            for (int i = 0; i < depth; i++) {
+                int var = std::abs(splitVars[i]);
+                cube.push_back(((assignment >> i) & 1) ? var : -var);
+            }
+            _open_cubes.push_back(std::move(cube));
+        }
+        _num_unrefuted_cubes = _open_cubes.size();
+        _generating = false;
+        _generated = true;
+        _generated_cond.notify();
+    }
+
+    // Puts back a fetched cube which could not be solved, e.g., due to an interruption
+    void giveBack(int revision, std::vector<int>&& cube) {
+        auto lock = _mtx.getLock();
+        if (revision != _revision) return;
+        _open_cubes.push_front(std::move(cube));
+    }
+
+    // Reports a fetched cube to be unsatisfiable. Returns true iff this was
+    // the last unrefuted cube, i.e., the revision is unsatisfiable.
+    bool refute(int revision) {
+        auto lock = _mtx.getLock();
+        if (revision != _revision || _num_unrefuted_cubes == 0) return false;
+        _num_unrefuted_cubes--;
+        return _num_unrefuted_cubes == 0;
+    }
+
+private:
+    // Returns false iff the given revision is outdated
+    bool updateRevision(int revision) {
+        if (revision < _revision) return false;
+        if (revision > _revision) {
+            // Cubes of former revisions are obsolete
+            _revision = revision;
+            _generating = false;
+            _generated = false;
+            _open_cubes.clear();
+            _num_unrefuted_cubes = 0;
+            _generated_cond.notify();
+        }
+        return true;
+    }
+};
@@ -3,10 +3,13 @@
 
 #include "../sharing/sharing_manager.hpp"
 #include "util/sys/timer.hpp"
+#include "util/sys/thread_pool.hpp"
+#include "util/sys/proc.hpp"
 #include "data/app_configuration.hpp"
 #include "../solvers/cadical.hpp"
 #include "../solvers/lingeling.hpp"
 #include "../solvers/kissat.hpp"
+#include "../solvers/yalsat.hpp"
 #if MALLOB_USE_MERGESAT
 #include "../solvers/mergesat.hpp"
 #endif
@@ -18,6 +21,8 @@
 #include <stdlib.h>
 #include <ctype.h>
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <csignal>
 #include <unistd.h>
 #include <sched.h>
@@ -35,6 +40,21 @@ SatEngine::SatEngine(const Parameters& params, const SatProcessConfig& config, L
 	_num_solvers = config.threads;
 	int numOrigSolvers = params.numThreadsPerProcess();
 	_job_id = config.jobid;
+
+	if (_params.numaMode() > 0) {
+		auto nodes = Proc::getNumaNodes();
+		if (_params.numaMode() == 1) {
+			_numa_nodes = nodes;
+		} else {
+			// All SAT processes spawned by the same MPI process share a node
+			int localRank = _params.processesPerHost() > 0 ? 
+				config.mpirank % _params.processesPerHost() : config.mpirank;
+			_numa_nodes.push_back(nodes[localRank % nodes.size()]);
+		}
+		std::string nodesStr;
+		for (int node : _numa_nodes) nodesStr += std::to_string(node) + " ";
+		LOGGER(_logger, V4_VVER, "NUMA nodes: %s(%lu on machine)\n", nodesStr.c_str(), nodes.size());
+	}
 	
 	// Retrieve the string defining the cycle of solver choices, one character per solver
 	// e.g. "llgc" => lingeling lingeling glucose cadical lingeling lingeling glucose ...
@@ -46,6 +66,7 @@ SatEngine::SatEngine(const Parameters& params, const SatProcessConfig& config, L
 	int numCdc = 0;
 	int numMrg = 0;
 	int numKis = 0;
+	int numYal = 0;
 
 	// Read options from app config
 	AppConfiguration appConfig; appConfig.deserialize(params.applicationConfiguration());
@@ -67,6 +88,7 @@ SatEngine::SatEngine(const Parameters& params, const SatProcessConfig& config, L
 		case 'c': case 'C': solverToAdd = &numCdc; break;
 		case 'm': case 'M': solverToAdd = &numMrg; break;
 		case 'k': case 'K': solverToAdd = &numKis; break;
+		case 'y': case 'Y': solverToAdd = &numYal; break;
 		}
 		*solverToAdd += numFullCycles + (i < begunCyclePos);
 	}
@@ -88,9 +110,11 @@ SatEngine::SatEngine(const Parameters& params, const SatProcessConfig& config, L
 	setup.numBufferedClsGenerations = params.bufferedImportedClsGenerations();
 	setup.skipClauseSharingDiagonally = true;
 
-	// Instantiate solvers according to the global solver IDs and diversification indices
+	// Set up solvers according to the global solver IDs and diversification indices,
+	// including the solvers which may be added to this engine later on
 	int cyclePos = begunCyclePos;
-	for (setup.localId = 0; setup.localId < _num_solvers; setup.localId++) {
+	int maxNumSolvers = std::max((int)_num_solvers, numOrigSolvers);
+	for (setup.localId = 0; setup.localId < maxNumSolvers; setup.localId++) {
 		setup.globalId = appRank * numOrigSolvers + setup.localId;
 		// Which solver?
 		setup.solverType = solverChoices[cyclePos];
@@ -101,18 +125,33 @@ SatEngine::SatEngine(const Parameters& params, const SatProcessConfig& config, L
 		case 'm': case 'M': setup.diversificationIndex = numMrg++; break;
 		case 'g': case 'G': setup.diversificationIndex = numGlu++; break;
 		case 'k': case 'K': setup.diversificationIndex = numKis++; break;
+		case 'y': case 'Y': setup.diversificationIndex = numYal++; break;
 		}
 		setup.diversificationIndex += diversificationOffset;
-		_solver_interfaces.emplace_back(createSolver(setup));
+		setup.numaNode = _numa_nodes.empty() ? -1 : _numa_nodes[setup.localId % _numa_nodes.size()];
+		_solver_setups.push_back(setup);
 		cyclePos = (cyclePos+1) % solverChoices.size();
 	}
+	// Reserve space for all solvers which may run at a time such that the vectors
+	// are not reallocated while the sharing manager accesses them
+	_solver_interfaces.reserve(maxNumSolvers);
+	_solver_threads.reserve(maxNumSolvers);
+	for (size_t i = 0; i < _num_solvers; i++) {
+		_solver_interfaces.emplace_back(createSolver(_solver_setups[i]));
+	}
 
 	_sharing_manager.reset(new SharingManager(_solver_interfaces, _params, _logger, 
 		/*max. deferred literals per solver=*/5*config.maxBroadcastedLitsPerCycle, config.apprank));
+	if (_params.cubeDepth() > 0) _cube_queue.reset(new CubeQueue(_params.cubeDepth()));
+	// Take over the clauses retained by the process this one replaces
+	if (config.incremental && config.recoveryIndex > 0) readRetainedClauses();
 	LOGGER(_logger, V5_DEBG, "initialized\n");
 }
 
 std::shared_ptr<PortfolioSolverInterface> SatEngine::createSolver(const SolverSetup& setup) {
+	// The solver (including its import buffer) allocates its initial memory right here:
+	// place it on the solver's node although the calling thread is not pinned
+	if (setup.numaNode >= 0) Proc::setPreferredNumaNodeOfThisThread(setup.numaNode);
 	std::shared_ptr<PortfolioSolverInterface> solver;
 	switch (setup.solverType) {
 	case 'l':
@@ -133,6 +172,16 @@ std::shared_ptr<PortfolioSolverInterface> SatEngine::createSolver(const SolverSe
 		LOGGER(_logger, V4_VVER, "S%i : Kissat-%i\n", setup.globalId, setup.diversificationIndex);
 		solver.reset(new Kissat(setup));
 		break;
+	case 'y':
+	//case 'Y': // no support for incremental mode
+		{
+			// YalSAT (local search)
+			LOGGER(_logger, V4_VVER, "S%i : YalSAT-%i\n", setup.globalId, setup.diversificationIndex);
+			auto yalsat = new YalSAT(setup);
+			yalsat->setPhaseHints(&_phase_hints);
+			solver.reset(yalsat);
+		}
+		break;
 #ifdef MALLOB_USE_MERGESAT
 	case 'm':
 	//case 'M': // no support for incremental mode as of now
@@ -156,6 +205,7 @@ std::shared_ptr<PortfolioSolverInterface> SatEngine::createSolver(const SolverSe
 		abort();
 		break;
 	}
+	if (setup.numaNode >= 0) Proc::setPreferredNumaNodeOfThisThread(-1);
 	return solver;
 }
 
@@ -169,9 +219,7 @@ void SatEngine::appendRevision(int revision, size_t fSize, const int* fLits, siz
 	for (size_t i = 0; i < _num_solvers; i++) {
 		if (revision == 0) {
 			// Initialize solver thread
-			_solver_threads.emplace_back(new SolverThread(
-				_params, _config, _solver_interfaces[i], fSize, fLits, aSize, aLits, i
-			));
+			createSolverThread(i, revision);
 		} else {
 			if (_solver_interfaces[i]->getSolverSetup().doIncrementalSolving) {
 				// True incremental SAT solving
@@ -187,38 +235,239 @@ void SatEngine::appendRevision(int revision, size_t fSize, const int* fLits, siz
 					// Abort (but do not create a thread trace) such that a new, fresh
 					// process will be initialized
 					LOGGER(_logger, V3_VERB, "Restarting this non-incremental subprocess\n");
+					writeRetainedClauses();
 					raise(SIGUSR2);
 				}
 				// Pseudo-incremental SAT solving: 
-				// Phase out old solver thread
-				_sharing_manager->stopClauseImport(i);
-				_solver_threads[i]->setTerminate();
-				_obsolete_solver_threads.push_back(std::move(_solver_threads[i]));
-				// Setup new solver and new solver thread
-				SolverSetup s = _solver_interfaces[i]->getSolverSetup();
-				s.solverRevision++;
-				_solver_interfaces[i] = createSolver(s);
-				_solver_threads[i] = std::shared_ptr<SolverThread>(new SolverThread(
-					_params, _config, _solver_interfaces[i], 
-					_revision_data[0].fSize, _revision_data[0].fLits, 
-					_revision_data[0].aSize, _revision_data[0].aLits, 
-					i
-				));
-				// Load entire formula 
-				for (int importedRevision = 1; importedRevision <= revision; importedRevision++) {
-					auto data = _revision_data[importedRevision];
-					_solver_threads[i]->appendRevision(importedRevision, 
-						data.fSize, data.fLits, data.aSize, data.aLits
-					);
-				}
-				_sharing_manager->continueClauseImport(i);
-				if (_solvers_started) _solver_threads[i]->start();
+				// Phase out old solver thread, set up new solver and new solver thread
+				replaceSolver(i, _solver_interfaces[i]->getSolverSetup(), revision);
 			}
 		}
 	}
 	_revision = revision;
 }
 
+int SatEngine::setNumThreads(int numThreads) {
+	if (isCleanedUp()) return _num_solvers;
+	numThreads = std::max(1, std::min(numThreads, (int)_solver_setups.size()));
+	if (numThreads == (int)_num_solvers) return _num_solvers;
+	LOGGER(_logger, V3_VERB, "Scale solver threads %lu => %i\n", _num_solvers, numThreads);
+	while ((int)_num_solvers < numThreads) addSolverThread();
+	while ((int)_num_solvers > numThreads) removeSolverThread();
+	return _num_solvers;
+}
+
+void SatEngine::addSolverThread() {
+
+	int i = _num_solvers;
+	_solver_interfaces.push_back(createSolver(_solver_setups[i]));
+	_num_solvers++;
+	_sharing_manager->addSolver(i);
+	// Without any revision, the thread is initialized along with the others
+	if (_revision < 0) return;
+
+	createSolverThread(i, _revision);
+	startSolverThread(i);
+}
+
+void SatEngine::removeSolverThread() {
+
+	int i = _num_solvers-1;
+	_sharing_manager->stopClauseImport(i);
+	// A solver re-added at this position later on is set up as a new revision
+	// such that clauses from the removed solver are told apart from its own
+	_solver_setups[i] = _solver_interfaces[i]->getSolverSetup();
+	_solver_setups[i].solverRevision++;
+	_num_solvers--;
+	_solver_interfaces.pop_back();
+	if (_revision < 0) return; // no thread yet
+
+	releaseSolverThread(std::move(_solver_threads[i]));
+	_solver_threads.pop_back();
+}
+
+// Terminates the given thread and joins it concurrently:
+// its solver is released as soon as it exits
+void SatEngine::releaseSolverThread(std::shared_ptr<SolverThread>&& thread) {
+	// forget about removals which completed earlier
+	for (auto it = _thread_removals.begin(); it != _thread_removals.end();) {
+		if (it->wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+			it->get();
+			it = _thread_removals.erase(it);
+		} else ++it;
+	}
+	thread->setSuspend(false);
+	thread->setTerminate();
+	_thread_removals.push_back(ProcessWideThreadPool::get().addTask([thread = std::move(thread)]() {
+		thread->tryJoin();
+	}));
+}
+
+// Creates the solver thread for the i-th solver, which receives all revisions
+// up to the given one
+void SatEngine::createSolverThread(size_t i, int revision) {
+
+	auto thread = std::shared_ptr<SolverThread>(new SolverThread(
+		_params, _config, _solver_interfaces[i], 
+		_revision_data[0].fSize, _revision_data[0].fLits, 
+		_revision_data[0].aSize, _revision_data[0].aLits, 
+		i
+	));
+	thread->setResultCallback(_result_callback);
+	thread->setCubeQueue(_cube_queue.get());
+	thread->setPhaseHints(&_phase_hints);
+	thread->setRetainedClauses(_sharing_manager->getRetainedClauses());
+	thread->setNumaNode(_solver_interfaces[i]->getSolverSetup().numaNode);
+	// Load entire formula 
+	for (int importedRevision = 1; importedRevision <= revision; importedRevision++) {
+		auto data = _revision_data[importedRevision];
+		thread->appendRevision(importedRevision, 
+			data.fSize, data.fLits, data.aSize, data.aLits
+		);
+	}
+	if (i < _solver_threads.size()) _solver_threads[i] = std::move(thread);
+	else _solver_threads.push_back(std::move(thread));
+}
+
+void SatEngine::startSolverThread(size_t i) {
+	if (!_solvers_started) return; // started along with all others
+	if (_state == SUSPENDED) _solver_threads[i]->setSuspend(true);
+	_solver_threads[i]->start();
+}
+
+// Phases out the i-th solver and its thread and replaces them with a new solver
+// of the given setup, which is assigned a new solver revision
+void SatEngine::replaceSolver(size_t i, SolverSetup setup, int revision) {
+
+	_sharing_manager->stopClauseImport(i);
+	releaseSolverThread(std::move(_solver_threads[i]));
+
+	setup.solverRevision++;
+	_solver_interfaces[i] = createSolver(setup);
+	createSolverThread(i, revision);
+	_sharing_manager->continueClauseImport(i);
+	startSolverThread(i);
+}
+
+const int* SatEngine::placeFormulaMemory(const int* data, size_t size) {
+	if (_numa_nodes.empty() || size == 0) return data;
+	if (Proc::placeMemoryOnNumaNodes(data, size*sizeof(int), _numa_nodes)) return data;
+	// The shared pages could not be migrated: use a private copy on the node(s) instead
+	int* copy = (int*) Proc::allocateOnNumaNodes(size*sizeof(int), _numa_nodes);
+	if (copy == nullptr) {
+		LOGGER(_logger, V3_VERB, "Could not place %lu formula literals on NUMA node(s)\n", size);
+		return data;
+	}
+	memcpy(copy, data, size*sizeof(int));
+	_numa_formula_copies.emplace_back(copy, size*sizeof(int));
+	LOGGER(_logger, V4_VVER, "Copied %lu formula literals to NUMA node(s)\n", size);
+	return copy;
+}
+
+// Writes the retained clauses to a file for the subprocess started in place of this one
+void SatEngine::writeRetainedClauses() {
+	_sharing_manager->writeRetainedClauses(_config.getRetainedClausesFile(Proc::getParentPid()));
+}
+
+void SatEngine::readRetainedClauses() {
+	_sharing_manager->readRetainedClauses(_config.getRetainedClausesFile(Proc::getParentPid()));
+}
+
+void SatEngine::initPortfolioTuner() {
+
+	// Arms: each (original) diversification of each CDCL solver in the portfolio
+	std::vector<PortfolioTuner::Arm> arms;
+	std::string solverTypes;
+	for (size_t i = 0; i < _num_solvers; i++) {
+		char type = _solver_interfaces[i]->getSolverSetup().solverType;
+		if (type == 'y' || type == 'Y') continue; // no conflicts to measure
+		if (solverTypes.find(type) != std::string::npos) continue;
+		solverTypes += type;
+		int numDiversifications = _solver_interfaces[i]->getNumOriginalDiversifications();
+		for (int div = 0; div < numDiversifications; div++) arms.push_back({type, div});
+	}
+
+	// Formula family: supplied by the application configuration or, as a fallback,
+	// the order of magnitude of the formula's size
+	AppConfiguration appConfig; appConfig.deserialize(_params.applicationConfiguration());
+	std::string family = appConfig.map.count("family") ? appConfig.map["family"] : 
+		"lits2^" + std::to_string((int) std::log2(1 + _revision_data[0].fSize));
+	for (char& c : family) if (isspace(c)) c = '_';
+
+	_tuner.reset(new PortfolioTuner(_params.portfolioTunerFile(), family, arms));
+	LOGGER(_logger, V4_VVER, "portfolio tuner: family %s, %lu arms\n", family.c_str(), arms.size());
+}
+
+// Rewards the configurations of all solvers according to their progress since
+// the last tuning and restarts the worst performing solver with the configuration
+// suggested by the tuner
+void SatEngine::tunePortfolio() {
+
+	float time = Timer::elapsedSeconds();
+	_time_of_last_tuning = time;
+	if (!_tuner) initPortfolioTuner();
+
+	// Progress of each solver since the last tuning: conflicts and admitted clauses
+	std::vector<int> solverArms(_num_solvers, -1);
+	std::vector<double> conflictRates(_num_solvers, 0), admissionRates(_num_solvers, 0);
+	double maxConflictRate = 0, maxAdmissionRate = 0;
+	_tuning_records.resize(_num_solvers);
+	for (size_t i = 0; i < _num_solvers; i++) {
+		const auto& setup = _solver_interfaces[i]->getSolverSetup();
+		const auto& stats = _solver_interfaces[i]->getSolverStats();
+		auto& record = _tuning_records[i];
+		// Only rate solvers which had read their formula already at the last tuning:
+		// loading may take longer than a tuning period and says nothing about the
+		// configuration. The time spent loading further revisions is not counted either.
+		bool readFormula = _solver_threads[i]->hasReadFormula();
+		bool eligible = record.solverRevision == setup.solverRevision && record.readFormula && readFormula;
+		float elapsed = time - record.time - (stats.loadTime - record.loadTime);
+		if (eligible && elapsed > 0) {
+			int numDiversifications = _solver_interfaces[i]->getNumOriginalDiversifications();
+			solverArms[i] = _tuner->getArmIndex(setup.solverType, setup.diversificationIndex % numDiversifications);
+			conflictRates[i] = (stats.conflicts - record.conflicts) / elapsed;
+			admissionRates[i] = (stats.producedClausesAdmitted - record.admittedClauses) / elapsed;
+			if (solverArms[i] >= 0) {
+				maxConflictRate = std::max(maxConflictRate, conflictRates[i]);
+				maxAdmissionRate = std::max(maxAdmissionRate, admissionRates[i]);
+			}
+		}
+		record = TuningRecord{setup.solverRevision, time, stats.conflicts, stats.producedClausesAdmitted,
+			stats.loadTime, readFormula};
+	}
+
+	// Reward: search speed and quality of the exported clauses, relative to the best solver
+	std::vector<double> rewards(_num_solvers, 0);
+	double rewardSum = 0;
+	int numRewarded = 0;
+	int worstSolver = -1;
+	std::vector<int> armsInUse;
+	for (size_t i = 0; i < _num_solvers; i++) {
+		if (solverArms[i] < 0) continue;
+		rewards[i] = 0.5 * (maxConflictRate > 0 ? conflictRates[i] / maxConflictRate : 0)
+			+ 0.5 * (maxAdmissionRate > 0 ? admissionRates[i] / maxAdmissionRate : 0);
+		_tuner->reward(solverArms[i], rewards[i]);
+		rewardSum += rewards[i];
+		numRewarded++;
+		armsInUse.push_back(solverArms[i]);
+		if (worstSolver == -1 || rewards[i] < rewards[worstSolver]) worstSolver = i;
+	}
+	if (numRewarded < 2 || rewards[worstSolver] >= 0.5 * rewardSum / numRewarded) return;
+
+	// Restart the worst solver with another configuration
+	int arm = _tuner->select(armsInUse);
+	if (arm < 0) return;
+	auto newArm = _tuner->getArms()[arm];
+	SolverSetup setup = _solver_interfaces[worstSolver]->getSolverSetup();
+	LOGGER(_logger, V3_VERB, "portfolio tuner: restart S%i (%c%i, reward %.3f) as %s (mean reward %.3f over %lu runs)\n",
+		setup.globalId, setup.solverType, setup.diversificationIndex, rewards[worstSolver],
+		newArm.toStr().c_str(), _tuner->getMeanReward(arm), _tuner->getNumPulls(arm));
+	setup.solverType = newArm.solverType;
+	setup.diversificationIndex = newArm.diversificationIndex;
+	setup.doIncrementalSolving = setup.isJobIncremental && !islower(setup.solverType);
+	replaceSolver(worstSolver, setup, _revision);
+}
+
 void SatEngine::solve() {
 	assert(_revision >= 0);
 	_result.result = UNKNOWN;
@@ -259,6 +508,18 @@ int SatEngine::solveLoop() {
 		LOGGER(_logger, V5_DEBG, "Returning result\n");
 		return _result.result;
 	}
+
+	if (!_params.portfolioTunerFile().empty() && _solvers_started && _state == ACTIVE
+			&& Timer::elapsedSeconds() - _time_of_last_tuning >= _params.portfolioTunerPeriod()) {
+		tunePortfolio();
+	}
+
+	// Let the CDCL solvers pick up improved phases from local search
+	if (_params.phaseHintsPeriod() > 0 && _solvers_started && _state == ACTIVE
+			&& Timer::elapsedSeconds() - _time_of_last_phase_hints >= _params.phaseHintsPeriod()) {
+		_time_of_last_phase_hints = Timer::elapsedSeconds();
+		for (auto& thread : _solver_threads) thread->interruptForPhaseHints();
+	}
     return -1; // no result yet
 }
 
@@ -269,6 +530,12 @@ int SatEngine::prepareSharing(int* begin, int maxSize) {
 	return size;
 }
 
+std::vector<int> SatEngine::prepareSharing(int maxSize) {
+	if (isCleanedUp()) return std::vector<int>(sizeof(size_t) / sizeof(int), 0); // checksum, nothing else
+	LOGGER(_logger, V5_DEBG, "collecting clauses on this node\n");
+	return _sharing_manager->prepareSharing(maxSize);
+}
+
 int SatEngine::filterSharing(int* begin, int size, int* filterOut) {
 	if (isCleanedUp()) return 0;
 	return _sharing_manager->filterSharing(begin, size, filterOut);
@@ -356,19 +623,28 @@ std::pair<int, int> SatEngine::getLastAdmittedClauseShare() {
 	);
 }
 
+ImportAcceptance SatEngine::getImportAcceptance() {
+	return _sharing_manager->getImportAcceptance();
+}
+
 void SatEngine::cleanUp() {
 	double time = Timer::elapsedSeconds();
 
 	LOGGER(_logger, V5_DEBG, "[engine-cleanup] enter\n");
 
+	// Remember what the portfolio tuner learned
+	if (_tuner && !_tuner->save()) {
+		LOGGER(_logger, V1_WARN, "[WARN] Could not write portfolio tuner file %s\n", _params.portfolioTunerFile().c_str());
+	}
+
 	// Terminate any remaining running threads
 	terminateSolvers();
 	
 	// join and delete threads
+	for (auto& future : _thread_removals) future.get();
+	_thread_removals.clear();
 	for (auto& thread : _solver_threads) thread->tryJoin();
-	for (auto& thread : _obsolete_solver_threads) thread->tryJoin();
 	_solver_threads.clear();
-	_obsolete_solver_threads.clear();
 
 	LOGGER(_logger, V5_DEBG, "[engine-cleanup] joined threads\n");
 
@@ -376,6 +652,9 @@ void SatEngine::cleanUp() {
 	_solver_interfaces.clear();
 	LOGGER(_logger, V5_DEBG, "[engine-cleanup] cleared solvers\n");
 
+	for (auto& [addr, size] : _numa_formula_copies) Proc::freeOnNumaNodes(addr, size);
+	_numa_formula_copies.clear();
+
 	time = Timer::elapsedSeconds() - time;
 	LOGGER(_logger, V4_VVER, "[engine-cleanup] done, took %.3f s\n", time);
 	_logger.flush();
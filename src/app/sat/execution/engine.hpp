@@ -4,11 +4,14 @@
 #include <atomic>
 #include <vector>
 #include <memory>
+#include <list>
+#include <future>
 
 #include "util/sys/threading.hpp"
 #include "util/logger.hpp"
 #include "../sharing/sharing_manager.hpp"
 #include "solver_thread.hpp"
+#include "portfolio_tuner.hpp"
 #include "solving_state.hpp"
 #include "util/params.hpp"
 #include "data/checksum.hpp"
@@ -25,11 +28,19 @@ private:
 	int _job_id;
 	
 	size_t _num_solvers;
+	// Setup of each solver this engine may run, by local ID
+	std::vector<SolverSetup> _solver_setups;
 	
 	std::unique_ptr<SharingManager> _sharing_manager;
+	// Cubes of the current revision if the search space is split among the threads
+	std::unique_ptr<CubeQueue> _cube_queue;
+	// Best assignment of the local search solvers, offered to the others as phases
+	PhaseHints _phase_hints;
+	// NUMA nodes to place the solver threads on, cyclically (empty: no placement)
+	std::vector<int> _numa_nodes;
 	std::vector<std::shared_ptr<PortfolioSolverInterface>> _solver_interfaces;
 	std::vector<std::shared_ptr<SolverThread>> _solver_threads;
-	std::vector<std::shared_ptr<SolverThread>> _obsolete_solver_threads;
+	std::list<std::future<void>> _thread_removals;
 
 	struct RevisionData {
 		size_t fSize;
@@ -38,13 +49,30 @@ private:
 		const int* aLits;
 	};
 	std::vector<RevisionData> _revision_data;
+	// Private copies of formula revisions on the NUMA node(s) (address, bytes)
+	std::vector<std::pair<void*, size_t>> _numa_formula_copies;
 	
 	bool _solvers_started = false;
 	volatile SolvingStates::SolvingState _state;
 	int _revision = -1;
 	JobResult _result;
+	std::function<void()> _result_callback;
 	std::atomic_bool _cleaned_up = false;
 
+	// Online selection of solver configurations (if a tuner file is given)
+	std::unique_ptr<PortfolioTuner> _tuner;
+	float _time_of_last_tuning = 0;
+	float _time_of_last_phase_hints = 0;
+	struct TuningRecord {
+		int solverRevision = -1;
+		float time = 0;
+		unsigned long conflicts = 0;
+		unsigned long admittedClauses = 0;
+		double loadTime = 0;
+		bool readFormula = false;
+	};
+	std::vector<TuningRecord> _tuning_records;
+
 public:
 
     SatEngine(const Parameters& params, const SatProcessConfig& config, Logger& loggingInterface);
@@ -56,14 +84,31 @@ public:
 
 	bool isFullyInitialized();
     int solveLoop();
+	// Set a function which a solver thread calls as soon as it found a result,
+	// e.g., to wake up a thread which would otherwise only check solveLoop() periodically.
+	// Must be called before the first revision is appended.
+	void setResultCallback(std::function<void()> callback) {_result_callback = callback;}
 	JobResult& getResult() {return _result;}
 
     int prepareSharing(int* begin, int maxSize);
+	std::vector<int> prepareSharing(int maxSize);
 	int filterSharing(int* begin, int size, int* filterOut);
 	void digestSharingWithFilter(int* begin, int size, const int* filter);
 	void digestSharingWithoutFilter(int* begin, int size);
 	void returnClauses(int* begin, int size);
 	std::pair<int, int> getLastAdmittedClauseShare();
+	ImportAcceptance getImportAcceptance();
+
+	// Adds or removes solver threads (at least one, at most as many as the original
+	// number of threads per process) while solving. Returns the new number of threads.
+	int setNumThreads(int numThreads);
+	int getNumThreads() const {return _num_solvers;}
+
+	// Places the given formula memory according to the NUMA mode (if any).
+	// Returns the formula to use, which is a node-local copy if the given
+	// (shared) memory could not be migrated.
+	const int* placeFormulaMemory(const int* data, size_t size);
+	const std::vector<int>& getNumaNodes() const {return _numa_nodes;}
 
     void setPaused();
     void unsetPaused();
@@ -86,5 +131,17 @@ public:
 private:
 
 	std::shared_ptr<PortfolioSolverInterface> createSolver(const SolverSetup& setup);
+	void addSolverThread();
+	void removeSolverThread();
+	void releaseSolverThread(std::shared_ptr<SolverThread>&& thread);
+	void createSolverThread(size_t i, int revision);
+	void startSolverThread(size_t i);
+	void replaceSolver(size_t i, SolverSetup setup, int revision);
+
+	void writeRetainedClauses();
+	void readRetainedClauses();
+
+	void initPortfolioTuner();
+	void tunePortfolio();
 
 };
@@ -0,0 +1,161 @@
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <map>
+#include <fstream>
+#include <sstream>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/file.h>
+
+// Multi-armed bandit over solver configurations, each given as a solver letter
+// (as in -satsolver) and a diversification index. Configurations are selected by UCB1
+// based on the rewards they earned so far. The statistics are kept per formula family
+// in a small text file (one line "<family> <arm> <pulls> <reward sum>" per configuration)
+// so that they carry over to later jobs of the same family.
+class PortfolioTuner {
+
+public:
+    struct Arm {
+        char solverType;
+        int diversificationIndex;
+        std::string toStr() const {return std::string(1, solverType) + std::to_string(diversificationIndex);}
+    };
+
+private:
+    struct ArmStats {
+        // statistics loaded from the file, and the ones collected by this tuner
+        unsigned long loadedPulls = 0;
+        double loadedRewardSum = 0;
+        unsigned long pulls = 0;
+        double rewardSum = 0;
+        unsigned long getPulls() const {return loadedPulls + pulls;}
+        double getRewardSum() const {return loadedRewardSum + rewardSum;}
+    };
+
+    std::string _file;
+    std::string _family;
+    std::vector<Arm> _arms;
+    std::vector<ArmStats> _stats;
+    float _exploration;
+
+public:
+    PortfolioTuner(const std::string& file, const std::string& family,
+            const std::vector<Arm>& arms, float exploration = std::sqrt(2.0f)) :
+        _file(file), _family(family), _arms(arms), _stats(arms.size()), _exploration(exploration) {
+
+        auto loaded = readFile();
+        for (size_t i = 0; i < _arms.size(); i++) {
+            auto it = loaded.find(_family + " " + _arms[i].toStr());
+            if (it == loaded.end()) continue;
+            _stats[i].loadedPulls = it->second.first;
+            _stats[i].loadedRewardSum = it->second.second;
+        }
+    }
+
+    const std::vector<Arm>& getArms() const {return _arms;}
+
+    int getArmIndex(char solverType, int diversificationIndex) const {
+        for (size_t i = 0; i < _arms.size(); i++) {
+            if (_arms[i].solverType == solverType && _arms[i].diversificationIndex == diversificationIndex)
+                return i;
+        }
+        return -1;
+    }
+
+    // Credits the given arm with a reward from [0, 1]
+    void reward(int arm, double reward) {
+        _stats[arm].pulls++;
+        _stats[arm].rewardSum += std::max(0.0, std::min(1.0, reward));
+    }
+
+    // Returns the arm with the highest upper confidence bound. Arms which have
+    // never been pulled are preferred; arms in the exclusion list are skipped.
+    int select(const std::vector<int>& excludedArms = std::vector<int>()) const {
+        unsigned long totalPulls = 0;
+        for (auto& s : _stats) totalPulls += s.getPulls();
+        int bestArm = -1;
+        double bestScore = 0;
+        for (size_t i = 0; i < _arms.size(); i++) {
+            if (std::find(excludedArms.begin(), excludedArms.end(), (int)i) != excludedArms.end()) continue;
+            auto& s = _stats[i];
+            if (s.getPulls() == 0) return i;
+            double score = s.getRewardSum() / s.getPulls()
+                + _exploration * std::sqrt(std::log((double)totalPulls) / s.getPulls());
+            if (bestArm == -1 || score > bestScore) {
+                bestArm = i;
+                bestScore = score;
+            }
+        }
+        return bestArm;
+    }
+
+    double getMeanReward(int arm) const {
+        auto& s = _stats[arm];
+        return s.getPulls() == 0 ? 0 : s.getRewardSum() / s.getPulls();
+    }
+    unsigned long getNumPulls(int arm) const {return _stats[arm].getPulls();}
+
+    // Adds the statistics collected by this tuner to the file, leaving all other
+    // entries (possibly written by other processes in the meantime) intact.
+    // Concurrent saves are serialized via an exclusive lock on an accompanying lock file.
+    bool save() {
+        int lockFd = open((_file + ".lock").c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (lockFd == -1) return false;
+        if (flock(lockFd, LOCK_EX) != 0) {
+            close(lockFd);
+            return false;
+        }
+        bool success = saveWhileLocked();
+        flock(lockFd, LOCK_UN);
+        close(lockFd);
+        return success;
+    }
+
+private:
+    bool saveWhileLocked() {
+        auto entries = readFile();
+        for (size_t i = 0; i < _arms.size(); i++) {
+            if (_stats[i].pulls == 0) continue;
+            auto& entry = entries[_family + " " + _arms[i].toStr()];
+            entry.first += _stats[i].pulls;
+            entry.second += _stats[i].rewardSum;
+        }
+        // Write to a temporary file and move it in place
+        std::string tmpFile = _file + "." + std::to_string(getpid()) + ".tmp";
+        {
+            std::ofstream ofs(tmpFile);
+            if (!ofs.is_open()) return false;
+            for (auto& [key, entry] : entries) ofs << key << " " << entry.first << " " << entry.second << "\n";
+        }
+        if (std::rename(tmpFile.c_str(), _file.c_str()) != 0) return false;
+        for (auto& s : _stats) {
+            s.loadedPulls += s.pulls;
+            s.loadedRewardSum += s.rewardSum;
+            s.pulls = 0;
+            s.rewardSum = 0;
+        }
+        return true;
+    }
+
+    // Maps "<family> <arm>" to pulls and reward sum
+    std::map<std::string, std::pair<unsigned long, double>> readFile() const {
+        std::map<std::string, std::pair<unsigned long, double>> entries;
+        std::ifstream ifs(_file);
+        std::string line;
+        while (std::getline(ifs, line)) {
+            std::istringstream iss(line);
+            std::string family, arm;
+            unsigned long pulls;
+            double rewardSum;
+            if (!(iss >> family >> arm >> pulls >> rewardSum)) continue;
+            entries[family + " " + arm] = {pulls, rewardSum};
+        }
+        return entries;
+    }
+};
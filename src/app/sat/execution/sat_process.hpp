@@ -7,6 +7,8 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <list>
+#include <algorithm>
 #include "util/assert.hpp"
 
 #include "util/sys/timer.hpp"
@@ -32,14 +34,17 @@ private:
     std::string _shmem_id;
     SatSharedMemory* _hsm;
     int* _export_buffer;
-    int* _import_buffer;
-    int* _filter_buffer;
-    int* _returned_buffer;
+    int* _task_ring;
 
     int _last_imported_revision;
     int _desired_revision;
     Checksum* _checksum;
 
+    // Tasks received from the parent which are not processed yet
+    std::list<SatSharedMemory::Message> _tasks;
+    // Doorbell ring count at the time the child last looked for something to do
+    int _last_seen_num_rings = 0;
+
 public:
     SatProcess(const Parameters& params, const SatProcessConfig& config, Logger& log) 
         : _params(params), _config(config), _log(log), _engine(_params, _config, _log) {
@@ -48,6 +53,9 @@ public:
         _shmem_id = _config.getSharedMemId(Proc::getParentPid());
         LOGGER(log, V4_VVER, "Access base shmem: %s\n", _shmem_id.c_str());
         _hsm = (SatSharedMemory*) accessMemory(_shmem_id, sizeof(SatSharedMemory));
+
+        // Solver threads which found a result wake up the main thread
+        _engine.setResultCallback([hsm = _hsm]() {hsm->childDoorbell.ring();});
         
         _checksum = params.useChecksums() ? new Checksum() : nullptr;
     }
@@ -64,11 +72,7 @@ public:
         {
             int maxExportBufferSize = _hsm->exportBufferAllocatedSize * sizeof(int);
             _export_buffer = (int*) accessMemory(_shmem_id + ".clauseexport", maxExportBufferSize);
-            int maxImportBufferSize = _hsm->importBufferMaxSize * sizeof(int);
-            _import_buffer = (int*) accessMemory(_shmem_id + ".clauseimport", maxImportBufferSize);
-            int maxFilterSize = _hsm->importBufferMaxSize/8 + 1;
-            _filter_buffer = (int*) accessMemory(_shmem_id + ".clausefilter", maxFilterSize);
-            _returned_buffer = (int*) accessMemory(_shmem_id + ".returnedclauses", maxImportBufferSize);
+            _task_ring = (int*) accessMemory(_shmem_id + ".taskring", _hsm->taskRingSize * sizeof(int));
         }
 
         // Import first revision
@@ -76,7 +80,8 @@ public:
         {
             int* fPtr = (int*) accessMemory(_shmem_id + ".formulae.0", sizeof(int) * _hsm->fSize);
             int* aPtr = (int*) accessMemory(_shmem_id + ".assumptions.0", sizeof(int) * _hsm->aSize);
-            _engine.appendRevision(0, _hsm->fSize, fPtr, _hsm->aSize, aPtr, 
+            const int* fLits = _engine.placeFormulaMemory(fPtr, _hsm->fSize);
+            _engine.appendRevision(0, _hsm->fSize, fLits, _hsm->aSize, aPtr, 
                 /*finalRevisionForNow=*/_desired_revision == 0);
             updateChecksum(fPtr, _hsm->fSize);
         }
@@ -86,8 +91,9 @@ public:
         
         // Start solver threads
         _engine.solve();
+        LOGGER(_log, V3_VERB, "Solvers started %.4fs after launch\n", Timer::elapsedSeconds() - _hsm->launchTime);
         
-        std::vector<int> solutionVec;
+        std::vector<uint8_t> solution;
         std::string solutionShmemId = "";
         char* solutionShmem;
         int solutionShmemSize = 0;
@@ -96,6 +102,7 @@ public:
         // Main loop
         while (true) {
 
+            // Wait until there is something to do
             doSleep();
 
             // Terminate
@@ -108,82 +115,12 @@ public:
             // Read new revisions as necessary
             importRevisions();
 
-            // Dump stats
-            if (_hsm->doDumpStats && !_hsm->didDumpStats) {
-                LOGGER(_log, V5_DEBG, "DO dump stats\n");
-                
-                _engine.dumpStats(/*final=*/false);
-
-                // For this management thread
-                double cpuShare; float sysShare;
-                bool success = Proc::getThreadCpuRatio(Proc::getTid(), cpuShare, sysShare);
-                if (success) {
-                    LOGGER(_log, V3_VERB, "child_main cpuratio=%.3f sys=%.3f\n", cpuShare, sysShare);
-                }
-
-                // For each solver thread
-                std::vector<long> threadTids = _engine.getSolverTids();
-                for (size_t i = 0; i < threadTids.size(); i++) {
-                    if (threadTids[i] < 0) continue;
-                    
-                    success = Proc::getThreadCpuRatio(threadTids[i], cpuShare, sysShare);
-                    if (success) {
-                        LOGGER(_log, V3_VERB, "td.%ld cpuratio=%.3f sys=%.3f\n", threadTids[i], cpuShare, sysShare);
-                    }
-                }
-
-                auto rtInfo = Proc::getRuntimeInfo(Proc::getPid(), Proc::SubprocessMode::FLAT);
-                LOGGER(_log, V3_VERB, "child_mem=%.3fGB\n", 0.001*0.001*rtInfo.residentSetSize);
-
-                _hsm->didDumpStats = true;
-            }
-            if (!_hsm->doDumpStats) _hsm->didDumpStats = false;
-
-            // Check if clauses should be exported
-            if (_hsm->doExport && !_hsm->didExport) {
-                LOGGER(_log, V5_DEBG, "DO export clauses\n");
-                // Collect local clauses, put into shared memory
-                _hsm->exportChecksum = Checksum();
-                _hsm->exportBufferTrueSize = _engine.prepareSharing(_export_buffer, _hsm->exportBufferMaxSize);
-                auto [admitted, total] = _engine.getLastAdmittedClauseShare();
-                _hsm->lastNumAdmittedClausesToImport = admitted;
-                _hsm->lastNumClausesToImport = total;
-                assert(_hsm->exportBufferTrueSize <= _hsm->exportBufferAllocatedSize);
-                _hsm->didExport = true;
-            }
-            if (!_hsm->doExport) _hsm->didExport = false;
-
-            // Check if clauses should be filtered
-            if (_hsm->doFilterImport && !_hsm->didFilterImport) {
-                LOGGER(_log, V5_DEBG, "DO filter clauses\n");
-                _hsm->filterSize = _engine.filterSharing(_import_buffer, _hsm->importBufferSize, _filter_buffer);
-                _hsm->didFilterImport = true;
-            }
-            if (!_hsm->doFilterImport) _hsm->didFilterImport = false;
-
-            // Check if clauses should be digested (must not be "from the future")
-            if ((_hsm->doDigestImportWithFilter || _hsm->doDigestImportWithoutFilter) 
-                    && !_hsm->didDigestImport && _hsm->importBufferRevision <= _last_imported_revision) {
-                LOGGER(_log, V5_DEBG, "DO import clauses\n");
-                // Write imported clauses from shared memory into vector
-                assert(_hsm->importBufferSize <= _hsm->importBufferMaxSize);
-                if (_hsm->doDigestImportWithFilter) {
-                    _engine.digestSharingWithFilter(_import_buffer, _hsm->importBufferSize, _filter_buffer);
-                } else {
-                    _engine.digestSharingWithoutFilter(_import_buffer, _hsm->importBufferSize);
-                }
-                _hsm->didDigestImport = true;
+            // Process the parent's tasks in order of their arrival
+            readTasks();
+            for (auto it = _tasks.begin(); it != _tasks.end();) {
+                if (processTask(*it)) it = _tasks.erase(it);
+                else ++it;
             }
-            if (!_hsm->doDigestImportWithFilter && !_hsm->doDigestImportWithoutFilter) 
-                _hsm->didDigestImport = false;
-
-            // Re-insert returned clauses into the local clause database to be exported later
-            if (_hsm->doReturnClauses && !_hsm->didReturnClauses) {
-                LOGGER(_log, V5_DEBG, "DO return clauses\n");
-                _engine.returnClauses(_returned_buffer, _hsm->returnedBufferSize);
-                _hsm->didReturnClauses = true;
-            }
-            if (!_hsm->doReturnClauses) _hsm->didReturnClauses = false;
 
             // Check initialization state
             if (!_hsm->isInitialized && _engine.isFullyInitialized()) {
@@ -213,18 +150,20 @@ public:
                 }
                 assert(result.revision == _last_imported_revision);
 
-                solutionVec = result.extractSolution();
+                // Pass on the serialized result, with the model in its compact form
+                result.updateSerialization();
+                solution = result.moveSerialization();
                 _hsm->solutionRevision = result.revision;
                 LOGGER(_log, V5_DEBG, "DO write solution\n");
                 _hsm->result = SatResult(result.result);
                 size_t* solutionSize = (size_t*) SharedMemory::create(_shmem_id + ".solutionsize." + std::to_string(_hsm->solutionRevision), sizeof(size_t));
-                *solutionSize = solutionVec.size();
+                *solutionSize = solution.size();
                 // Write solution
                 if (*solutionSize > 0) {
                     solutionShmemId = _shmem_id + ".solution." + std::to_string(_hsm->solutionRevision);
-                    solutionShmemSize =  *solutionSize*sizeof(int);
+                    solutionShmemSize = *solutionSize;
                     solutionShmem = (char*) SharedMemory::create(solutionShmemId, solutionShmemSize);
-                    memcpy(solutionShmem, solutionVec.data(), solutionShmemSize);
+                    memcpy(solutionShmem, solution.data(), solutionShmemSize);
                 }
                 lastSolvedRevision = result.revision;
                 LOGGER(_log, V5_DEBG, "DONE write solution\n");
@@ -252,20 +191,149 @@ private:
         for (size_t i = 0; i < size; i++) _checksum->combine(ptr[i]);
     }
 
+    void readTasks() {
+        SatSharedMemory::Message task;
+        while (_hsm->tasks.pop(task)) _tasks.push_back(task);
+    }
+
+    void respond(const SatSharedMemory::Message& task, int offset = 0, int length = 0) {
+        SatSharedMemory::Message response {task.type};
+        response.id = task.id;
+        response.offset = offset;
+        response.length = length;
+        bool success = _hsm->responses.push(response);
+        assert(success);
+    }
+
+    // Returns false iff the task cannot be processed yet.
+    bool processTask(const SatSharedMemory::Message& task) {
+
+        switch (task.type) {
+        case SatSharedMemory::Message::EXPORT: {
+            LOGGER(_log, V5_DEBG, "DO export clauses\n");
+            // Collect local clauses, put into shared memory
+            SatSharedMemory::Message response {task.type};
+            response.id = task.id;
+            response.size = _engine.prepareSharing(_export_buffer, task.size);
+            auto [admitted, total] = _engine.getLastAdmittedClauseShare();
+            _hsm->lastNumAdmittedClausesToImport = admitted;
+            _hsm->lastNumClausesToImport = total;
+            _hsm->lastImportAcceptance = _engine.getImportAcceptance();
+            assert(response.size <= _hsm->exportBufferAllocatedSize);
+            bool success = _hsm->responses.push(response);
+            assert(success);
+            break;
+        }
+        case SatSharedMemory::Message::FILTER_IMPORT: {
+            LOGGER(_log, V5_DEBG, "DO filter clauses\n");
+            // The filter is written right behind the clauses
+            int filterOffset = task.offset + task.length;
+            int filterSize = _engine.filterSharing(_task_ring + task.offset, task.length, _task_ring + filterOffset);
+            respond(task, filterOffset, filterSize);
+            break;
+        }
+        case SatSharedMemory::Message::DIGEST_IMPORT_WITH_FILTER:
+        case SatSharedMemory::Message::DIGEST_IMPORT_WITHOUT_FILTER:
+            // Clauses must not be digested if they are "from the future"
+            if (task.revision > _last_imported_revision) return false;
+            LOGGER(_log, V5_DEBG, "DO import clauses\n");
+            if (task.type == SatSharedMemory::Message::DIGEST_IMPORT_WITH_FILTER) {
+                _engine.digestSharingWithFilter(_task_ring + task.clausesOffset, task.clausesLength,
+                    _task_ring + task.offset);
+            } else {
+                _engine.digestSharingWithoutFilter(_task_ring + task.offset, task.length);
+            }
+            respond(task);
+            break;
+        case SatSharedMemory::Message::RETURN_CLAUSES:
+            // Re-insert returned clauses into the local clause database to be exported later
+            LOGGER(_log, V5_DEBG, "DO return clauses\n");
+            _engine.returnClauses(_task_ring + task.offset, task.length);
+            respond(task);
+            break;
+        case SatSharedMemory::Message::DUMP_STATS:
+            dumpStats();
+            respond(task);
+            break;
+        case SatSharedMemory::Message::SET_NUM_THREADS: {
+            // Add or remove solver threads, report the resulting number of threads
+            SatSharedMemory::Message response {task.type};
+            response.id = task.id;
+            response.size = _engine.setNumThreads(task.size);
+            bool success = _hsm->responses.push(response);
+            assert(success);
+            break;
+        }
+        default:
+            // START_NEXT_REVISION is handled in importRevisions()
+            return false;
+        }
+        return true;
+    }
+
+    void dumpStats() {
+        LOGGER(_log, V5_DEBG, "DO dump stats\n");
+        
+        _engine.dumpStats(/*final=*/false);
+
+        // For this management thread
+        double cpuShare; float sysShare;
+        bool success = Proc::getThreadCpuRatio(Proc::getTid(), cpuShare, sysShare);
+        if (success) {
+            LOGGER(_log, V3_VERB, "child_main cpuratio=%.3f sys=%.3f\n", cpuShare, sysShare);
+        }
+
+        // For each solver thread
+        std::vector<long> threadTids = _engine.getSolverTids();
+        for (size_t i = 0; i < threadTids.size(); i++) {
+            if (threadTids[i] < 0) continue;
+            
+            success = Proc::getThreadCpuRatio(threadTids[i], cpuShare, sysShare);
+            if (success) {
+                LOGGER(_log, V3_VERB, "td.%ld cpuratio=%.3f sys=%.3f\n", threadTids[i], cpuShare, sysShare);
+            }
+        }
+
+        auto rtInfo = Proc::getRuntimeInfo(Proc::getPid(), Proc::SubprocessMode::FLAT);
+        LOGGER(_log, V3_VERB, "child_mem=%.3fGB\n", 0.001*0.001*rtInfo.residentSetSize);
+
+        // Distribution of this process's pages over the NUMA nodes
+        auto& numaNodes = _engine.getNumaNodes();
+        if (!numaNodes.empty()) {
+            auto pagesPerNode = Proc::getNumaPagesPerNode(Proc::getPid());
+            unsigned long numPages = 0, numRemotePages = 0;
+            std::string pagesStr;
+            for (size_t node = 0; node < pagesPerNode.size(); node++) {
+                numPages += pagesPerNode[node];
+                if (std::find(numaNodes.begin(), numaNodes.end(), (int)node) == numaNodes.end())
+                    numRemotePages += pagesPerNode[node];
+                pagesStr += " N" + std::to_string(node) + "=" + std::to_string(pagesPerNode[node]);
+            }
+            LOGGER(_log, V3_VERB, "numa_pages%s remote=%.4f\n", pagesStr.c_str(), 
+                numPages == 0 ? 0 : (double)numRemotePages / numPages);
+        }
+    }
+
     void importRevisions() {
-        while ((_hsm->doStartNextRevision && !_hsm->didStartNextRevision) 
-                || _last_imported_revision < _desired_revision) {
+        while (true) {
             if (_hsm->doTerminate) doTerminate();
-            if (_hsm->doStartNextRevision && !_hsm->didStartNextRevision) {
-                _desired_revision = _hsm->desiredRevision;
+            // Import each revision which the parent published
+            readTasks();
+            for (auto it = _tasks.begin(); it != _tasks.end();) {
+                if (it->type != SatSharedMemory::Message::START_NEXT_REVISION) {
+                    ++it;
+                    continue;
+                }
+                _desired_revision = it->revision;
                 _last_imported_revision++;
                 importRevision(_last_imported_revision, _checksum);
-                _hsm->didStartNextRevision = true;
                 _hsm->hasSolution = false;
-            } else doSleep();
-            if (!_hsm->doStartNextRevision) _hsm->didStartNextRevision = false;
+                respond(*it);
+                it = _tasks.erase(it);
+            }
+            if (_last_imported_revision >= _desired_revision) break;
+            doSleep();
         }
-        if (!_hsm->doStartNextRevision) _hsm->didStartNextRevision = false;
     }
 
     void importRevision(int revision, Checksum* checksum) {
@@ -274,6 +342,7 @@ private:
         LOGGER(_log, V4_VVER, "Read rev. %i/%i : %i lits, %i assumptions\n", revision, _desired_revision, *fSizePtr, *aSizePtr);
         int* fPtr = (int*) accessMemory(_shmem_id + ".formulae." + std::to_string(revision), sizeof(int) * (*fSizePtr));
         int* aPtr = (int*) accessMemory(_shmem_id + ".assumptions." + std::to_string(revision), sizeof(int) * (*aSizePtr));
+        const int* fLits = _engine.placeFormulaMemory(fPtr, *fSizePtr);
         
         if (checksum != nullptr) {
             // Append accessed data to local checksum
@@ -289,22 +358,16 @@ private:
             }
         }
 
-        _engine.appendRevision(revision, *fSizePtr, fPtr, *aSizePtr, aPtr, 
+        _engine.appendRevision(revision, *fSizePtr, fLits, *aSizePtr, aPtr, 
             /*finalRevisionForNow=*/revision == _desired_revision);
     }
 
     void doSleep() {
-        // Wait until something happens
-        // (can be interrupted by Fork::wakeUp(hsm->childPid))
-        float time = Timer::elapsedSeconds();
-
-        // busy waiting
-        //while (Timer::elapsedSeconds() - time < 0.001) {}
-
-        // sleeping
-        int sleepStatus = usleep(1000 /*1 millisecond*/);
-        time = Timer::elapsedSeconds() - time;
-        if (sleepStatus != 0) LOGGER(_log, V5_DEBG, "Woken up after %i us\n", (int) (1000*1000*time));
+        // Block until the parent or a solver thread rings the doorbell
+        // (or something else to check for may have happened: time out after a while)
+        _hsm->childDoorbell.waitUntilRung(_last_seen_num_rings, /*timeoutSeconds=*/0.01);
+        // Everything which happened before this point is noticed by the caller
+        _last_seen_num_rings = _hsm->childDoorbell.peek();
     }
 
     void doTerminate() {
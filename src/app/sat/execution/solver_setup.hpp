@@ -18,6 +18,8 @@ struct SolverSetup {
 	bool hasPseudoincrementalSolvers;
 	char solverType;
 	int solverRevision;
+	// NUMA node to place the solver's memory on (-1: any)
+	int numaNode {-1};
 	
 	int minNumChunksPerSolver;
 	int numBufferedClsGenerations;
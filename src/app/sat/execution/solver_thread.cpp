@@ -5,6 +5,7 @@
 #include "solver_thread.hpp"
 #include "engine.hpp"
 #include "util/sys/proc.hpp"
+#include "util/sys/timer.hpp"
 #include "util/hashing.hpp"
 
 using namespace SolvingStates;
@@ -37,6 +38,7 @@ void SolverThread::init() {
     LOGGER(_logger, V5_DEBG, "tid %ld\n", _tid);
     std::string threadName = "SATSolver#" + std::to_string(_local_id);
     Proc::nameThisThread(threadName.c_str());
+    pin();
     
     _active_revision = 0;
     _imported_lits_curr_revision = 0;
@@ -44,6 +46,17 @@ void SolverThread::init() {
     _initialized = true;
 }
 
+void SolverThread::pin() {
+    if (_numa_node < 0) return;
+    // Since the solver allocates most of its memory in this thread,
+    // the memory is placed on the same node
+    if (Proc::pinThisThreadToNumaNode(_numa_node)) {
+        LOGGER(_logger, V4_VVER, "pinned to NUMA node %i\n", _numa_node);
+    } else {
+        LOGGER(_logger, V1_WARN, "[WARN] Could not pin to NUMA node %i\n", _numa_node);
+    }
+}
+
 void* SolverThread::run() {
 
     diversifyInitially();        
@@ -85,21 +98,22 @@ bool SolverThread::readFormula() {
     size_t aSize = 0;
     const int* aLits;
 
-    while (true) {
-
-        // Shuffle input if necessary
-        if (_imported_lits_curr_revision == 0 && _shuffle) {
-            LOGGER(_logger, V4_VVER, "Shuffling input rev. %i\n", (int)_active_revision);
-            {
-                auto lock = _state_mutex.getLock();
-                assert(_active_revision < (int)_pending_formulae.size());
-                fSize = _pending_formulae[_active_revision].first;
-                fLits = _pending_formulae[_active_revision].second;
-            }
-            auto [sData, sSize] = _shuffler.doShuffle(fLits, fSize);
-            _pending_formulae[_active_revision].first = sSize;
-            _pending_formulae[_active_revision].second = sData;
+    // Begin with the clauses retained from former solvers
+    if (!_retained_clauses.empty()) {
+        std::vector<int> lits;
+        size_t numClauses = 0;
+        for (size_t pos = 0; pos < _retained_clauses.size(); pos += 2+_retained_clauses[pos]) {
+            int size = _retained_clauses[pos];
+            lits.insert(lits.end(), _retained_clauses.begin()+pos+2, _retained_clauses.begin()+pos+2+size);
+            lits.push_back(0);
+            numClauses++;
         }
+        _solver.addClauses(lits.data(), lits.size());
+        LOGGER(_logger, V4_VVER, "Added %lu retained clauses\n", numClauses);
+        _retained_clauses = std::vector<int>();
+    }
+
+    while (true) {
 
         // Fetch the next formula to read
         {
@@ -111,22 +125,38 @@ bool SolverThread::readFormula() {
             aLits = _pending_assumptions[_active_revision].second;
         }
 
+        // Shuffle input if necessary
+        if (_imported_lits_curr_revision == 0 && _shuffle) {
+            LOGGER(_logger, V4_VVER, "Shuffling input rev. %i\n", (int)_active_revision);
+            _shuffler.reset(fLits, fSize);
+        }
+
         LOGGER(_logger, V4_VVER, "Reading rev. %i, start %i\n", (int)_active_revision, (int)_imported_lits_curr_revision);
         
         // Read the formula in batches from the point where you left off
-        for (size_t start = _imported_lits_curr_revision; start < fSize; start += batchSize) {
+        for (size_t start = _imported_lits_curr_revision; start < fSize; ) {
 
+            float time = Timer::elapsedSeconds();
+            // The batch to read: positions [begin, end) of lits
+            const int* lits = fLits;
+            size_t begin = start;
             size_t end = std::min(start+batchSize, fSize);
-            for (size_t i = start; i < end; i++) {
-                int lit = fLits[i];
+            if (_shuffle) {
+                // Batch of whole clauses in shuffled order
+                begin = 0;
+                end = _shuffler.nextBatch(_shuffled_lits, batchSize);
+                lits = _shuffled_lits.data();
+            }
+            for (size_t i = begin; i < end; i++) {
+                int lit = lits[i];
                 if (std::abs(lit) > 134217723) {
                     LOGGER(_logger, V0_CRIT, "[ERROR] Invalid literal at rev. %i pos. %ld/%ld. Last %i literals: %i %i %i %i %i\n", 
                         (int)_active_revision, i, fSize,
                         (int) std::min(i+1, (size_t)5),
-                        i >= 4 ? fLits[i-4] : 0,
-                        i >= 3 ? fLits[i-3] : 0,
-                        i >= 2 ? fLits[i-2] : 0,
-                        i >= 1 ? fLits[i-1] : 0,
+                        i >= 4 ? lits[i-4] : 0,
+                        i >= 3 ? lits[i-3] : 0,
+                        i >= 2 ? lits[i-2] : 0,
+                        i >= 1 ? lits[i-1] : 0,
                         lit
                     );
                     abort();
@@ -135,21 +165,29 @@ bool SolverThread::readFormula() {
                     LOGGER(_logger, V0_CRIT, "[ERROR] Empty clause at rev. %i pos. %ld/%ld. Last %i literals: %i %i %i %i %i\n", 
                         (int)_active_revision, i, fSize,
                         (int) std::min(i+1, (size_t)5),
-                        i >= 4 ? fLits[i-4] : 0,
-                        i >= 3 ? fLits[i-3] : 0,
-                        i >= 2 ? fLits[i-2] : 0,
-                        i >= 1 ? fLits[i-1] : 0,
+                        i >= 4 ? lits[i-4] : 0,
+                        i >= 3 ? lits[i-3] : 0,
+                        i >= 2 ? lits[i-2] : 0,
+                        i >= 1 ? lits[i-1] : 0,
                         lit
                     );
                     abort();
                 }
-                _solver.addLiteral(_vt.getTldLit(lit));
                 _max_var = std::max(_max_var, std::abs(lit));
                 _last_read_lit_zero = lit == 0;
-                _imported_lits_curr_revision++;
-                //_dbg_lits += std::to_string(lit]) + " ";
-                //if (lit == 0) _dbg_lits += "\n";
             }
+
+            // Hand the entire batch to the solver, translated only if there are extra variables
+            if (_vt.getExtraVariables().empty()) {
+                _solver.addClauses(lits+begin, end-begin);
+            } else {
+                _tld_lits.resize(end-begin);
+                for (size_t i = begin; i < end; i++) _tld_lits[i-begin] = _vt.getTldLit(lits[i]);
+                _solver.addClauses(_tld_lits.data(), _tld_lits.size());
+            }
+            start += end-begin;
+            _imported_lits_curr_revision += end-begin;
+            _solver.getSolverStatsRef().loadTime += Timer::elapsedSeconds() - time;
             
             waitWhileSuspended();
             if (_terminated) return false;
@@ -162,7 +200,7 @@ bool SolverThread::readFormula() {
 
             // If necessary, introduce extra variable to the problem
             // to encode equivalence to the set of assumptions
-            if (_has_pseudoincremental_solvers && _active_revision >= _vt.getExtraVariables().size()) {
+            if (_has_pseudoincremental_solvers && _active_revision >= (int)_vt.getExtraVariables().size()) {
                 _vt.addExtraVariable(_max_var);
                 int aEquivVar = _vt.getExtraVariables().back();
                 LOGGER(_logger, V4_VVER, "Encoding equivalence for %i assumptions of rev. %i/%i @ var. %i\n", 
@@ -195,6 +233,7 @@ bool SolverThread::readFormula() {
             // No formula left to read?
             if (_active_revision == _latest_revision) {
                 LOGGER(_logger, V4_VVER, "Reading done @ rev. %i\n", (int)_active_revision);                
+                _read_formula = true;
                 return true;
             }
             _active_revision++;
@@ -211,6 +250,7 @@ void SolverThread::appendRevision(int revision, size_t fSize, const int* fLits,
         _pending_assumptions.emplace_back(aSize, aLits);
         LOGGER(_logger, V4_VVER, "Received %i assumptions\n", aSize);
         _latest_revision = revision;
+        _read_formula = false;
         _found_result = false;
         assert(_latest_revision+1 == (int)_pending_formulae.size() 
             || LOG_RETURN_FALSE("%i != %i", _latest_revision+1, _pending_formulae.size()));
@@ -247,6 +287,34 @@ void SolverThread::diversifyAfterReading() {
     }
 }
 
+// Sets the phases of the solver to the best assignment found by local search
+// if it improved since the last solving attempt
+void SolverThread::applyPhaseHints() {
+    if (_phase_hints == nullptr || _solver.getSolverSetup().solverType == 'y') return;
+    std::vector<int> assignment;
+    int version = _phase_hints_version;
+    if (!_phase_hints->fetch(version, assignment)) return;
+    _phase_hints_version = version;
+    int numVars = std::min((int)assignment.size()-1, _solver.getVariablesCount());
+    for (int var = 1; var <= numVars; var++) {
+        if (assignment[var] != 0) _solver.setPhase(var, assignment[var] > 0);
+    }
+    LOGGER(_logger, V4_VVER, "applied phase hints v%i\n", version);
+}
+
+// Interrupts the running solving attempt if the phase hints improved since they were
+// last applied. The attempt is then resumed with the new phases. Solvers which cannot
+// solve repeatedly are not interrupted; they only apply hints at new attempts.
+void SolverThread::interruptForPhaseHints() {
+    if (_phase_hints == nullptr || !_solver.supportsIncrementalSat()) return;
+    if (_phase_hints->getVersion() == _phase_hints_version) return;
+    auto lock = _state_mutex.getLock();
+    if (!_initialized || _interrupted || _suspended || _found_result) return;
+    LOGGER(_logger, V4_VVER, "interrupt to apply phase hints v%i\n", _phase_hints->getVersion());
+    _solver.interrupt();
+    _interrupted = true;
+}
+
 void SolverThread::runOnce() {
 
     // Set up correct solver state (or return if not possible)
@@ -282,8 +350,12 @@ void SolverThread::runOnce() {
     //std::ofstream ofs("DBG_" + std::to_string(_solver.getGlobalId()) + "_" + std::to_string(_active_revision));
     //ofs << _dbg_lits << "\n";
     //ofs.close();
+    applyPhaseHints();
     SatResult res;
-    if (_solver.supportsIncrementalSat()) {
+    if (_cube_queue != nullptr && _solver.supportsIncrementalSat() && solveCubes(revision, aSize, aLits)) {
+        // Any result has been reported already
+        res = UNKNOWN;
+    } else if (_solver.supportsIncrementalSat()) {
         res = _solver.solve(aSize, aLits);
     } else {
         // Add assumptions as permanent unit clauses
@@ -293,6 +365,8 @@ void SolverThread::runOnce() {
         }
         res = _solver.solve(0, nullptr);
     }
+    // Export the clauses learned last
+    _solver.flushLearnedClauses();
     // Uninterrupt solver (if it was interrupted)
     {
         auto lock = _state_mutex.getLock();
@@ -305,6 +379,97 @@ void SolverThread::runOnce() {
     reportResult(res, revision);
 }
 
+// Solves cubes from the cube queue until a result is found, the attempt is
+// interrupted (returns true), or no open cubes are left (returns false).
+bool SolverThread::solveCubes(int revision, size_t aSize, const int* aLits) {
+
+    std::vector<int> cube;
+    while (!_terminated && !_interrupted && !_suspended) {
+        auto status = _cube_queue->fetch(revision, cube);
+        // No open cubes left: help out by solving the entire revision
+        if (status == CubeQueue::EXHAUSTED) return false;
+        if (status == CubeQueue::GENERATE) {
+            _cube_queue->generate(revision, getSplittingVariables(_cube_queue->getMaxDepth()));
+            continue;
+        }
+
+        // Solve the cube under the revision's assumptions
+        std::vector<int> assumptions(aLits, aLits+aSize);
+        assumptions.insert(assumptions.end(), cube.begin(), cube.end());
+        applyPhaseHints();
+        LOGGER(_logger, V5_DEBG, "BEGCUBE rev. %i (%i literals)\n", revision, cube.size());
+        auto res = _solver.solve(assumptions.size(), assumptions.data());
+        LOGGER(_logger, V5_DEBG, "ENDCUBE %i\n", res);
+        if (res == UNKNOWN) {
+            _cube_queue->giveBack(revision, std::move(cube));
+            return true;
+        }
+        if (res == SAT) {
+            reportResult(res, revision);
+            return true;
+        }
+        // Unsatisfiable: Does the conflict depend on the cube at all?
+        auto failed = _solver.getFailedAssumptions();
+        bool cubeFailed = false;
+        for (int lit : cube) cubeFailed |= failed.count(lit) > 0;
+        if (!cubeFailed) {
+            reportResult(res, revision);
+            return true;
+        }
+        if (_cube_queue->refute(revision)) {
+            // All cubes are refuted
+            LOGGER(_logger, V4_VVER, "refuted last cube of rev. %i\n", revision);
+            std::vector<int> failedAssumptions(aLits, aLits+aSize);
+            reportResult(res, revision, &failedAssumptions);
+            return true;
+        }
+    }
+    return true;
+}
+
+// Returns up to the given number of variables to split the search space on:
+// the variable of the solver's choice, followed by the most frequent variables.
+std::vector<int> SolverThread::getSplittingVariables(int numVars) {
+
+    std::vector<int> vars;
+    int solverVar = std::abs(_solver.getSplittingVariable());
+    if (solverVar != 0) vars.push_back(solverVar);
+
+    std::vector<std::pair<size_t, const int*>> formulae;
+    {
+        auto lock = _state_mutex.getLock();
+        formulae.insert(formulae.end(), _pending_formulae.begin(), 
+            _pending_formulae.begin()+_active_revision+1);
+    }
+    std::vector<unsigned int> occurrences(_max_var+1, 0);
+    for (auto& [size, lits] : formulae) {
+        for (size_t i = 0; i < size; i++) {
+            int var = std::abs(lits[i]);
+            if (var <= _max_var) occurrences[var]++;
+        }
+    }
+    occurrences[0] = 0;
+
+    // Find the most frequent variables
+    const size_t maxNumVars = std::max(0, numVars);
+    std::vector<int> frequentVars;
+    for (int var = 1; var <= _max_var; var++) {
+        if (occurrences[var] == 0) continue;
+        if (frequentVars.size() == maxNumVars && occurrences[var] <= occurrences[frequentVars.back()]) continue;
+        auto it = frequentVars.begin();
+        while (it != frequentVars.end() && occurrences[*it] >= occurrences[var]) ++it;
+        frequentVars.insert(it, var);
+        if (frequentVars.size() > maxNumVars) frequentVars.pop_back();
+    }
+    for (int var : frequentVars) {
+        if (vars.size() >= maxNumVars) break;
+        int tldVar = _vt.getTldLit(var);
+        if (tldVar != solverVar) vars.push_back(tldVar);
+    }
+    LOGGER(_logger, V4_VVER, "split rev. %i on %i variables\n", (int)_active_revision, vars.size());
+    return vars;
+}
+
 void SolverThread::waitWhileSolved() {
     waitUntil([&]{return _terminated || !_found_result;});
 }
@@ -317,7 +482,7 @@ void SolverThread::waitUntil(std::function<bool()> predicate) {
     _state_cond.wait(_state_mutex, predicate);
 }
 
-void SolverThread::reportResult(int res, int revision) {
+void SolverThread::reportResult(int res, int revision, const std::vector<int>* failedAssumptions) {
 
     if (res == 0 || _found_result) return;
     const char* resultString = res==SAT?"SAT":"UNSAT";
@@ -332,35 +497,42 @@ void SolverThread::reportResult(int res, int revision) {
     LOGGER(_logger, V3_VERB, "found result %s for rev. %i\n", resultString, revision);
     _result.result = SatResult(res);
     _result.revision = revision;
+    std::vector<int> solution;
     if (res == SAT) { 
-        auto solution = _solver.getSolution();
-        _result.setSolutionToSerialize(solution.data(), solution.size());
+        solution = _solver.getSolution();
+    } else if (failedAssumptions != nullptr) {
+        solution = *failedAssumptions;
     } else {
         auto failed = _solver.getFailedAssumptions();
-        auto failedVec = std::vector<int>(failed.begin(), failed.end());
-        _result.setSolutionToSerialize(failedVec.data(), failedVec.size());
+        solution = std::vector<int>(failed.begin(), failed.end());
     }
 
     // If necessary, convert solution back to original variable domain
     if (!_vt.getExtraVariables().empty()) {
         std::vector<int> origSolution;
-        for (size_t i = 0; i < _result.getSolutionSize(); i++) {
+        for (size_t i = 0; i < solution.size(); i++) {
             if (res == UNSAT) {
                 // Failed assumption
-                origSolution.push_back(_vt.getOrigLitOrZero(_result.getSolution(i)));
+                origSolution.push_back(_vt.getOrigLitOrZero(solution[i]));
             } else if (i > 0) {
                 // Assignment: v or -v at position v
-                assert(_result.getSolution(i) == i || _result.getSolution(i) == -i);
-                int origLit = _vt.getOrigLitOrZero(_result.getSolution(i));
+                assert(solution[i] == (int)i || solution[i] == -(int)i);
+                int origLit = _vt.getOrigLitOrZero(solution[i]);
                 if (origLit != 0) origSolution.push_back(origLit);
-                assert(origSolution[origSolution.size()-1] == origSolution.size()-1 
-                    || origSolution[origSolution.size()-1] == 1-origSolution.size());
+                assert(origSolution[origSolution.size()-1] == (int)origSolution.size()-1 
+                    || origSolution[origSolution.size()-1] == 1-(int)origSolution.size());
             } else origSolution.push_back(0); // position zero
         }
-        _result.setSolutionToSerialize(origSolution.data(), origSolution.size());
+        solution = std::move(origSolution);
     }
 
+    // Models are passed on in compact form
+    _result.encodedType = JobResult::INT;
+    if (res == SAT) _result.setModelToSerialize(solution.data(), solution.size());
+    else _result.setSolutionToSerialize(solution.data(), solution.size());
+
     _found_result = true;
+    if (_result_callback) _result_callback();
 }
 
 SolverThread::~SolverThread() {
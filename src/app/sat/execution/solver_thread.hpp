@@ -17,6 +17,8 @@
 #include "solving_state.hpp"
 #include "clause_shuffler.hpp"
 #include "variable_translator.hpp"
+#include "cube_queue.hpp"
+#include "../data/phase_hints.hpp"
 
 // Forward declarations
 class SatEngine;
@@ -35,6 +37,9 @@ private:
     
     ClauseShuffler _shuffler;
     bool _shuffle;
+    std::vector<int> _shuffled_lits; // buffer for a batch of shuffled clauses
+    std::vector<int> _retained_clauses; // learned clauses to add before the formula
+    int _numa_node = -1; // NUMA node to run on (-1: any)
 
     int _local_id;
     std::string _name;
@@ -52,15 +57,23 @@ private:
     bool _last_read_lit_zero = true;
     int _max_var = 0;
     VariableTranslator _vt;
+    std::vector<int> _tld_lits; // buffer for a batch of translated literals
     bool _has_pseudoincremental_solvers;
 
     std::atomic_bool _initialized = false;
+    std::atomic_bool _read_formula = false; // all received revisions were handed to the solver
     std::atomic_bool _interrupted = false;
     std::atomic_bool _suspended = false;
     std::atomic_bool _terminated = false;
 
     bool _found_result = false;
     JobResult _result;
+    // Called (from the solver thread) whenever a result was found
+    std::function<void()> _result_callback;
+    // Cubes shared by the solver threads of this process (if the search space is split)
+    CubeQueue* _cube_queue = nullptr;
+    PhaseHints* _phase_hints = nullptr;
+    std::atomic_int _phase_hints_version = 0;
 
 
 public:
@@ -85,10 +98,22 @@ public:
         _state_cond.notify();
     }
     void tryJoin() {if (_thread.joinable()) _thread.join();}
+    void setResultCallback(std::function<void()> callback) {_result_callback = callback;}
+    void setCubeQueue(CubeQueue* cubeQueue) {_cube_queue = cubeQueue;}
+    void setPhaseHints(PhaseHints* phaseHints) {_phase_hints = phaseHints;}
+    void interruptForPhaseHints();
+    // Clauses (each as size, LBD, literals) implied by the permanent formula,
+    // which the solver receives before the formula. Must be set before start().
+    void setRetainedClauses(std::vector<int>&& clauses) {_retained_clauses = std::move(clauses);}
+    // Must be set before start().
+    void setNumaNode(int node) {_numa_node = node;}
 
     bool isInitialized() const {
         return _initialized;
     }
+    bool hasReadFormula() const {
+        return _initialized && _read_formula;
+    }
     int getTid() const {
         return _tid;
     }
@@ -111,14 +136,17 @@ private:
 
     void diversifyInitially();
     void diversifyAfterReading();
+    void applyPhaseHints();
 
     void runOnce();
+    bool solveCubes(int revision, size_t aSize, const int* aLits);
+    std::vector<int> getSplittingVariables(int numVars);
     
     void waitWhileSolved();
     void waitWhileSuspended();
     void waitUntil(std::function<bool()> predicate);
     
-    void reportResult(int res, int revision);
+    void reportResult(int res, int revision, const std::vector<int>* failedAssumptions = nullptr);
 
     const char* toStr();
 
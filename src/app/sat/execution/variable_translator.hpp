@@ -2,49 +2,121 @@
 #pragma once
 
 #include <vector>
+#include <stdint.h>
 #include <math.h>
 #include "util/assert.hpp"
 
+// Translates between the variables of the original formula and the variables
+// of a solver which additionally holds extra variables (encoding each revision's
+// assumptions) interspersed with the original ones. The solver variables up to the
+// most recent extra variable are represented by a bitvector which marks the extra
+// variables, supplemented with rank counts per block and a sampled select index.
+// This takes about 1.1 bits per variable (plus an int per extra variable), instead
+// of two ints per variable for plain lookup tables, which matters since each solver
+// thread holds its own translator. Lookups in both directions take constant
+// time, except for select queries which skip over blocks consisting of extra
+// variables only (at most one block per 512 revisions).
 class VariableTranslator {
 
 private:
-    bool _empty = true;
+    static constexpr int WORDS_PER_BLOCK = 8;
+    static constexpr int BITS_PER_BLOCK = 64 * WORDS_PER_BLOCK;
+
     std::vector<int> _extra_variables;
+    // Bit i is set iff solver variable i is an extra variable
+    std::vector<uint64_t> _is_extra;
+    // For each block of the bitvector: the number of extra variables in front of it
+    std::vector<int> _extra_vars_before_block;
+    // For each k: the block which holds original variable k*BITS_PER_BLOCK
+    std::vector<int> _block_of_sampled_orig_var;
 
 public:
     void addExtraVariable(int latestOrigMaxVar) {
         assert(latestOrigMaxVar >= 0);
         int tldMaxVar = getTldLit(latestOrigMaxVar);
         do tldMaxVar++; while (!_extra_variables.empty() && _extra_variables.back() >= tldMaxVar);
+
+        // All variables between the former last and the new extra variable are original
+        // ones, shifted by all extra variables so far
+        const int numExtraVars = _extra_variables.size();
+        _is_extra.resize(tldMaxVar / 64 + 1, 0);
+        _is_extra[tldMaxVar / 64] |= 1ULL << (tldMaxVar % 64);
+        while ((int)_extra_vars_before_block.size() * BITS_PER_BLOCK <= tldMaxVar)
+            _extra_vars_before_block.push_back(numExtraVars);
+        int numOrigVars = tldMaxVar - numExtraVars; // in front of the new extra variable
+        while ((int)_block_of_sampled_orig_var.size() * BITS_PER_BLOCK < numOrigVars) {
+            int origVar = _block_of_sampled_orig_var.size() * BITS_PER_BLOCK;
+            _block_of_sampled_orig_var.push_back(getTldLit(origVar) / BITS_PER_BLOCK);
+        }
+
         _extra_variables.push_back(tldMaxVar);
-        _empty = false;
     }
 
-    int getTldLit(int origLit) {
-        if (_empty) return origLit;
+    int getTldLit(int origLit) const {
+        if (_extra_variables.empty()) return origLit;
         int absLit = std::abs(origLit);
-        for (int tldExtraVar : _extra_variables) {
-            if (tldExtraVar > absLit) break;
-            absLit++;
-        }
-        return (origLit>0?1:-1) * absLit;
+        const int numExtraVars = _extra_variables.size();
+        int tldVar = absLit + numExtraVars <= _extra_variables.back() ?
+            select0(absLit) : absLit + numExtraVars;
+        return (origLit>0?1:-1) * tldVar;
     }
 
-    int getOrigLitOrZero(int tldLit) {
-        if (_empty) return tldLit;
+    int getOrigLitOrZero(int tldLit) const {
+        if (_extra_variables.empty()) return tldLit;
         int absLit = std::abs(tldLit);
-        int shift = 0;
-        for (int tldExtraVar : _extra_variables) {
-            if (tldExtraVar >= absLit) {
-                if (tldExtraVar == absLit) return 0; // is an extra var!
-                break;
-            }
-            shift++;
-        }
-        return (tldLit>0?1:-1) * (absLit-shift);
+        int origVar;
+        if (absLit > _extra_variables.back()) origVar = absLit - (int)_extra_variables.size();
+        else if (isExtra(absLit)) origVar = 0;
+        else origVar = absLit - rank1(absLit);
+        return (tldLit>0?1:-1) * origVar; // zero for an extra variable
     }
 
     const std::vector<int>& getExtraVariables() const {
         return _extra_variables;
     }
+
+    size_t getMemoryBytes() const {
+        return sizeof(int) * (_extra_variables.capacity() + _extra_vars_before_block.capacity()
+            + _block_of_sampled_orig_var.capacity()) + sizeof(uint64_t) * _is_extra.capacity();
+    }
+
+private:
+    bool isExtra(int tldVar) const {
+        return (_is_extra[tldVar / 64] >> (tldVar % 64)) & 1;
+    }
+
+    // Number of extra variables in front of the given solver variable
+    int rank1(int tldVar) const {
+        int block = tldVar / BITS_PER_BLOCK;
+        int rank = _extra_vars_before_block[block];
+        int word = block * WORDS_PER_BLOCK;
+        for (; word < tldVar / 64; word++) rank += __builtin_popcountll(_is_extra[word]);
+        uint64_t mask = (1ULL << (tldVar % 64)) - 1;
+        return rank + __builtin_popcountll(_is_extra[word] & mask);
+    }
+
+    // Number of original variables (including zero) in front of the given block
+    int getOrigVarsBeforeBlock(int block) const {
+        return block * BITS_PER_BLOCK - _extra_vars_before_block[block];
+    }
+
+    // The solver variable of the given original variable, which must be located
+    // in front of the last extra variable
+    int select0(int origVar) const {
+        int block = _block_of_sampled_orig_var[origVar / BITS_PER_BLOCK];
+        while (block+1 < (int)_extra_vars_before_block.size() && getOrigVarsBeforeBlock(block+1) <= origVar)
+            block++;
+        int remaining = origVar - getOrigVarsBeforeBlock(block);
+        int word = block * WORDS_PER_BLOCK;
+        while (true) {
+            uint64_t origBits = ~_is_extra[word];
+            int numOrig = __builtin_popcountll(origBits);
+            if (remaining < numOrig) {
+                for (int i = 0; i < remaining; i++) origBits &= origBits - 1; // clear lowest bit
+                return 64 * word + __builtin_ctzll(origBits);
+            }
+            remaining -= numOrig;
+            word++;
+        }
+    }
 };
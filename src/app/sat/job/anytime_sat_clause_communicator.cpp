@@ -4,6 +4,7 @@
 #include "util/logger.hpp"
 #include "comm/mympi.hpp"
 #include "../sharing/filter/clause_filter.hpp"
+#include "../sharing/buffer/buffer_reducer.hpp"
 #include "util/sys/thread_pool.hpp"
 
 void advanceCollective(BaseSatJob* job, JobMessage& msg, int broadcastTag) {
@@ -34,9 +35,11 @@ void AnytimeSatClauseCommunicator::communicate() {
         if (_use_cls_history) _cls_history.onSuspend();
         // cancel any active sessions, sending neutral element upwards
         for (auto& session : _sessions) {
-            session._allreduce_clauses.cancel();
-            session._allreduce_filter.cancel();
+            session._allreduce_clauses->cancel();
+            session._allreduce_filter->cancel();
         }
+        for (auto& session : _host_sessions) session._allreduce_clauses->cancel();
+        _initiation_pending = false;
         return;
     }
     if (_suspended) {
@@ -54,21 +57,30 @@ void AnytimeSatClauseCommunicator::communicate() {
     while (_sessions.size() > 1) {
         auto& session = _sessions.front();
         if (!session.isDestructible()) break;
+        // sessions still in progress are only discarded if there are too many of them
+        if (session.isValid() && (int)_sessions.size() <= _params.maxSharingEpochsInFlight()) break;
         // can be deleted
         _sessions.pop_front();
     }
+    while (!_host_sessions.empty()) {
+        auto& session = _host_sessions.front();
+        if (!session.isDestructible() || session.isValid()) break;
+        _host_sessions.pop_front();
+    }
 
     // root: initiate sharing
     if (_job->getJobTree().isRoot()) {
         auto time = Timer::elapsedSeconds();
         bool nextEpochDue = time - _time_of_last_epoch_initiation >= _params.appCommPeriod();
-        bool lastEpochDone = _time_of_last_epoch_conclusion > 0;
-        if (nextEpochDue && !lastEpochDone) {
+        int numInFlight = getNumSessionsInFlight() + (_initiation_pending ? 1 : 0);
+        bool capacityLeft = numInFlight < _params.maxSharingEpochsInFlight();
+        if (nextEpochDue && !capacityLeft) {
             LOG(V1_WARN, "[WARN] %s : Next epoch over-due!\n", _job->toStr());
         }
-        if (nextEpochDue && lastEpochDone) {
+        if (nextEpochDue && capacityLeft) {
             _current_epoch++;
             JobMessage msg(_job->getId(), _job->getRevision(), _current_epoch, MSG_INITIATE_CLAUSE_SHARING);
+            msg.payload = getTopologyForNextEpoch().serialize();
 
             // Advance initiation time exactly by the specified period 
             // in order to lose no time for the subsequent epoch
@@ -77,57 +89,188 @@ void AnytimeSatClauseCommunicator::communicate() {
             if (time - _time_of_last_epoch_initiation >= _params.appCommPeriod())
                 _time_of_last_epoch_initiation = time;
             
-            _time_of_last_epoch_conclusion = 0;
+            _initiation_pending = true;
             
             // Self message to initiate clause sharing
             MyMpi::isend(_job->getJobTree().getRank(), MSG_SEND_APPLICATION_MESSAGE, msg);
-            LOG(V4_VVER, "%s CS init\n", _job->toStr());
+            LOG(V4_VVER, "%s CS init (%i in flight)\n", _job->toStr(), numInFlight);
             return;
         }
     }
 
-    if (_sessions.empty()) return;
-    auto& session = currentSession();
-    if (!session.isValid()) return;
+    // return messages whose epoch this node did not join in time
+    for (auto it = _early_messages.begin(); it != _early_messages.end();) {
+        if (Timer::elapsedSeconds() - it->time < _params.appCommPeriod()) {++it; continue;}
+        returnToSender(it->source, it->mpiTag, it->msg);
+        it = _early_messages.erase(it);
+    }
+
+    // topmost node of a group of co-located nodes: initiate host-level sharing
+    if (isHostLeaderOfGroup()) {
+        auto time = Timer::elapsedSeconds();
+        bool nextEpochDue = time - _time_of_last_host_epoch_initiation >= _params.appHostCommPeriod();
+        bool inFlight = !_host_sessions.empty() && _host_sessions.back().isValid();
+        if (nextEpochDue && !inFlight) {
+            _time_of_last_host_epoch_initiation = time;
+            beginHostSession(_current_host_epoch+1);
+        }
+    }
+
+    // Advance sessions in the order of their epochs (see SessionOrder)
+    SessionOrder::advance(_sessions, _host_sessions, 
+        [&](const Session& session) {return needsPreparedClauses(session);},
+        [&](Session& session, bool oldestWithoutClauses, bool mayFilter) {
+            advanceSession(session, oldestWithoutClauses, mayFilter);
+        },
+        [&](Session& session, bool oldestWithoutClauses) {
+            advanceHostSession(session, oldestWithoutClauses);
+        }
+    );
+}
+
+void AnytimeSatClauseCommunicator::beginHostSession(int epoch) {
+    _current_host_epoch = epoch;
+    LOG(V5_DEBG, "%s : INIT HOST COMM e=%i\n", _job->toStr(), epoch);
+    _host_sessions.emplace_back(_params, _job, _cdb, epoch, _next_session_seq++, /*hostLevel=*/true);
+    if (!_job->hasPreparedSharing()) {
+        int limit = _job->getBufferLimit(1, MyMpi::SELF);
+        _job->prepareSharing(limit);
+    }
+    // Forward initiation to co-located children only
+    auto& tree = _job->getJobTree();
+    JobMessage msg(_job->getId(), _job->getRevision(), epoch, MSG_INITIATE_HOST_CLAUSE_SHARING);
+    if (tree.hasLeftChild() && HostComm::isOnSameHost(tree.getRank(), tree.getLeftChildNodeRank()))
+        MyMpi::isend(tree.getLeftChildNodeRank(), MSG_SEND_APPLICATION_MESSAGE, msg);
+    if (tree.hasRightChild() && HostComm::isOnSameHost(tree.getRank(), tree.getRightChildNodeRank()))
+        MyMpi::isend(tree.getRightChildNodeRank(), MSG_SEND_APPLICATION_MESSAGE, msg);
+}
+
+void AnytimeSatClauseCommunicator::advanceHostSession(Session& session, bool oldestWithoutClauses) {
+
+    if (oldestWithoutClauses && _job->hasPreparedSharing()) {
+        LOG(V4_VVER, "%s CS produce host cls e=%i\n", _job->toStr(), session._epoch);
+        session._allreduce_clauses->produce([&]() {
+            Checksum checksum;
+            auto clauses = _job->getPreparedClauses(checksum);
+            return Session::getClauseContribution(_params, std::move(clauses), getNewImportAcceptance());
+        });
+    } else if (oldestWithoutClauses) {
+        _job->prepareSharing(_job->getBufferLimit(1, MyMpi::SELF));
+    }
+
+    session._allreduce_clauses->advance();
+    if (!session._allreduce_clauses->hasResult()) return;
+
+    if (session._excess_clauses_from_merge.size() > sizeof(size_t)/sizeof(int)) {
+        _job->returnClauses(session._excess_clauses_from_merge);
+    }
+
+    // Import the clauses of the host's nodes. They are not filtered against the
+    // clauses shared previously: this only happens in the job-wide sessions.
+    // Clauses imported from a host-level session before are dropped, and the others
+    // are remembered so that they are not imported again from the job-wide sessions.
+    auto clauses = session._allreduce_clauses->extractResult();
+    clauses.pop_back(); // # aggregated workers
+    if (Session::reportsAcceptance(_params)) {
+        ImportAcceptance acceptance;
+        acceptance.deserializeFrom(clauses);
+        // The host leader reports the acceptance for the entire host in the next job-wide session
+        if (!isHostMember()) _host_acceptance_for_global.aggregate(acceptance);
+    }
+    float time = Timer::elapsedSeconds();
+    _host_imported_clauses.forgetOlderThan(time - 
+        (2 + _params.maxSharingEpochsInFlight()) * _params.appCommPeriod());
+    int numKnown = _host_imported_clauses.removeKnownAndAdd(clauses, time);
+    LOG(V4_VVER, "%s CS digest host cls e=%i len=%i (%i known dropped, %lu remembered)\n", _job->toStr(), 
+        session._epoch, clauses.size(), numKnown, _host_imported_clauses.size());
+    _job->digestSharingWithoutFilter(clauses);
+
+    if (!isHostMember()) {
+        // Host leader: retain the best of these clauses for the next job-wide contribution
+        if (_host_clauses_for_global.empty()) {
+            _host_clauses_for_global = std::move(clauses);
+        } else {
+            auto merger = _cdb.getBufferMerger(_job->getBufferLimit(1, MyMpi::ALL));
+            merger.add(_cdb.getBufferReader(_host_clauses_for_global.data(), _host_clauses_for_global.size()));
+            merger.add(_cdb.getBufferReader(clauses.data(), clauses.size()));
+            _host_clauses_for_global = merger.merge();
+        }
+    }
+    session.setConcluded();
+}
+
+void AnytimeSatClauseCommunicator::advanceSession(Session& session, bool oldestWithoutClauses, bool mayFilter) {
+
+    if (isHostMember() && !session._allreduce_clauses->hasProducer()) {
+
+        // Hierarchical sharing: the clauses of this node reach the job-wide sharing
+        // via the host leader, so contribute an empty buffer which does not count
+        // towards the buffer limits
+        session._allreduce_clauses->produce([&]() {
+            return Session::getClauseContribution(_params, std::vector<int>(), ImportAcceptance(), 0);
+        });
 
-    // Done preparing sharing?
-    if (!session._allreduce_clauses.hasProducer() && _job->hasPreparedSharing()) {
+    } else if (oldestWithoutClauses && _job->hasPreparedSharing()) {
 
         // Produce contribution to all-reduction of clauses
-        LOG(V4_VVER, "%s CS produce cls\n", _job->toStr());
-        session._allreduce_clauses.produce([&]() {
+        LOG(V4_VVER, "%s CS produce cls e=%i\n", _job->toStr(), session._epoch);
+        session._allreduce_clauses->produce([&]() {
             Checksum checksum;
             auto clauses = _job->getPreparedClauses(checksum);
-            clauses.push_back(1); // # aggregated workers
-            return clauses;
+            if (!_host_clauses_for_global.empty()) {
+                // Host leader: contribute the clauses of the host's nodes as well
+                auto merger = _cdb.getBufferMerger(_job->getBufferLimit(1, MyMpi::ALL));
+                merger.add(_cdb.getBufferReader(clauses.data(), clauses.size()));
+                merger.add(_cdb.getBufferReader(_host_clauses_for_global.data(), _host_clauses_for_global.size()));
+                std::vector<int> excess;
+                clauses = merger.merge(&excess);
+                if (excess.size() > sizeof(size_t)/sizeof(int)) _job->returnClauses(excess);
+                LOG(V4_VVER, "%s CS host contrib e=%i len=%i\n", _job->toStr(), session._epoch, clauses.size());
+                _host_clauses_for_global.clear();
+            }
+            if (_max_shared_clause_length < _params.strictClauseLengthLimit()
+                    || _max_shared_clause_lbd < _params.strictLbdLimit()) {
+                // Only share clauses of the currently admitted lengths and LBDs
+                BufferReducer reducer(clauses.data(), clauses.size(), 
+                    _params.strictClauseLengthLimit(), _params.groupClausesByLengthLbdSum());
+                clauses.resize(reducer.reduce([&](const Mallob::Clause& c) {
+                    return c.size <= _max_shared_clause_length && c.lbd <= _max_shared_clause_lbd;
+                }));
+            }
+            auto acceptance = getNewImportAcceptance();
+            acceptance.aggregate(_host_acceptance_for_global);
+            _host_acceptance_for_global = ImportAcceptance();
+            return Session::getClauseContribution(_params, std::move(clauses), acceptance);
         });
     
         // Calculate new sharing compensation factor from last sharing statistics
         auto [nbAdmitted, nbBroadcast] = _job->getLastAdmittedClauseShare();
+        // Clauses dropped locally for being imported at host level did pass the global filter
+        nbAdmitted = std::min(nbBroadcast, nbAdmitted + _last_num_host_imported_clauses);
         float admittedRatio = nbBroadcast == 0 ? 1 : ((float)nbAdmitted) / nbBroadcast;
         admittedRatio = std::max(0.01f, admittedRatio);
         float newCompensationFactor = std::max(1.f, std::min(
             (float)_params.clauseHistoryAggregationFactor(), 1.f/admittedRatio
         ));
         _compensation_factor = _compensation_decay * _compensation_factor + (1-_compensation_decay) * newCompensationFactor;
-        _job->setSharingCompensationFactor(_compensation_factor);
+        _job->setSharingCompensationFactor(_compensation_factor * _volume_factor);
         if (_job->getJobTree().isRoot()) {
             LOG(V3_VERB, "%s CS last sharing: %i/%i globally passed ~> c=%.3f\n", _job->toStr(), 
                 nbAdmitted, nbBroadcast, _compensation_factor);       
         }
     
-    } else if (!session._allreduce_clauses.hasProducer()) {
+    } else if (oldestWithoutClauses) {
         // No sharing prepared yet: Retry
         _job->prepareSharing(_job->getBufferLimit(1, MyMpi::SELF));
     }
     
     // Advance all-reduction of clauses
-    session._allreduce_clauses.advance();
+    session._allreduce_clauses->advance();
 
     // All-reduction of clauses finished?
-    if (session._allreduce_clauses.hasResult()) {
+    if (session._allreduce_clauses->hasResult()) {
 
-        LOG(V4_VVER, "%s CS filter\n", _job->toStr());
+        LOG(V4_VVER, "%s CS received cls e=%i\n", _job->toStr(), session._epoch);
 
         // Some clauses may have been left behind during merge
         if (session._excess_clauses_from_merge.size() > sizeof(size_t)/sizeof(int)) {
@@ -137,36 +280,93 @@ void AnytimeSatClauseCommunicator::communicate() {
         }
 
         // Fetch initial clause buffer (result of all-reduction of clauses)
-        session._broadcast_clause_buffer = session._allreduce_clauses.extractResult();
+        session._broadcast_clause_buffer = session._allreduce_clauses->extractResult();
+        // Separate the job-wide acceptance of imported clauses
+        auto& buffer = session._broadcast_clause_buffer;
+        if (!buffer.empty() && Session::reportsAcceptance(_params)) {
+            int numAggregated = buffer.back();
+            buffer.pop_back();
+            ImportAcceptance acceptance;
+            acceptance.deserializeFrom(buffer);
+            buffer.push_back(numAggregated);
+            adaptSharingVolume(acceptance);
+            if (_hierarchical && _job->getJobTree().isRoot()) {
+                // Job-wide results are exchanged among the host leaders only
+                _inter_host_bytes += buffer.size() * sizeof(int);
+                _num_accepted_imports += acceptance.getNumAccepted();
+                LOG(V3_VERB, "%s CS inter-host e=%i %lu bytes, %lu accepted imports (%.1f bytes per accepted import)\n", 
+                    _job->toStr(), session._epoch, _inter_host_bytes, _num_accepted_imports, 
+                    _num_accepted_imports == 0 ? 0.0 : (double)_inter_host_bytes / _num_accepted_imports);
+            }
+        }
+        if (session._topology.type == AllReductionTopology::BUTTERFLY) session.setBufferHash();
+    }
 
-        // Initiate production of local filter element for 2nd all-reduction 
-        _job->filterSharing(session._broadcast_clause_buffer);
+    // Initiate production of local filter element for 2nd all-reduction 
+    // as soon as all older sessions are done with their filtering
+    if (mayFilter && !session.isFiltering() && session._allreduce_clauses->hasProducer() 
+            && !session._allreduce_clauses->isValid() && session._allreduce_filter->isValid()) {
+        LOG(V4_VVER, "%s CS filter e=%i\n", _job->toStr(), session._epoch);
+        session.setFiltering();
+        // Clauses which this node imported from host-level sessions are dropped locally
+        // (not via the global filter, which would drop them for the other hosts as well)
+        if (_host_imported_clauses.size() > 0) {
+            session._host_import_filter = _host_imported_clauses.getFilter(
+                session._broadcast_clause_buffer, session._num_host_imported_clauses);
+        }
+        // Hand the clauses over to the job unless they are needed for the clause history
+        _job->filterSharing(_use_cls_history ? std::vector<int>(session._broadcast_clause_buffer)
+            : std::move(session._broadcast_clause_buffer));
     }
 
     // Supply calculated local filter to the 2nd all-reduction
-    if (!session._allreduce_filter.hasProducer() && _job->hasFilteredSharing()) {
-        LOG(V4_VVER, "%s CS produce filter\n", _job->toStr());
-        session._allreduce_filter.produce([&]() {return _job->getLocalFilter();});
+    if (session.isFiltering() && !session._allreduce_filter->hasProducer() && _job->hasFilteredSharing()) {
+        LOG(V4_VVER, "%s CS produce filter e=%i\n", _job->toStr(), session._epoch);
+        session._allreduce_filter->produce([&]() {
+            auto filter = _job->getLocalFilter();
+            if (session._topology.type == AllReductionTopology::BUTTERFLY) {
+                session._local_filter = filter;
+                filter.push_back(session._buffer_hash);
+            }
+            return filter;
+        });
     }
 
     // Advance all-reduction of filter
-    session._allreduce_filter.advance();
+    session._allreduce_filter->advance();
 
     // All-reduction of clause filter finished?
-    if (session._allreduce_filter.hasResult()) {
+    if (session._allreduce_filter->hasResult()) {
         
-        LOG(V4_VVER, "%s CS apply filter\n", _job->toStr());
-
         // Extract and digest result
-        auto filter = session._allreduce_filter.extractResult();
-        _job->applyFilter(filter);
+        auto filter = session._allreduce_filter->extractResult();
+        if (session._topology.type == AllReductionTopology::BUTTERFLY) {
+            // Only use a filter which refers to this node's clause buffer
+            if (!filter.empty() && filter.back() == session._buffer_hash) filter.pop_back();
+            else filter = std::move(session._local_filter);
+        }
+        std::vector<int> localFilter;
+        if (session._num_host_imported_clauses > 0) {
+            localFilter = filter;
+            auto& hostFilter = session._host_import_filter;
+            if (localFilter.size() < hostFilter.size()) localFilter.resize(hostFilter.size(), 0);
+            for (size_t i = 0; i < hostFilter.size(); i++) localFilter[i] |= hostFilter[i];
+            LOG(V4_VVER, "%s CS drop %i host-imported cls e=%i\n", _job->toStr(), 
+                session._num_host_imported_clauses, session._epoch);
+        }
+        _last_num_host_imported_clauses = session._num_host_imported_clauses;
+        _job->applyFilter(localFilter.empty() ? filter : localFilter);
         if (_use_cls_history) {
             auto filteredClauses = session.applyGlobalFilter(filter, session._broadcast_clause_buffer);
             addToClauseHistory(filteredClauses, session._epoch);
         }
 
         // Conclude this sharing epoch
-        _time_of_last_epoch_conclusion = Timer::elapsedSeconds();
+        session.setConcluded();
+        size_t sessionBytes = 0;
+        for (auto& s : _sessions) sessionBytes += s.getMemoryFootprint();
+        LOG(V4_VVER, "%s CS apply filter e=%i (%i in flight, %.1f kB in sessions)\n", _job->toStr(), 
+            session._epoch, getNumSessionsInFlight(), sessionBytes/1024.0);
     }
 }
 
@@ -198,13 +398,28 @@ void AnytimeSatClauseCommunicator::handle(int source, int mpiTag, JobMessage& ms
     // Process unsuccessful, returned messages
     if (msg.returnedToSender) {
         msg.returnedToSender = false;
-        if (msg.tag == MSG_INITIATE_CLAUSE_SHARING) {
+        Session* session = getSession(msg.epoch);
+        bool butterfly = session != nullptr && session->_topology.type == AllReductionTopology::BUTTERFLY;
+        if (butterfly && (msg.tag == MSG_ALLREDUCE_CLAUSES || msg.tag == MSG_ALLREDUCE_FILTER)) {
+            // Exchange partner left the all-reduction: Pretend that it sent the neutral element
+            if (mpiTag == MSG_JOB_TREE_BROADCAST) return;
+            auto& allreduction = msg.tag == MSG_ALLREDUCE_CLAUSES ? 
+                session->_allreduce_clauses : session->_allreduce_filter;
+            msg.payload = allreduction->getNeutralElement();
+        } else if (msg.tag == MSG_INITIATE_CLAUSE_SHARING && butterfly) {
+            // Each partner is contacted directly later on
+            return;
+        } else if (msg.tag == MSG_INITIATE_CLAUSE_SHARING) {
             // Initiation signal hit an inactive (?) child:
             // Pretend that it sent an empty set of clauses
             msg.tag = MSG_ALLREDUCE_CLAUSES;
             mpiTag = MSG_JOB_TREE_REDUCTION;
-            msg.payload.resize(1);
-            msg.payload[0] = 1; // num aggregated nodes
+            msg.payload = Session::getClauseContribution(_params, std::vector<int>());
+        } else if (msg.tag == MSG_INITIATE_HOST_CLAUSE_SHARING) {
+            // Same for host-level sharing
+            msg.tag = MSG_ALLREDUCE_HOST_CLAUSES;
+            mpiTag = MSG_JOB_TREE_REDUCTION;
+            msg.payload = Session::getClauseContribution(_params, std::vector<int>());
         } else if (msg.tag == MSG_ALLREDUCE_CLAUSES && mpiTag == MSG_JOB_TREE_BROADCAST) {
             // Distribution of clauses hit an inactive (?) child:
             // Pretend that it sent an empty filter
@@ -217,25 +432,61 @@ void AnytimeSatClauseCommunicator::handle(int source, int mpiTag, JobMessage& ms
     // Initial signal to initiate a sharing epoch
     if (msg.tag == MSG_INITIATE_CLAUSE_SHARING) {
         _current_epoch = msg.epoch;
-        LOG(V5_DEBG, "%s : INIT COMM e=%i nc=%i\n", _job->toStr(), _current_epoch, 
-            _job->getJobTree().getNumChildren());
-        _sessions.emplace_back(_params, _job, _cdb, _current_epoch);
-        if (!_job->hasPreparedSharing()) {
-            int limit = _job->getBufferLimit(1, MyMpi::SELF);
-            _job->prepareSharing(limit);
+        _initiation_pending = false;
+        auto topology = AllReductionTopology::deserialize(msg.payload, _job->getJobTree().getRank());
+        LOG(V5_DEBG, "%s : INIT COMM e=%i nc=%i (%s)\n", _job->toStr(), _current_epoch, 
+            _job->getJobTree().getNumChildren(), AllReductionTopology::getName(topology.type));
+        if (topology.type == AllReductionTopology::JOB_TREE) {
+            advanceCollective(_job, msg, MSG_INITIATE_CLAUSE_SHARING);
+        } else {
+            for (int rank : topology.getInitiationChildren())
+                MyMpi::isend(rank, MSG_SEND_APPLICATION_MESSAGE, msg);
+        }
+        if (topology.isParticipant()) {
+            _sessions.emplace_back(_params, _job, _cdb, _current_epoch, _next_session_seq++, 
+                /*hostLevel=*/false, std::move(topology));
+            if (!_job->hasPreparedSharing()) {
+                int limit = _job->getBufferLimit(1, MyMpi::SELF);
+                _job->prepareSharing(limit);
+            }
+        }
+        // Process messages of this epoch which arrived before its initiation
+        // and return the ones of previous epochs
+        auto earlyMessages = std::move(_early_messages);
+        _early_messages.clear();
+        for (auto& early : earlyMessages) {
+            if (early.msg.epoch < _current_epoch) returnToSender(early.source, early.mpiTag, early.msg);
+            else handle(early.source, early.mpiTag, early.msg);
         }
-        advanceCollective(_job, msg, MSG_INITIATE_CLAUSE_SHARING);
+    }
+
+    // Initial signal to initiate a host-level sharing epoch
+    if (msg.tag == MSG_INITIATE_HOST_CLAUSE_SHARING) {
+        beginHostSession(msg.epoch);
     }
 
     // Advance all-reductions
+    // (several epochs may be in progress: find the session of the message's epoch)
     bool success = false;
-    if (!_sessions.empty() && msg.tag == MSG_ALLREDUCE_CLAUSES && currentSession()._allreduce_clauses.isValid()) {
-        success = currentSession()._allreduce_clauses.receive(source, mpiTag, msg);
-        currentSession()._allreduce_clauses.advance();
+    Session* session = getSession(msg.epoch);
+    if (session == nullptr && msg.epoch > _current_epoch 
+            && (msg.tag == MSG_ALLREDUCE_CLAUSES || msg.tag == MSG_ALLREDUCE_FILTER)) {
+        // The epoch's initiation did not arrive yet (e.g., with butterfly exchanges)
+        _early_messages.push_back(EarlyMessage{source, mpiTag, msg, Timer::elapsedSeconds()});
+        return;
     }
-    if (!_sessions.empty() && msg.tag == MSG_ALLREDUCE_FILTER && currentSession()._allreduce_filter.isValid()) {
-        success = currentSession()._allreduce_filter.receive(source, mpiTag, msg);
-        currentSession()._allreduce_filter.advance();
+    if (session != nullptr && msg.tag == MSG_ALLREDUCE_CLAUSES && session->_allreduce_clauses->isValid()) {
+        success = session->_allreduce_clauses->receive(source, mpiTag, msg);
+        session->_allreduce_clauses->advance();
+    }
+    if (session != nullptr && msg.tag == MSG_ALLREDUCE_FILTER && session->_allreduce_filter->isValid()) {
+        success = session->_allreduce_filter->receive(source, mpiTag, msg);
+        session->_allreduce_filter->advance();
+    }
+    Session* hostSession = msg.tag == MSG_ALLREDUCE_HOST_CLAUSES ? getSession(msg.epoch, true) : nullptr;
+    if (hostSession != nullptr && hostSession->_allreduce_clauses->isValid()) {
+        success = hostSession->_allreduce_clauses->receive(source, mpiTag, msg);
+        hostSession->_allreduce_clauses->advance();
     }
     if (!success) {
         // Special case where clauses are broadcast but message was not processed:
@@ -244,10 +495,33 @@ void AnytimeSatClauseCommunicator::handle(int source, int mpiTag, JobMessage& ms
             msg.payload.clear();
             msg.tag = MSG_ALLREDUCE_FILTER;
             MyMpi::isend(source, MSG_JOB_TREE_REDUCTION, msg);
+        } else if ((msg.tag == MSG_ALLREDUCE_CLAUSES || msg.tag == MSG_ALLREDUCE_FILTER) 
+                && mpiTag == MSG_JOB_TREE_REDUCTION) {
+            // Element of an exchange partner (butterfly) which this node cannot process:
+            // Return it such that the partner may continue without it
+            returnToSender(source, mpiTag, msg);
         }
     }
 }
 
+void AnytimeSatClauseCommunicator::returnToSender(int source, int mpiTag, JobMessage& msg) {
+    if (msg.returnedToSender) return;
+    msg.returnedToSender = true;
+    MyMpi::isend(source, mpiTag, msg);
+}
+
+AllReductionTopology AnytimeSatClauseCommunicator::getTopologyForNextEpoch() const {
+    auto type = (AllReductionTopology::Type) _params.clauseSharingTopology();
+    if (type == AllReductionTopology::JOB_TREE || _job->getVolume() < _params.clauseSharingTopologyMinVolume()) 
+        return AllReductionTopology();
+    // The job's rank list must be complete and up to date
+    auto ranklist = _job->getJobComm().getRanklist();
+    bool upToDate = (int)ranklist.size() == _job->getVolume() && ranklist[0] == _job->getJobTree().getRank();
+    for (int rank : ranklist) upToDate &= rank >= 0;
+    if (!upToDate) return AllReductionTopology();
+    return AllReductionTopology(type, _params.clauseSharingFanIn(), ranklist, _job->getJobTree().getRank());
+}
+
 void AnytimeSatClauseCommunicator::feedHistoryIntoSolver() {
     if (_use_cls_history) _cls_history.feedHistoryIntoSolver();
 }
@@ -290,3 +564,54 @@ void AnytimeSatClauseCommunicator::addToClauseHistory(std::vector<int>& clauses,
     // Send next batches of historic clauses to subscribers as necessary
     _cls_history.sendNextBatches();
 }
+
+// Returns the acceptance of the clauses imported locally since the last contribution
+ImportAcceptance AnytimeSatClauseCommunicator::getNewImportAcceptance() {
+    auto acceptance = _job->getImportAcceptance();
+    auto newAcceptance = acceptance.getDifference(_reported_acceptance);
+    _reported_acceptance = acceptance;
+    return newAcceptance;
+}
+
+// Grows or shrinks the sharing volume of this job depending on which share of the
+// imported clauses the solvers had the budget to accept, and excludes the longest admitted
+// clauses from sharing as long as few of them are accepted. Each node of the job receives the same job-wide
+// acceptance, so all nodes arrive at the same adaptations.
+void AnytimeSatClauseCommunicator::adaptSharingVolume(const ImportAcceptance& acceptance) {
+
+    float target = _params.sharingAcceptanceTarget();
+    if (target <= 0) return;
+    // Too few imported clauses for a meaningful adaptation?
+    if (acceptance.getNumReceived() < 100) return;
+
+    // Multiplicative update of the volume towards the target acceptance
+    float share = acceptance.getAcceptedShare();
+    float maxAdjustment = _params.sharingVolumeMaxAdjustment();
+    _volume_factor *= std::max(0.8f, std::min(1.25f, share / target));
+    _volume_factor = std::max(1/maxAdjustment, std::min(maxAdjustment, _volume_factor));
+    _job->setSharingCompensationFactor(_compensation_factor * _volume_factor);
+
+    // Exclude / re-admit the longest admitted bucket of clauses
+    int topBucket = ImportAcceptance::getLengthBucket(_max_shared_clause_length);
+    float topShare = acceptance.getAcceptedShareOfLength(topBucket);
+    if (topShare >= 0 && topShare < 0.5f * target && topBucket > 1) {
+        _max_shared_clause_length = ImportAcceptance::getMaxLength(topBucket-1);
+    } else if (topShare >= target && _max_shared_clause_length < _params.strictClauseLengthLimit()) {
+        _max_shared_clause_length = topBucket+1 == ImportAcceptance::NUM_LENGTH_BUCKETS-1 ? _params.strictClauseLengthLimit() 
+            : std::min(_params.strictClauseLengthLimit(), ImportAcceptance::getMaxLength(topBucket+1));
+    }
+    // Same for the bucket of the highest admitted LBDs
+    int topLbdBucket = ImportAcceptance::getLbdBucket(_max_shared_clause_lbd);
+    float topLbdShare = acceptance.getAcceptedShareOfLbd(topLbdBucket);
+    if (topLbdShare >= 0 && topLbdShare < 0.5f * target && topLbdBucket > 0) {
+        _max_shared_clause_lbd = ImportAcceptance::getMaxLbd(topLbdBucket-1);
+    } else if (topLbdShare >= target && _max_shared_clause_lbd < _params.strictLbdLimit()) {
+        _max_shared_clause_lbd = topLbdBucket+1 == ImportAcceptance::NUM_LBD_BUCKETS-1 ? _params.strictLbdLimit() 
+            : std::min(_params.strictLbdLimit(), ImportAcceptance::getMaxLbd(topLbdBucket+1));
+    }
+
+    if (_job->getJobTree().isRoot()) {
+        LOG(V3_VERB, "%s CS acceptance %.3f (%s) ~> volume x%.3f, max. len. %i, max. LBD %i\n", _job->toStr(), 
+            share, acceptance.getReport().c_str(), _volume_factor, _max_shared_clause_length, _max_shared_clause_lbd);
+    }
+}
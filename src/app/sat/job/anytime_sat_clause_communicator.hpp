@@ -10,8 +10,12 @@
 #include "app/job.hpp"
 #include "base_sat_job.hpp"
 #include "clause_history.hpp"
+#include "host_imported_clauses.hpp"
+#include "session_order.hpp"
+#include "../data/import_acceptance.hpp"
 //#include "distributed_clause_filter.hpp"
-#include "comm/job_tree_all_reduction.hpp"
+#include "comm/all_reduction_topology.hpp"
+#include "comm/host_comm.hpp"
 
 class AnytimeSatClauseCommunicator {
 
@@ -38,6 +42,16 @@ private:
     //DistributedClauseFilter _filter;
     float _compensation_factor = 1.0f;
     float _compensation_decay = 0.6;
+    // Adaptation of the sharing volume and of the admitted clause lengths and LBDs
+    // to the acceptance of the imported clauses (with -sact). The compensation factor
+    // raises the volume for clauses lost to filtering, the volume factor lowers it for
+    // clauses the solvers cannot take in; both act on disjoint sets of clauses and are
+    // combined into a single factor for the buffer limits.
+    float _volume_factor = 1.0f;
+    int _max_shared_clause_length;
+    int _max_shared_clause_lbd;
+    // Local import acceptance as of the last contribution to a sharing
+    ImportAcceptance _reported_acceptance;
 
     struct Session {
 
@@ -45,30 +59,53 @@ private:
         BaseSatJob* _job;
         AdaptiveClauseDatabase& _cdb;
         int _epoch;
+        // Sessions of hierarchical sharing which only span the co-located
+        // nodes of the job and only perform the reduction of clauses
+        bool _host_level;
+        // Order of creation among all sessions
+        int _seq;
 
         std::vector<int> _excess_clauses_from_merge;
         std::vector<int> _broadcast_clause_buffer;
         int _num_broadcast_clauses;
         int _num_admitted_clauses;
 
-        JobTreeAllReduction _allreduce_clauses;
-        JobTreeAllReduction _allreduce_filter;
+        AllReductionTopology _topology;
+        // (butterfly only) hash of the broadcast clause buffer, attached to the local filter
+        int _buffer_hash = 0;
+        std::vector<int> _local_filter;
+        // (hierarchical sharing) clauses of the broadcast buffer imported at host level before
+        std::vector<int> _host_import_filter;
+        int _num_host_imported_clauses = 0;
+
+        std::unique_ptr<AllReduction> _allreduce_clauses;
+        std::unique_ptr<AllReduction> _allreduce_filter;
         bool _filtering = false;
+        bool _concluded = false;
+
+        Session(const Parameters& params, BaseSatJob* job, AdaptiveClauseDatabase& cdb, int epoch, 
+                int seq, bool hostLevel = false, AllReductionTopology topology = AllReductionTopology()) : 
+            _params(params), _job(job), _cdb(cdb), _epoch(epoch), _host_level(hostLevel), _seq(seq),
+            _topology(std::move(topology)) {
 
-        Session(const Parameters& params, BaseSatJob* job, AdaptiveClauseDatabase& cdb, int epoch) : 
-            _params(params), _job(job), _cdb(cdb), _epoch(epoch),
-            _allreduce_clauses(
+            _allreduce_clauses = _topology.createAllReduction(
                 job->getJobTree(),
                 // Base message 
-                JobMessage(_job->getId(), _job->getRevision(), epoch, MSG_ALLREDUCE_CLAUSES),
-                // Neutral element
-                std::vector<int>(1, 1), // only integer: number of aggregated job tree nodes
+                JobMessage(_job->getId(), _job->getRevision(), epoch, 
+                    hostLevel ? MSG_ALLREDUCE_HOST_CLAUSES : MSG_ALLREDUCE_CLAUSES),
+                // Neutral element: no clauses, no imports, one aggregated job tree node
+                getClauseContribution(params, std::vector<int>()),
                 // Aggregator for local + incoming elements
                 [&](std::list<std::vector<int>>& elems) {
                     int numAggregated = 0;
+                    ImportAcceptance acceptance;
                     for (auto& elem : elems) {
                         numAggregated += elem.back();
                         elem.pop_back();
+                        if (!reportsAcceptance(_params)) continue;
+                        ImportAcceptance elemAcceptance;
+                        elemAcceptance.deserializeFrom(elem);
+                        acceptance.aggregate(elemAcceptance);
                     }
                     auto merger = _cdb.getBufferMerger(_job->getBufferLimit(numAggregated, MyMpi::ALL));
                     for (auto& elem : elems) {
@@ -77,11 +114,14 @@ private:
                     std::vector<int> merged = merger.merge(&_excess_clauses_from_merge);
                     LOG(V4_VVER, "%s : merged %i contribs ~> len=%i\n", 
                         _job->toStr(), numAggregated, merged.size());
+                    if (reportsAcceptance(_params)) acceptance.serializeTo(merged);
                     merged.push_back(numAggregated);
                     return merged;
-                }
-            ),
-            _allreduce_filter(
+                },
+                // Host-level sessions: only include co-located nodes
+                getMembership(job, hostLevel)
+            );
+            _allreduce_filter = _topology.createAllReduction(
                 job->getJobTree(), 
                 // Base message
                 JobMessage(_job->getId(), _job->getRevision(), epoch, MSG_ALLREDUCE_FILTER),
@@ -89,6 +129,7 @@ private:
                 std::vector<int>(),
                 // Aggregator for local + incoming elements
                 [&](std::list<std::vector<int>>& elems) {
+                    if (_topology.type == AllReductionTopology::BUTTERFLY) return aggregateHashedFilters(elems);
                     std::vector<int> filter = std::move(elems.front());
                     elems.pop_front();
                     for (auto& elem : elems) {
@@ -99,31 +140,125 @@ private:
                         }
                     }
                     return filter;
-                }
-            ) { }
+                },
+                getMembership(job, hostLevel)
+            );
+        }
         ~Session() {
-            _allreduce_clauses.destroy();
-            _allreduce_filter.destroy();
+            _allreduce_clauses->destroy();
+            _allreduce_filter->destroy();
+        }
+
+        // An element of the all-reduction of clauses: the clauses, followed by the
+        // acceptance of the clauses imported at the aggregated nodes (only with -sact)
+        // and by the number of these nodes
+        static std::vector<int> getClauseContribution(const Parameters& params, std::vector<int>&& clauses, 
+                const ImportAcceptance& acceptance = ImportAcceptance(), int numAggregated = 1) {
+            if (reportsAcceptance(params)) acceptance.serializeTo(clauses);
+            clauses.push_back(numAggregated);
+            return clauses;
+        }
+        static bool reportsAcceptance(const Parameters& params) {
+            return params.sharingAcceptanceTarget() > 0;
         }
 
         void setFiltering() {_filtering = true;}
         bool isFiltering() const {return _filtering;}
+        void setConcluded() {_concluded = true;}
+        bool isConcluded() const {return _concluded;}
         std::vector<int> applyGlobalFilter(const std::vector<int>& filter, std::vector<int>& clauses);
 
         bool isValid() const {
-            return _allreduce_clauses.isValid() || _allreduce_filter.isValid();
+            return _allreduce_clauses->isValid() || (!_host_level && _allreduce_filter->isValid());
+        }
+
+        // With butterfly exchanges, nodes may end up with different clause buffers if a node
+        // leaves during the all-reduction. Therefore each filter carries the hash of the buffer
+        // it refers to, and only filters referring to this node's buffer are combined.
+        void setBufferHash() {
+            size_t hash = _broadcast_clause_buffer.size();
+            for (int lit : _broadcast_clause_buffer) hash_combine(hash, lit);
+            _buffer_hash = (int) hash;
+        }
+        std::vector<int> aggregateHashedFilters(std::list<std::vector<int>>& elems) {
+            std::vector<int> filter;
+            for (auto& elem : elems) {
+                if (elem.empty() || elem.back() != _buffer_hash) continue;
+                if (filter.size() < elem.size()-1) filter.resize(elem.size()-1);
+                for (size_t i = 0; i+1 < elem.size(); i++) filter[i] |= elem[i]; // bitwise OR
+            }
+            filter.push_back(_buffer_hash);
+            return filter;
+        }
+
+        static std::function<bool(int)> getMembership(BaseSatJob* job, bool hostLevel) {
+            if (!hostLevel) return std::function<bool(int)>();
+            int myRank = job->getJobTree().getRank();
+            return [myRank](int rank) {return HostComm::isOnSameHost(myRank, rank);};
+        }
+
+        // Whether this session's local operations on the job (filtering the broadcast clauses
+        // and digesting them with the global filter) are done or will never happen.
+        bool isLocallyDigested() const {
+            return _concluded || !_allreduce_filter->isValid();
+        }
+
+        // Number of bytes held by the clause buffers and filters of this session.
+        size_t getMemoryFootprint() const {
+            size_t bytes = _broadcast_clause_buffer.capacity() * sizeof(int);
+            bytes += _allreduce_filter->getMemoryFootprint();
+            bytes += _allreduce_clauses->getMemoryFootprint();
+            // (excess clauses are written during the aggregation of clauses)
+            if (!_allreduce_clauses->isAggregating())
+                bytes += _excess_clauses_from_merge.capacity() * sizeof(int);
+            return bytes;
         }
 
         bool isDestructible() {
-            return _allreduce_clauses.isDestructible() && _allreduce_filter.isDestructible();
+            return _allreduce_clauses->isDestructible() && _allreduce_filter->isDestructible();
         }
     };
 
+    // Sessions ordered by epoch. With pipelined sharing (maxSharingEpochsInFlight > 1),
+    // several of them may be in progress: a new epoch's reduction of clauses can begin
+    // while earlier epochs still filter and broadcast their clauses.
     std::list<Session> _sessions;
 
     int _current_epoch = 0;
     float _time_of_last_epoch_initiation = 0;
-    float _time_of_last_epoch_conclusion = 0.000001f;
+    // (root only) a new epoch was initiated but its session was not created yet
+    bool _initiation_pending = false;
+
+    // Hierarchical sharing: Co-located nodes of the job frequently share clauses among
+    // each other in host-level sessions. Only the topmost of these nodes (the host leader)
+    // contributes clauses to the job-wide sessions, namely the best clauses of the
+    // host-level sessions since the last job-wide session.
+    const bool _hierarchical;
+    std::list<Session> _host_sessions;
+    int _current_host_epoch = 0;
+    float _time_of_last_host_epoch_initiation = 0;
+    // (host leader only) merged results of host-level sessions since the last job-wide contribution
+    std::vector<int> _host_clauses_for_global;
+    ImportAcceptance _host_acceptance_for_global;
+    // Clauses imported from host-level sessions, which are not imported again from job-wide sessions
+    HostImportedClauses _host_imported_clauses;
+    int _last_num_host_imported_clauses = 0;
+    // Bytes of the job-wide sharing results and accepted imports reported for them
+    // (measurement of the inter-host traffic per accepted import, with -sact)
+    unsigned long _inter_host_bytes = 0;
+    unsigned long _num_accepted_imports = 0;
+
+    int _next_session_seq = 0;
+
+    // Messages of sharing epochs which this node did not join yet: with topologies other than
+    // the job tree, an exchange partner may send its element before the initiation arrives here
+    struct EarlyMessage {
+        int source;
+        int mpiTag;
+        JobMessage msg;
+        float time;
+    };
+    std::list<EarlyMessage> _early_messages;
 
 public:
     AnytimeSatClauseCommunicator(const Parameters& params, BaseSatJob* job) : _params(params), _job(job), 
@@ -138,14 +273,19 @@ public:
             setup.numLiterals = 0;
             return setup;
         }()),
-        _cls_history(_params, _job->getBufferLimit(_job->getJobTree().getCommSize(), MyMpi::ALL), *job, _cdb) {
+        _cls_history(_params, _job->getBufferLimit(_job->getJobTree().getCommSize(), MyMpi::ALL), *job, _cdb),
+        _max_shared_clause_length(_params.strictClauseLengthLimit()),
+        _max_shared_clause_lbd(_params.strictLbdLimit()),
+        _hierarchical(params.appHostCommPeriod() > 0),
+        _host_imported_clauses(_cdb, _params.strictClauseLengthLimit(), _params.groupClausesByLengthLbdSum()) {
 
         _time_of_last_epoch_initiation = Timer::elapsedSeconds();
-        _time_of_last_epoch_conclusion = Timer::elapsedSeconds();
+        _time_of_last_host_epoch_initiation = _time_of_last_epoch_initiation;
     }
 
     ~AnytimeSatClauseCommunicator() {
         _sessions.clear();
+        _host_sessions.clear();
     }
 
     void communicate();
@@ -153,10 +293,45 @@ public:
     void feedHistoryIntoSolver();
     bool isDestructible() {
         for (auto& session : _sessions) if (!session.isDestructible()) return false;
+        for (auto& session : _host_sessions) if (!session.isDestructible()) return false;
         return true;
     }
 
 private:
-    inline Session& currentSession() {return _sessions.back();}
+    Session* getSession(int epoch, bool hostLevel = false) {
+        auto& sessions = hostLevel ? _host_sessions : _sessions;
+        for (auto it = sessions.rbegin(); it != sessions.rend(); ++it) 
+            if (it->_epoch == epoch) return &*it;
+        return nullptr;
+    }
+    int getNumSessionsInFlight() const {
+        int num = 0;
+        for (auto& session : _sessions) if (session.isValid()) num++;
+        return num;
+    }
+    void advanceSession(Session& session, bool oldestWithoutClauses, bool mayFilter);
+    void beginHostSession(int epoch);
+    void returnToSender(int source, int mpiTag, JobMessage& msg);
+    AllReductionTopology getTopologyForNextEpoch() const;
+    void advanceHostSession(Session& session, bool oldestWithoutClauses);
+    bool needsPreparedClauses(const Session& session) const {
+        return session.isValid() && !session._allreduce_clauses->hasProducer() 
+            && (session._host_level || !isHostMember());
+    }
+
+    // Hierarchical sharing: whether this node is below a co-located parent node
+    bool isHostMember() const {
+        auto& tree = _job->getJobTree();
+        return _hierarchical && !tree.isRoot() && HostComm::isOnSameHost(tree.getRank(), tree.getParentNodeRank());
+    }
+    // Hierarchical sharing: whether this node is the topmost of a group of co-located nodes
+    bool isHostLeaderOfGroup() const {
+        auto& tree = _job->getJobTree();
+        if (!_hierarchical || isHostMember()) return false;
+        return (tree.hasLeftChild() && HostComm::isOnSameHost(tree.getRank(), tree.getLeftChildNodeRank()))
+            || (tree.hasRightChild() && HostComm::isOnSameHost(tree.getRank(), tree.getRightChildNodeRank()));
+    }
     void addToClauseHistory(std::vector<int>& clauses, int epoch);
+    ImportAcceptance getNewImportAcceptance();
+    void adaptSharingVolume(const ImportAcceptance& acceptance);
 };
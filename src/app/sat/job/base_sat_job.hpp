@@ -3,6 +3,7 @@
 
 #include "app/job.hpp"
 #include "data/checksum.hpp"
+#include "../data/import_acceptance.hpp"
 
 class BaseSatJob : public Job {
 
@@ -19,8 +20,10 @@ public:
     virtual bool hasPreparedSharing() = 0;
     virtual std::vector<int> getPreparedClauses(Checksum& checksum) = 0;
     virtual std::pair<int, int> getLastAdmittedClauseShare() = 0;
+    // (cumulative) acceptance of the clauses imported locally, as of the last preparation of clauses
+    virtual ImportAcceptance getImportAcceptance() = 0;
 
-    virtual void filterSharing(std::vector<int>& clauses) = 0;
+    virtual void filterSharing(std::vector<int>&& clauses) = 0;
     virtual bool hasFilteredSharing() = 0;
     virtual std::vector<int> getLocalFilter() = 0;
     virtual void applyFilter(std::vector<int>& filter) = 0;
@@ -44,6 +47,7 @@ public:
     virtual void appl_dumpStats() = 0;
     virtual bool appl_isDestructible() = 0;
     virtual void appl_memoryPanic() = 0;
+    virtual void appl_setNumActiveThreads(int nbThreads) = 0;
 
 private:
     float _compensation_factor = 1.0f;
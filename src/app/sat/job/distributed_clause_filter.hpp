@@ -10,7 +10,21 @@
 class DistributedClauseFilter {
 
 private:
-    robin_hood::unordered_flat_map<Mallob::Clause, int, NonCommutativeClauseHasher, SortedClauseExactEquals> _filter;
+    // Clauses are keyed together with their (commutative) hash, which is computed
+    // only once and used both for the map and for determining the responsible node
+    struct HashedClause {
+        Mallob::Clause clause;
+        size_t hash;
+    };
+    struct HashedClauseHasher {
+        size_t operator()(const HashedClause& c) const {return c.hash;}
+    };
+    struct HashedClauseEquals {
+        bool operator()(const HashedClause& a, const HashedClause& b) const {
+            return a.hash == b.hash && SortedClauseExactEquals()(a.clause, b.clause);
+        }
+    };
+    robin_hood::unordered_flat_map<HashedClause, int, HashedClauseHasher, HashedClauseEquals> _filter;
 
     int _last_index = -1;
     int _last_volume = -1;
@@ -69,16 +83,19 @@ public:
     }
 
     bool passClause(Mallob::Clause& clause, int epoch) {
+        return passClause(clause, ClauseHasher::hash(clause, /*which=*/3), epoch);
+    }
 
-        size_t hash = ClauseHasher::hash(clause, /*which=*/3);
+    // Variant with a precomputed hash (Mallob::commutativeHash(.., 3)) of the clause.
+    bool passClause(Mallob::Clause& clause, size_t hash, int epoch) {
 
-        auto it = _filter.find(clause);
+        auto it = _filter.find(HashedClause{clause, hash});
         bool contained = it != _filter.end();
 
         if (contained && epoch - it->second > _num_remembered_epochs) {
             // Obsolete epoch! Remove entry and pretend it was never there
             contained = false;
-            free(it->first.begin);
+            free(it->first.clause.begin);
             _filter.erase(it);
         }
 
@@ -90,14 +107,14 @@ public:
             Clause copy = clause;
             copy.begin = (int*) malloc(sizeof(int)*clause.size);
             memcpy(copy.begin, clause.begin, sizeof(int)*clause.size);
-            _filter[copy] = epoch; // register
+            _filter[HashedClause{copy, hash}] = epoch; // register
         }
 
         return true; // no duplicate was found: success
     }
 
     ~DistributedClauseFilter() {
-        for (auto& [c, val] : _filter) free(c.begin);
+        for (auto& [c, val] : _filter) free(c.clause.begin);
     }
 
     bool isResponsibleFor(size_t hash) {
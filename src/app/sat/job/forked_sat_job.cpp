@@ -158,6 +158,14 @@ bool ForkedSatJob::appl_isDestructible() {
 
 void ForkedSatJob::appl_memoryPanic() {
     if (!_initialized) return;
+    int nbRunningThreads = _solver->getStartedNumThreads();
+    if (nbRunningThreads > 1) {
+        // Remove a solver thread from the running process
+        setNumThreads(std::min(getNumThreads(), nbRunningThreads-1));
+        LOG(V1_WARN, "[WARN] %s : memory panic triggered - reducing solver to %i threads\n", toStr(), getNumThreads());
+        _solver->setNumThreads(getNumThreads());
+        return;
+    }
     int nbThreads = getNumThreads();
     if (nbThreads > 0 && _solver->getStartedNumThreads() == nbThreads) 
         setNumThreads(nbThreads-1);
@@ -165,6 +173,11 @@ void ForkedSatJob::appl_memoryPanic() {
     _solver->crash();
 }
 
+void ForkedSatJob::appl_setNumActiveThreads(int nbThreads) {
+    if (!_initialized || getState() != ACTIVE) return;
+    _solver->setNumThreads(nbThreads);
+}
+
 bool ForkedSatJob::checkClauseComm() {
     if (!_initialized) return false;
     if (_clause_comm == nullptr && _solver->hasClauseComm()) 
@@ -209,10 +222,14 @@ std::pair<int, int> ForkedSatJob::getLastAdmittedClauseShare() {
     if (!_initialized) return std::pair<int, int>();
     return _solver->getLastAdmittedClauseShare();
 }
+ImportAcceptance ForkedSatJob::getImportAcceptance() {
+    if (!_initialized) return ImportAcceptance();
+    return _solver->getImportAcceptance();
+}
 
-void ForkedSatJob::filterSharing(std::vector<int>& clauses) {
+void ForkedSatJob::filterSharing(std::vector<int>&& clauses) {
     if (!_initialized) return;
-    _solver->filterClauses(clauses);
+    _solver->filterClauses(std::move(clauses));
 }
 bool ForkedSatJob::hasFilteredSharing() {
     if (!_initialized) return false;
@@ -263,6 +280,8 @@ ForkedSatJob::~ForkedSatJob() {
     for (auto& future : _old_solver_destructions) {
         if (future.valid()) future.get();
     }
+    // Clean up clauses retained by a subprocess for its successor, if any
+    std::remove(SatProcessConfig(_params, *this, 0).getRetainedClausesFile(Proc::getPid()).c_str());
 
     LOG(V5_DEBG, "%s : destructed FSJ\n", toStr());
 }
\ No newline at end of file
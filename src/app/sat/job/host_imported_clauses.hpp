@@ -0,0 +1,87 @@
+
+#pragma once
+
+#include <list>
+#include <vector>
+#include <unordered_map>
+
+#include "../data/clause.hpp"
+#include "../sharing/buffer/adaptive_clause_database.hpp"
+#include "../sharing/buffer/buffer_reducer.hpp"
+
+// Remembers the clauses which a node imported from the host-level clause sharing.
+// These clauses reach the job-wide sharing via the host leader and then return to
+// the node; they are dropped locally instead of being imported a second time.
+// Clauses are identified by their (commutative) hash and forgotten after some time.
+class HostImportedClauses {
+
+private:
+    AdaptiveClauseDatabase& _cdb;
+    const int _max_clause_length;
+    const bool _slots_for_sum_of_length_and_lbd;
+
+    struct Batch {
+        float time;
+        std::vector<size_t> hashes;
+    };
+    std::list<Batch> _batches;
+    std::unordered_map<size_t, int> _counts;
+
+public:
+    HostImportedClauses(AdaptiveClauseDatabase& cdb, int maxClauseLength, bool slotsForSumOfLengthAndLbd) :
+        _cdb(cdb), _max_clause_length(maxClauseLength), _slots_for_sum_of_length_and_lbd(slotsForSumOfLengthAndLbd) {}
+
+    // Removes the clauses known already from the buffer (in place) and remembers the others.
+    // Returns the number of removed clauses.
+    int removeKnownAndAdd(std::vector<int>& clauses, float time) {
+        Batch batch {time, {}};
+        int numRemoved = 0;
+        BufferReducer reducer(clauses.data(), clauses.size(), _max_clause_length, _slots_for_sum_of_length_and_lbd);
+        clauses.resize(reducer.reduce([&](const Mallob::Clause& c) {
+            size_t hash = Mallob::commutativeHash(c.begin, c.size);
+            if (_counts.count(hash)) {
+                numRemoved++;
+                return false;
+            }
+            batch.hashes.push_back(hash);
+            return true;
+        }));
+        for (size_t hash : batch.hashes) _counts[hash]++;
+        _batches.push_back(std::move(batch));
+        return numRemoved;
+    }
+
+    // Returns a filter for the given buffer, with one bit per clause as in the filters
+    // of the job-wide sharing, where each known clause has its bit set.
+    std::vector<int> getFilter(std::vector<int>& clauses, int& numKnownOut) {
+        constexpr int bitsPerElem = 8*sizeof(int);
+        std::vector<int> filter;
+        numKnownOut = 0;
+        auto reader = _cdb.getBufferReader(clauses.data(), clauses.size());
+        size_t clsIdx = 0;
+        auto clause = reader.getNextIncomingClause();
+        while (clause.begin != nullptr) {
+            if (clsIdx % bitsPerElem == 0) filter.push_back(0);
+            if (!_counts.empty() && _counts.count(Mallob::commutativeHash(clause.begin, clause.size))) {
+                filter.back() |= 1 << (clsIdx % bitsPerElem);
+                numKnownOut++;
+            }
+            clsIdx++;
+            clause = reader.getNextIncomingClause();
+        }
+        return filter;
+    }
+
+    // Forgets all clauses remembered before the given time.
+    void forgetOlderThan(float time) {
+        while (!_batches.empty() && _batches.front().time < time) {
+            for (size_t hash : _batches.front().hashes) {
+                auto it = _counts.find(hash);
+                if (--it->second == 0) _counts.erase(it);
+            }
+            _batches.pop_front();
+        }
+    }
+
+    size_t size() const {return _counts.size();}
+};
@@ -18,6 +18,7 @@
 #include "anytime_sat_clause_communicator.hpp"
 #include "util/sys/thread_pool.hpp"
 #include "util/sys/fileutils.hpp"
+#include "sat_process_pool.hpp"
 
 #ifndef MALLOB_SUBPROC_DISPATCH_PATH
 #define MALLOB_SUBPROC_DISPATCH_PATH ""
@@ -29,6 +30,7 @@ SatProcessAdapter::SatProcessAdapter(Parameters&& params, SatProcessConfig&& con
         _f_size(fSize), _f_lits(fLits), _a_size(aSize), _a_lits(aLits) {
 
     _desired_revision = _config.firstrev;
+    _num_threads = _desired_num_threads = _requested_num_threads = _config.threads;
     _shmem_id = _config.getSharedMemId(Proc::getPid());
 }
 
@@ -84,32 +86,8 @@ void SatProcessAdapter::doInitialize() {
     void* mainShmem = SharedMemory::create(_shmem_id, sizeof(SatSharedMemory));
     _shmem.insert(ShmemObject{_shmem_id, mainShmem, sizeof(SatSharedMemory)});
     _hsm = new ((char*)mainShmem) SatSharedMemory();
-    _hsm->doBegin = false;
-    _hsm->doExport = false;
-    _hsm->doFilterImport = false;
-    _hsm->doDigestImportWithFilter = false;
-    _hsm->doDigestImportWithoutFilter = false;
-    _hsm->doReturnClauses = false;
-    _hsm->doDumpStats = false;
-    _hsm->doStartNextRevision = false;
-    _hsm->doTerminate = false;
-    _hsm->exportBufferMaxSize = 0;
-    _hsm->importBufferSize = 0;
-    _hsm->didExport = false;
-    _hsm->didFilterImport = false;
-    _hsm->didDigestImport = false;
-    _hsm->didReturnClauses = false;
-    _hsm->didDumpStats = false;
-    _hsm->didStartNextRevision = false;
-    _hsm->didTerminate = false;
-    _hsm->isInitialized = false;
-    _hsm->hasSolution = false;
-    _hsm->result = UNKNOWN;
-    _hsm->solutionRevision = -1;
-    _hsm->exportBufferTrueSize = 0;
     _hsm->fSize = _f_size;
     _hsm->aSize = _a_size;
-    _hsm->desiredRevision = _config.firstrev;
     _hsm->config = _config;
 
     // Allocate import and export buffers
@@ -120,12 +98,11 @@ void SatProcessAdapter::doInitialize() {
     ) + 1024;
     _export_buffer = (int*) createSharedMemoryBlock("clauseexport", 
             sizeof(int)*_hsm->exportBufferAllocatedSize, nullptr);
-    _import_buffer = (int*) createSharedMemoryBlock("clauseimport", 
-            sizeof(int)*_hsm->importBufferMaxSize, nullptr);
-    _filter_buffer = (int*) createSharedMemoryBlock("clausefilter", 
-            _hsm->importBufferMaxSize/8 + 1, nullptr);
-    _returned_buffer = (int*) createSharedMemoryBlock("returnedclauses",
-            sizeof(int)*_hsm->importBufferMaxSize, nullptr);
+    // The task ring can hold several maximum-size imports (each with space for its filter)
+    _hsm->taskRingSize = 4 * (_hsm->importBufferMaxSize + _hsm->importBufferMaxSize/32 + 1);
+    _task_ring = (int*) createSharedMemoryBlock("taskring", 
+            sizeof(int)*_hsm->taskRingSize, nullptr);
+    _task_ring_allocator = RingAllocator(_hsm->taskRingSize);
 
     // Allocate shared memory for formula, assumptions of initial revision
     createSharedMemoryBlock("formulae.0", sizeof(int) * _f_size, (void*)_f_lits);
@@ -133,41 +110,37 @@ void SatProcessAdapter::doInitialize() {
 
     if (_terminate) return;
 
-    // FORK: Create a child process
-    pid_t res = Process::createChild();
-    if (res == 0) {
-        // [child process]
-        execl(MALLOB_SUBPROC_DISPATCH_PATH"mallob_process_dispatcher", 
-              MALLOB_SUBPROC_DISPATCH_PATH"mallob_process_dispatcher", 
-              (char*) 0);
-        
-        // If this is reached, something went wrong with execvp
-        LOG(V0_CRIT, "[ERROR] execl returned errno %i\n", (int)errno);
-        abort();
-    }
-
-    // Assemble SAT subprocess command
-    std::string executable = MALLOB_SUBPROC_DISPATCH_PATH"mallob_sat_process";
-    //char* const* argv = _params.asCArgs(executable.c_str());
-    std::string command = _params.getSubprocCommandAsString(executable.c_str());
-    
-    // Write command to tmp file
-    std::string commandOutfile = "/tmp/mallob_subproc_cmd_" + std::to_string(res) + "~";
-    std::ofstream ofs(commandOutfile);
-    ofs << command << " " << std::endl;
-    ofs.close();
-    std::rename(commandOutfile.c_str(), commandOutfile.substr(0, commandOutfile.size()-1).c_str()); // remove tilde
-
-    //int i = 0;
-    //delete[] ((const char**) argv);
+    // Adopt a pre-started SAT process if possible
+    _hsm->launchTime = Timer::elapsedSeconds();
+    pid_t res = SatProcessPool::adopt(_params);
+    bool adopted = res != -1;
+    if (!adopted) res = launchChild();
 
     {
         auto lock = _state_mutex.getLock();
         _initialized = true;
         _hsm->doBegin = true;
+        _hsm->childDoorbell.ring();
         _child_pid = res;
         applySolvingState();
     }
+
+    // Replace the adopted process in the pool
+    if (adopted) SatProcessPool::replenish();
+}
+
+pid_t SatProcessAdapter::launchChild() {
+
+    // Launch the SAT process directly via posix_spawn: unlike forking this
+    // (possibly very large) worker process, this does not copy its page tables.
+    char* const* argv = _params.asCArgs(MALLOB_SUBPROC_DISPATCH_PATH"mallob_sat_process");
+    pid_t res = Process::spawnChild(argv);
+    delete[] ((const char**) argv);
+    // On failure (e.g., EAGAIN or ENOMEM), this worker lives on: the job notices
+    // the missing child in check() and launches a new one.
+    if (res == -1) LOG(V1_WARN, "[WARN] %s : could not launch SAT process\n", _job->toStr());
+
+    return res;
 }
 
 bool SatProcessAdapter::hasClauseComm() {
@@ -196,11 +169,13 @@ void SatProcessAdapter::setSolvingState(SolvingStates::SolvingState state) {
 
 }
 void SatProcessAdapter::applySolvingState() {
-    assert(_initialized && _child_pid != -1);
+    assert(_initialized);
+    if (_child_pid == -1) return; // launch failed
     if (_state == SolvingStates::ABORTING && _hsm != nullptr) {
         //Fork::terminate(_child_pid); // Terminate child process by signal.
         _hsm->doTerminate = true; // Kindly ask child process to terminate.
         _hsm->doBegin = true; // Let child process know termination even if it waits for first revision
+        _hsm->childDoorbell.ring();
         Process::resume(_child_pid); // Continue (resume) process.
     }
     if (_state == SolvingStates::SUSPENDED || _state == SolvingStates::STANDBY) {
@@ -211,111 +186,211 @@ void SatProcessAdapter::applySolvingState() {
     }
 }
 
+void SatProcessAdapter::issueTask(SatSharedMemory::Message::Type type, int size, int revision) {
+    auto& task = _tasks[type];
+    assert(!task.issued);
+    task.issued = true;
+    task.completed = false;
+    task.issueTime = Timer::elapsedSeconds();
+    SatSharedMemory::Message msg {type};
+    msg.id = _next_task_id++;
+    msg.size = size;
+    msg.revision = revision;
+    bool success = _hsm->tasks.push(msg);
+    assert(success);
+    _hsm->childDoorbell.ring();
+}
+
+void SatProcessAdapter::addRingTask(SatSharedMemory::Message&& msg, std::vector<int>&& record) {
+    _ring_tasks.emplace_back();
+    _ring_tasks.back().msg = std::move(msg);
+    _ring_tasks.back().record = std::move(record);
+    issueRingTasks();
+}
+
+void SatProcessAdapter::issueRingTasks() {
+    // Bound the number of tasks in flight such that the task and response queues cannot overflow
+    const int maxNumIssuedRingTasks = 64;
+    bool issuedAny = false;
+    for (auto& task : _ring_tasks) {
+        if (task.issued) continue;
+        if (_num_issued_ring_tasks >= maxNumIssuedRingTasks) break;
+        // An import to filter needs additional space for the filter (one bit per clause)
+        size_t size = task.record.size();
+        if (task.msg.type == SatSharedMemory::Message::FILTER_IMPORT) size += size/32 + 1;
+        long offset = _task_ring_allocator.allocate(size);
+        if (offset < 0) break; // issue this and subsequent tasks later, in order
+        memcpy(_task_ring + offset, task.record.data(), task.record.size()*sizeof(int));
+        task.msg.id = _next_task_id++;
+        task.msg.offset = offset;
+        task.msg.length = task.record.size();
+        task.record = std::vector<int>();
+        task.issued = true;
+        task.issueTime = Timer::elapsedSeconds();
+        bool success = _hsm->tasks.push(task.msg);
+        assert(success);
+        _num_issued_ring_tasks++;
+        issuedAny = true;
+    }
+    if (issuedAny) _hsm->childDoorbell.ring();
+}
+
+void SatProcessAdapter::pollResponses() {
+    if (!_initialized) return;
+    SatSharedMemory::Message response;
+    while (_hsm->responses.pop(response)) {
+        auto type = response.type;
+        if (type == SatSharedMemory::Message::EXPORT || type == SatSharedMemory::Message::DUMP_STATS
+                || type == SatSharedMemory::Message::START_NEXT_REVISION
+                || type == SatSharedMemory::Message::SET_NUM_THREADS) {
+            auto& task = _tasks[type];
+            assert(task.issued && !task.completed);
+            task.completed = true;
+            task.response = response;
+            recordRoundTrip(type, task.issueTime);
+            continue;
+        }
+        auto it = _ring_tasks.begin();
+        while (it != _ring_tasks.end() && it->msg.id != response.id) ++it;
+        assert(it != _ring_tasks.end() && it->issued && !it->completed);
+        recordRoundTrip(type, it->issueTime);
+        _num_issued_ring_tasks--;
+        if (type == SatSharedMemory::Message::FILTER_IMPORT) {
+            // Keep the clauses and the local filter until the filter is fetched
+            it->completed = true;
+            it->response = response;
+            continue;
+        }
+        _task_ring_allocator.release(it->msg.offset);
+        if (type == SatSharedMemory::Message::DIGEST_IMPORT_WITH_FILTER)
+            _task_ring_allocator.release(it->msg.clausesOffset);
+        _ring_tasks.erase(it);
+    }
+}
+
+void SatProcessAdapter::recordRoundTrip(SatSharedMemory::Message::Type type, float issueTime) {
+    auto& task = _tasks[type];
+    float latency = Timer::elapsedSeconds() - issueTime;
+    task.numRoundTrips++;
+    task.sumLatency += latency;
+    task.maxLatency = std::max(task.maxLatency, latency);
+}
+
 void SatProcessAdapter::collectClauses(int maxSize) {
     if (!_initialized) return;
-    if (_hsm->doExport || _hsm->didExport) return;
-    _hsm->exportBufferMaxSize = maxSize;
-    _hsm->doExport = true;
-    if (_hsm->isInitialized) Process::wakeUp(_child_pid);
+    if (_tasks[SatSharedMemory::Message::EXPORT].issued) return;
+    issueTask(SatSharedMemory::Message::EXPORT, maxSize);
 }
 bool SatProcessAdapter::hasCollectedClauses() {
-    return !_initialized || (_hsm->doExport && _hsm->didExport);
+    if (!_initialized) return true;
+    pollResponses();
+    auto& task = _tasks[SatSharedMemory::Message::EXPORT];
+    return task.issued && task.completed;
 }
 std::vector<int> SatProcessAdapter::getCollectedClauses() {
     if (!_initialized) return std::vector<int>();
     if (!hasCollectedClauses()) return std::vector<int>();
-    assert(_hsm->exportBufferTrueSize <= _hsm->exportBufferAllocatedSize);
-    std::vector<int> clauses(_export_buffer, _export_buffer+_hsm->exportBufferTrueSize);
+    auto& task = _tasks[SatSharedMemory::Message::EXPORT];
+    assert(task.response.size <= _hsm->exportBufferAllocatedSize);
+    std::vector<int> clauses(_export_buffer, _export_buffer+task.response.size);
     _last_admitted_clause_share = std::pair<int, int>(_hsm->lastNumAdmittedClausesToImport, _hsm->lastNumClausesToImport);
-    _hsm->doExport = false;
+    _last_import_acceptance = _hsm->lastImportAcceptance;
+    task.issued = false;
     return clauses;
 }
 std::pair<int, int> SatProcessAdapter::getLastAdmittedClauseShare() {
     return _last_admitted_clause_share;
 }
-
-bool SatProcessAdapter::process(const std::vector<int>& buffer, BufferTask task) {
-
-    if (!_initialized || _hsm->doFilterImport || _hsm->doDigestImportWithFilter || _hsm->doDigestImportWithoutFilter) {
-        return false;
-    }
-
-    if (task == FILTER_CLAUSES) {
-        _hsm->importBufferSize = buffer.size();
-        _hsm->importBufferRevision = _desired_revision;
-        assert(_hsm->importBufferSize <= _hsm->importBufferMaxSize);
-        memcpy(_import_buffer, buffer.data(), buffer.size()*sizeof(int));
-        _hsm->doFilterImport = true;
-
-    } else if (task == APPLY_FILTER) {
-        memcpy(_filter_buffer, buffer.data(), buffer.size()*sizeof(int));
-        _hsm->doDigestImportWithFilter = true;
-
-    } else if (task == DIGEST_WITHOUT_FILTER) {
-        _hsm->importBufferSize = buffer.size();
-        _hsm->importBufferRevision = _desired_revision;
-        assert(_hsm->importBufferSize <= _hsm->importBufferMaxSize);
-        memcpy(_import_buffer, buffer.data(), buffer.size()*sizeof(int));
-        _hsm->doDigestImportWithoutFilter = true;
-    }
-
-    if (_hsm->isInitialized) Process::wakeUp(_child_pid);
-    return true;
-}
-
-void SatProcessAdapter::filterClauses(const std::vector<int>& clauses) {
-    if (!process(clauses, FILTER_CLAUSES)) _pending_tasks.emplace_back(clauses, FILTER_CLAUSES);
-}
-
-void SatProcessAdapter::applyFilter(const std::vector<int>& filter) {
-    if (!process(filter, APPLY_FILTER)) _pending_tasks.emplace_back(filter, APPLY_FILTER);
+ImportAcceptance SatProcessAdapter::getImportAcceptance() {
+    return _last_import_acceptance;
 }
 
-void SatProcessAdapter::digestClausesWithoutFilter(const std::vector<int>& clauses) {
-    if (!process(clauses, DIGEST_WITHOUT_FILTER)) _pending_tasks.emplace_back(clauses, DIGEST_WITHOUT_FILTER);
+void SatProcessAdapter::filterClauses(std::vector<int>&& clauses) {
+    if (!_initialized) return;
+    assert((int)clauses.size() <= _hsm->importBufferMaxSize);
+    SatSharedMemory::Message msg {SatSharedMemory::Message::FILTER_IMPORT};
+    msg.revision = _desired_revision;
+    addRingTask(std::move(msg), std::move(clauses));
 }
 
 bool SatProcessAdapter::hasFilteredClauses() {
     if (!_initialized) return true;
-    return _hsm->doFilterImport && _hsm->didFilterImport;
+    pollResponses();
+    for (auto& task : _ring_tasks) if (task.msg.type == SatSharedMemory::Message::FILTER_IMPORT)
+        return task.completed;
+    return false;
 }
 std::vector<int> SatProcessAdapter::getLocalFilter() {
-    if (!_initialized || !_hsm->doFilterImport || !_hsm->didFilterImport) 
+    if (!_initialized || !hasFilteredClauses()) 
         return std::vector<int>();
-    std::vector<int> filter;
-    filter.resize(_hsm->filterSize);
-    memcpy(filter.data(), _filter_buffer, _hsm->filterSize*sizeof(int));
-    _hsm->doFilterImport = false;
+    auto it = _ring_tasks.begin();
+    while (it->msg.type != SatSharedMemory::Message::FILTER_IMPORT) ++it;
+    std::vector<int> filter(_task_ring + it->response.offset, 
+        _task_ring + it->response.offset + it->response.length);
+    // The global filter is applied to the most recently filtered clauses
+    if (_filtered_clauses) _task_ring_allocator.release(_filtered_clauses->offset);
+    _filtered_clauses = it->msg;
+    _ring_tasks.erase(it);
     return filter;
 }
 
-void SatProcessAdapter::returnClauses(const std::vector<int>& clauses) {
+void SatProcessAdapter::applyFilter(const std::vector<int>& filter) {
+    if (!_initialized || !_filtered_clauses) return;
+    SatSharedMemory::Message msg {SatSharedMemory::Message::DIGEST_IMPORT_WITH_FILTER};
+    msg.clausesOffset = _filtered_clauses->offset;
+    msg.clausesLength = _filtered_clauses->length;
+    msg.revision = _filtered_clauses->revision;
+    _filtered_clauses.reset();
+    addRingTask(std::move(msg), std::vector<int>(filter));
+}
+
+void SatProcessAdapter::digestClausesWithoutFilter(const std::vector<int>& clauses) {
     if (!_initialized) return;
-    if (_hsm->doReturnClauses) {
-        // Cannot return right now: defer
-        _temp_returned_clauses.push_back(clauses);
-        return;
-    }
-    doReturnClauses(clauses);
+    assert((int)clauses.size() <= _hsm->importBufferMaxSize);
+    SatSharedMemory::Message msg {SatSharedMemory::Message::DIGEST_IMPORT_WITHOUT_FILTER};
+    msg.revision = _desired_revision;
+    addRingTask(std::move(msg), std::vector<int>(clauses));
 }
 
-void SatProcessAdapter::doReturnClauses(const std::vector<int>& clauses) {
-    _hsm->returnedBufferSize = clauses.size();
-    memcpy(_returned_buffer, clauses.data(),
-        std::min((size_t)_hsm->importBufferMaxSize, clauses.size()) * sizeof(int));
-    _hsm->doReturnClauses = true;
-    if (_hsm->isInitialized) Process::wakeUp(_child_pid);
+void SatProcessAdapter::returnClauses(const std::vector<int>& clauses) {
+    if (!_initialized) return;
+    size_t size = std::min((size_t)_hsm->importBufferMaxSize, clauses.size());
+    addRingTask(SatSharedMemory::Message {SatSharedMemory::Message::RETURN_CLAUSES},
+        std::vector<int>(clauses.begin(), clauses.begin()+size));
 }
 
 void SatProcessAdapter::dumpStats() {
     if (!_initialized) return;
-    _hsm->doDumpStats = true;
-    // No hard need to wake up immediately
+    reportRoundTripLatencies();
+    if (_tasks[SatSharedMemory::Message::DUMP_STATS].issued) return;
+    issueTask(SatSharedMemory::Message::DUMP_STATS);
+}
+
+void SatProcessAdapter::reportRoundTripLatencies() {
+    const char* names[] = {"export", "filter", "digest_filtered", "digest", "return", "stats", "revision", "threads"};
+    std::string out;
+    char entry[128];
+    for (int type = 0; type < SatSharedMemory::Message::NUM_TYPES; type++) {
+        auto& task = _tasks[type];
+        if (task.numRoundTrips == 0) continue;
+        snprintf(entry, sizeof(entry), "%s:%i,%.3f,%.3f ", names[type], task.numRoundTrips,
+            1000 * task.sumLatency / task.numRoundTrips, 1000 * task.maxLatency);
+        out += entry;
+    }
+    if (out.empty()) return;
+    LOG(V3_VERB, "%s subproc task roundtrips (#,avgms,maxms) %s\n", _job->toStr(), out.c_str());
 }
 
 SatProcessAdapter::SubprocessStatus SatProcessAdapter::check() {
     if (!_initialized) return NORMAL;
 
+    if (_child_pid == -1) {
+        // The child could not be launched: retry after a short while
+        if (Timer::elapsedSeconds() - _hsm->launchTime < 1) return NORMAL;
+        LOG(V1_WARN, "[WARN] %s : retrying to launch SAT process\n", _job->toStr());
+        return CRASHED;
+    }
+
     int exitStatus;
     if (Process::didChildExit(_child_pid, &exitStatus) && exitStatus != 0) {
         // Child exited!
@@ -330,30 +405,31 @@ SatProcessAdapter::SubprocessStatus SatProcessAdapter::check() {
 
     doWriteRevisions();
 
-    if (_hsm->didReturnClauses)     _hsm->doReturnClauses     = false;
-    if (_hsm->didStartNextRevision) _hsm->doStartNextRevision = false;
-    if (_hsm->didDumpStats)         _hsm->doDumpStats         = false;
-    if (_hsm->didDigestImport) {
-        _hsm->doDigestImportWithFilter = false;
-        _hsm->doDigestImportWithoutFilter = false;
+    // Tasks without any result data are done as soon as the child responded
+    pollResponses();
+    for (auto type : {SatSharedMemory::Message::START_NEXT_REVISION, SatSharedMemory::Message::DUMP_STATS}) {
+        auto& task = _tasks[type];
+        if (task.issued && task.completed) task.issued = false;
+    }
+    auto& threadsTask = _tasks[SatSharedMemory::Message::SET_NUM_THREADS];
+    if (threadsTask.issued && threadsTask.completed) {
+        threadsTask.issued = false;
+        _num_threads = threadsTask.response.size;
+        LOG(V3_VERB, "%s : %i solver threads running\n", _job->toStr(), _num_threads);
+    }
+    if (!threadsTask.issued && _desired_num_threads != _requested_num_threads) {
+        _requested_num_threads = _desired_num_threads;
+        issueTask(SatSharedMemory::Message::SET_NUM_THREADS, _requested_num_threads);
     }
 
-    if (!_hsm->doStartNextRevision 
-        && !_hsm->didStartNextRevision 
+    if (!_tasks[SatSharedMemory::Message::START_NEXT_REVISION].issued
         && _published_revision < _written_revision) {
         _published_revision++;
-        _hsm->desiredRevision = _desired_revision;
-        _hsm->doStartNextRevision = true;
+        issueTask(SatSharedMemory::Message::START_NEXT_REVISION, 0, _desired_revision);
     }
 
-    if (!_pending_tasks.empty() && process(_pending_tasks.front().first, _pending_tasks.front().second)) {
-        _pending_tasks.pop_front();
-    }
-
-    if (!_hsm->doReturnClauses && !_hsm->didReturnClauses && !_temp_returned_clauses.empty()) {
-        doReturnClauses(_temp_returned_clauses.front());
-        _temp_returned_clauses.pop_front();
-    }
+    // Issue tasks for which there was no space in the task ring before
+    issueRingTasks();
     
     // Solution preparation just ended?
     if (!_solution_in_preparation && _solution_prepare_future.valid()) {
@@ -389,11 +465,12 @@ void SatProcessAdapter::doPrepareSolution() {
         return;
     } 
 
-    // ACCESS the existing shared memory segment to the solution vector
-    int* shmemSolution = (int*) SharedMemory::access(_shmem_id + ".solution." + std::to_string(rev), *solutionSize*sizeof(int));
+    // ACCESS the existing shared memory segment to the serialized result
+    uint8_t* shmemSolution = (uint8_t*) SharedMemory::access(_shmem_id + ".solution." + std::to_string(rev), *solutionSize);
     
+    // Take over the result as is, without expanding a compact model
+    _solution = JobResult(std::vector<uint8_t>(shmemSolution, shmemSolution + *solutionSize));
     _solution.result = _hsm->result;
-    _solution.setSolutionToSerialize(shmemSolution, *solutionSize);
     _solution_in_preparation = false;
 }
 
@@ -430,6 +507,7 @@ void* SatProcessAdapter::createSharedMemoryBlock(std::string shmemSubId, size_t
 
 void SatProcessAdapter::crash() {
     _hsm->doCrash = true;
+    _hsm->childDoorbell.ring();
 }
 
 SatProcessAdapter::~SatProcessAdapter() {
@@ -453,8 +531,8 @@ void SatProcessAdapter::freeSharedMemory() {
         for (int rev = 0; rev <= _written_revision; rev++) {
             size_t* solSize = (size_t*) SharedMemory::access(_shmem_id + ".solutionsize." + std::to_string(rev), sizeof(size_t));
             if (solSize != nullptr) {
-                char* solution = (char*) SharedMemory::access(_shmem_id + ".solution." + std::to_string(rev), *solSize * sizeof(int));
-                SharedMemory::free(_shmem_id + ".solution." + std::to_string(rev), solution, *solSize * sizeof(int));
+                char* solution = (char*) SharedMemory::access(_shmem_id + ".solution." + std::to_string(rev), *solSize);
+                SharedMemory::free(_shmem_id + ".solution." + std::to_string(rev), solution, *solSize);
                 SharedMemory::free(_shmem_id + ".solutionsize." + std::to_string(rev), (char*)solSize, sizeof(size_t));
             }
         }
@@ -3,6 +3,8 @@
 
 #include <list>
 #include <future>
+#include <array>
+#include <optional>
 
 #include "util/logger.hpp"
 #include "util/sys/threading.hpp"
@@ -12,6 +14,7 @@
 #include "data/checksum.hpp"
 #include "util/sys/background_worker.hpp"
 #include "data/job_result.hpp"
+#include "util/ring_allocator.hpp"
 
 class ForkedSatJob; // fwd
 class AnytimeSatClauseCommunicator;
@@ -70,13 +73,47 @@ private:
     std::future<void> _bg_writer;
 
     int* _export_buffer;
-    int* _import_buffer;
-    int* _filter_buffer;
-    int* _returned_buffer;
-    enum BufferTask {FILTER_CLAUSES, APPLY_FILTER, DIGEST_WITHOUT_FILTER};
-    std::list<std::pair<std::vector<int>, BufferTask>> _pending_tasks;
-    std::list<std::vector<int>> _temp_returned_clauses;
+    int* _task_ring;
+    RingAllocator _task_ring_allocator;
+    int _next_task_id = 1;
+
+    // State of each type of task which can be issued to the child process
+    struct TaskState {
+        // For tasks without a record in the task ring, at most one task per type is issued at a time
+        bool issued = false; // issued and not yet processed by the parent
+        bool completed = false; // the child's response arrived
+        SatSharedMemory::Message response;
+        float issueTime;
+        // Round-trip latencies from issuing a task to receiving the response
+        int numRoundTrips = 0;
+        float sumLatency = 0;
+        float maxLatency = 0;
+    };
+    std::array<TaskState, SatSharedMemory::Message::NUM_TYPES> _tasks;
+
+    // Tasks with a record in the task ring, in the order of their creation.
+    // Tasks which could not be issued yet for lack of space are at the back.
+    struct RingTask {
+        SatSharedMemory::Message msg;
+        std::vector<int> record; // to be written to the task ring (until issued)
+        bool issued = false;
+        bool completed = false;
+        SatSharedMemory::Message response;
+        float issueTime;
+    };
+    std::list<RingTask> _ring_tasks;
+    int _num_issued_ring_tasks = 0;
+    // Imported clauses (in the task ring) whose local filter was fetched,
+    // to which the global filter is applied next
+    std::optional<SatSharedMemory::Message> _filtered_clauses;
+
     std::pair<int, int> _last_admitted_clause_share;
+    ImportAcceptance _last_import_acceptance;
+
+    // Number of solver threads running in the child, and as desired by the parent
+    int _num_threads;
+    int _desired_num_threads;
+    int _requested_num_threads;
 
     pid_t _child_pid = -1;
     SolvingStates::SolvingState _state = SolvingStates::INITIALIZING;
@@ -111,14 +148,17 @@ public:
     bool hasClauseComm();
     AnytimeSatClauseCommunicator* getClauseComm() {return _clause_comm;}
     void releaseClauseComm() {_clause_comm = nullptr;}
-    int getStartedNumThreads() const {return _config.threads;}
+    int getStartedNumThreads() const {return _num_threads;}
+    // Adds or removes solver threads in the running child process
+    void setNumThreads(int numThreads) {_desired_num_threads = numThreads;}
 
     void collectClauses(int maxSize);
     bool hasCollectedClauses();
     std::vector<int> getCollectedClauses();
     std::pair<int, int> getLastAdmittedClauseShare();
+    ImportAcceptance getImportAcceptance();
 
-    void filterClauses(const std::vector<int>& clauses);
+    void filterClauses(std::vector<int>&& clauses);
     bool hasFilteredClauses();
     std::vector<int> getLocalFilter();
 
@@ -137,13 +177,18 @@ public:
 
 private:
     void doInitialize();
+    pid_t launchChild();
     void doWriteRevisions();
     void doPrepareSolution();
 
-    bool process(const std::vector<int>& clauses, BufferTask task);
+    void issueTask(SatSharedMemory::Message::Type type, int size = 0, int revision = 0);
+    void addRingTask(SatSharedMemory::Message&& msg, std::vector<int>&& record);
+    void issueRingTasks();
+    void pollResponses();
+    void recordRoundTrip(SatSharedMemory::Message::Type type, float issueTime);
+    void reportRoundTripLatencies();
     
     void applySolvingState();
-    void doReturnClauses(const std::vector<int>& clauses);
     void initSharedMemory(SatProcessConfig&& config);
     void* createSharedMemoryBlock(std::string shmemSubId, size_t size, void* data);
 
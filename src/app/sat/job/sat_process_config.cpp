@@ -14,7 +14,7 @@ SatProcessConfig::SatProcessConfig(const Parameters& params, const Job& job, int
     jobid = job.getId();
     incremental = job.getDescription().isIncremental();
     firstrev = job.getDesiredRevision();
-    threads = job.getNumThreads();
+    threads = job.getNumActiveThreads();
     maxBroadcastedLitsPerCycle = (1+params.clauseHistoryAggregationFactor()) *
     MyMpi::getBinaryTreeBufferLimit(job.getGlobalNumWorkers(), params.clauseBufferBaseSize(), params.clauseBufferDiscountFactor(), MyMpi::ALL);
     this->recoveryIndex = recoveryIndex;
@@ -25,3 +25,8 @@ std::string SatProcessConfig::getSharedMemId(pid_t pid) const {
         + std::to_string(mpirank) + ".#" + std::to_string(jobid) 
         + (recoveryIndex == 0 ? std::string() : "~" + std::to_string(recoveryIndex));
 }
+
+std::string SatProcessConfig::getRetainedClausesFile(pid_t pid) const {
+    return "/dev/shm/edu.kit.iti.mallob." + std::to_string(pid) + "." 
+        + std::to_string(mpirank) + ".#" + std::to_string(jobid) + ".retained";
+}
@@ -42,6 +42,9 @@ struct SatProcessConfig {
     }
 
     std::string getSharedMemId(pid_t pid) const;
+    // File in which a SAT process hands its retained clauses to the process
+    // which replaces it (for any recovery index)
+    std::string getRetainedClausesFile(pid_t pid) const;
 
     std::string toString() const {
         std::string out = "";
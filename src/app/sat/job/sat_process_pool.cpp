@@ -0,0 +1,158 @@
+
+#include "sat_process_pool.hpp"
+
+#include <unistd.h>
+#include <sys/mman.h>
+#include <vector>
+#include <cstring>
+
+#include "sat_process_config.hpp"
+#include "util/sys/shared_memory.hpp"
+#include "util/sys/process.hpp"
+#include "util/sys/proc.hpp"
+#include "util/sys/timer.hpp"
+#include "util/sys/terminator.hpp"
+#include "util/logger.hpp"
+#include "comm/mympi.hpp"
+
+#ifndef MALLOB_SUBPROC_DISPATCH_PATH
+#define MALLOB_SUBPROC_DISPATCH_PATH ""
+#endif
+
+std::optional<Parameters> SatProcessPool::_params;
+std::string SatProcessPool::_program;
+std::list<SatProcessPool::PooledProcess> SatProcessPool::_processes;
+int SatProcessPool::_num_spawned = 0;
+Mutex SatProcessPool::_mutex;
+
+// Splits a string of space-separated words in place into an argv-style array
+static std::vector<char*> toArgv(std::string& command) {
+    std::vector<char*> argv;
+    size_t argBegin = 0;
+    for (size_t i = 0; i <= command.size(); ++i) {
+        if (i < command.size() && command[i] != ' ') continue;
+        if (i < command.size()) command[i] = '\0';
+        if (i > argBegin) argv.push_back(command.data()+argBegin);
+        argBegin = i+1;
+    }
+    argv.push_back(nullptr);
+    return argv;
+}
+
+void SatProcessPool::init(const Parameters& params, const std::string& program) {
+    auto lock = _mutex.getLock();
+    _params.emplace(params);
+    _program = program.empty() ? MALLOB_SUBPROC_DISPATCH_PATH"mallob_sat_process" : program;
+    while ((int)_processes.size() < _params->satProcessPoolSize() && spawn()) {}
+}
+
+pid_t SatProcessPool::adopt(const Parameters& jobParams) {
+    auto lock = _mutex.getLock();
+    for (auto it = _processes.begin(); it != _processes.end();) {
+        if (Process::didChildExit(it->pid)) {
+            LOG(V1_WARN, "[WARN] Pooled SAT process %ld exited\n", it->pid);
+            free(*it);
+            it = _processes.erase(it);
+            continue;
+        }
+        if (!it->slot->ready) {
+            ++it;
+            continue;
+        }
+        std::string options = jobParams.getParamsAsString();
+        if (options.size() > sizeof(it->slot->options)) {
+            LOG(V1_WARN, "[WARN] Program options too long (%lu) for pooled SAT process\n", options.size());
+            return -1;
+        }
+        memcpy(it->slot->options, options.data(), options.size());
+        it->slot->optionsLength = options.size();
+        it->slot->adopted = true;
+        it->slot->doorbell.ring();
+        pid_t pid = it->pid;
+        free(*it);
+        _processes.erase(it);
+        return pid;
+    }
+    return -1;
+}
+
+void SatProcessPool::replenish() {
+    auto lock = _mutex.getLock();
+    if (!_params) return;
+    while ((int)_processes.size() < _params->satProcessPoolSize() && spawn()) {}
+}
+
+void SatProcessPool::shutdown() {
+    auto lock = _mutex.getLock();
+    for (auto& proc : _processes) {
+        proc.slot->terminate = true;
+        proc.slot->doorbell.ring();
+        free(proc);
+    }
+    _processes.clear();
+    _params.reset();
+}
+
+bool SatProcessPool::spawn() {
+
+    std::string slotId = "/edu.kit.iti.mallob." + std::to_string(Proc::getPid()) 
+        + ".satpool." + std::to_string(_num_spawned++);
+    Slot* slot = new (SharedMemory::create(slotId, sizeof(Slot))) Slot();
+
+    // Everything the process needs to know before being adopted
+    SatProcessConfig config;
+    auto t = Timer::getStartTime();
+    config.starttimeSecs = t.tv_sec;
+    config.starttimeNsecs = t.tv_nsec;
+    config.mpirank = MyMpi::rank(MPI_COMM_WORLD);
+    config.mpisize = MyMpi::size(MPI_COMM_WORLD);
+    config.apprank = config.jobid = config.firstrev = config.threads = -1;
+    config.incremental = false;
+    config.maxBroadcastedLitsPerCycle = config.recoveryIndex = 0;
+    Parameters hParams(*_params);
+    hParams.satEngineConfig.set(config.toString());
+    hParams.satProcessPoolSlot.set(slotId);
+
+    char* const* argv = hParams.asCArgs(_program.c_str());
+    pid_t pid = Process::spawnChild(argv);
+    delete[] ((const char**) argv);
+    if (pid == -1) {
+        SharedMemory::free(slotId, (char*) slot, sizeof(Slot));
+        return false;
+    }
+    LOG(V4_VVER, "Started pooled SAT process %ld\n", pid);
+    _processes.push_back(PooledProcess{pid, slotId, slot});
+    return true;
+}
+
+void SatProcessPool::free(PooledProcess& proc) {
+    // The process keeps its own mapping of the slot
+    SharedMemory::free(proc.slotId, (char*) proc.slot, sizeof(Slot));
+    proc.slot = nullptr;
+}
+
+bool SatProcessPool::awaitAdoption(const std::string& slotId, Parameters& params) {
+
+    Slot* slot = (Slot*) SharedMemory::access(slotId, sizeof(Slot));
+    if (slot == nullptr) return false;
+    slot->ready = true;
+
+    while (true) {
+        int numRings = slot->doorbell.peek();
+        if (slot->adopted) break;
+        // Exit if the pool is shut down or the worker is gone
+        if (slot->terminate || Terminator::isTerminating(/*fromMainThread=*/true)
+                || Proc::getParentPid() == 1) {
+            munmap(slot, sizeof(Slot));
+            return false;
+        }
+        slot->doorbell.waitUntilRung(numRings, /*timeoutSeconds=*/1);
+    }
+
+    // Take over the options of the adopting job
+    std::string options = "mallob_sat_process " + std::string(slot->options, slot->optionsLength);
+    munmap(slot, sizeof(Slot));
+    auto argv = toArgv(options);
+    params.init(argv.size()-1, argv.data());
+    return true;
+}
@@ -0,0 +1,62 @@
+
+#pragma once
+
+#include <list>
+#include <optional>
+#include <string>
+#include <atomic>
+#include <sys/types.h>
+
+#include "util/params.hpp"
+#include "util/sys/threading.hpp"
+#include "util/sys/futex.hpp"
+
+// Pool of pre-started SAT processes of this worker which wait for a job to adopt them.
+// A pooled process has done everything up to the point where it needs to know its job
+// (process start, program loading, signal handlers, logging, thread pool) and then blocks
+// on a shared memory slot. A job adopting a pooled process hands over its program options,
+// including the SAT engine config which identifies the job's shared memory, via the slot.
+class SatProcessPool {
+
+public:
+    struct Slot {
+        SharedMemoryDoorbell doorbell;
+        std::atomic_bool ready {false}; // the pooled process is waiting for adoption
+        std::atomic_bool adopted {false};
+        std::atomic_bool terminate {false};
+        int optionsLength;
+        char options[1<<16];
+    };
+
+private:
+    struct PooledProcess {
+        pid_t pid;
+        std::string slotId;
+        Slot* slot;
+    };
+    static std::optional<Parameters> _params;
+    static std::string _program;
+    static std::list<PooledProcess> _processes;
+    static int _num_spawned;
+    static Mutex _mutex;
+
+public:
+    // Start the number of processes given by the -spps option. The pooled processes
+    // run the SAT process program unless another program is provided (e.g., for tests).
+    static void init(const Parameters& params, const std::string& program = "");
+    // Hand over a pooled process to a job with the provided options.
+    // Returns the pid of the adopted process or -1 if no process is ready.
+    static pid_t adopt(const Parameters& jobParams);
+    // Start new processes to replace adopted ones.
+    static void replenish();
+    // Let all pooled processes exit.
+    static void shutdown();
+
+    // Within a pooled process: wait until a job adopts this process and overwrite the
+    // provided options with the job's options. Returns false if the process should exit instead.
+    static bool awaitAdoption(const std::string& slotId, Parameters& params);
+
+private:
+    static bool spawn();
+    static void free(PooledProcess& proc);
+};
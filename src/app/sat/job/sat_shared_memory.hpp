@@ -1,61 +1,76 @@
-
 #pragma once
 
 #include <sys/types.h>
+#include <atomic>
 
 #include "../solvers/portfolio_solver_interface.hpp"
+#include "../data/import_acceptance.hpp"
 #include "data/checksum.hpp"
 #include "sat_process_config.hpp"
+#include "util/sys/futex.hpp"
+#include "util/sys/shared_memory_queue.hpp"
 
 struct SatSharedMemory {
 
+    // A task from the parent to the child process, or the child's response
+    // to a task it completed. Exported clauses are transferred via the export buffer;
+    // all other clause data is transferred via variable-size records in the task ring.
+    struct Message {
+        enum Type {
+            EXPORT, FILTER_IMPORT, DIGEST_IMPORT_WITH_FILTER, DIGEST_IMPORT_WITHOUT_FILTER,
+            RETURN_CLAUSES, DUMP_STATS, START_NEXT_REVISION, SET_NUM_THREADS, NUM_TYPES
+        } type;
+        // Identifies the task; a response carries the ID of its task
+        int id = 0;
+        // Max. export size (EXPORT) or true export size (response to EXPORT),
+        // desired / resulting number of solver threads (SET_NUM_THREADS)
+        int size = 0;
+        // Position and size of the task's record in the task ring: clauses to import
+        // (FILTER_IMPORT, DIGEST_IMPORT_WITHOUT_FILTER), filter (DIGEST_IMPORT_WITH_FILTER,
+        // response to FILTER_IMPORT), or returned clauses (RETURN_CLAUSES)
+        int offset = 0;
+        int length = 0;
+        // Position and size of the clauses to apply the filter to (DIGEST_IMPORT_WITH_FILTER)
+        int clausesOffset = 0;
+        int clausesLength = 0;
+        // Revision of the imported clauses, desired revision (START_NEXT_REVISION)
+        int revision = 0;
+    };
+
     SatProcessConfig config;
 
     // Meta data parent->child
     int fSize;
     int aSize;
-    int desiredRevision;
+    float launchTime; // time when the parent started or adopted the child process
+
+    // Tasks parent->child and responses child->parent. The child processes
+    // tasks in the order of their arrival (except for imports of future revisions).
+    SharedMemoryQueue<Message, 256> tasks;
+    SharedMemoryQueue<Message, 256> responses;
+    // Rung for each new task, state change, or solver result:
+    // the child's main thread blocks on it while there is nothing to do.
+    SharedMemoryDoorbell childDoorbell;
 
     // Instructions parent->child
-    bool doBegin;
-    bool doExport;
-    bool doFilterImport;
-    bool doDigestImportWithFilter;
-    bool doDigestImportWithoutFilter;
-    bool doReturnClauses;
-    bool doDumpStats;
-    bool doStartNextRevision;
-    bool doTerminate;
-    bool doCrash;
-
-    // Responses child->parent
-    bool didExport;
-    bool didFilterImport;
-    bool didDigestImport;
-    bool didReturnClauses;
-    bool didDumpStats;
-    bool didStartNextRevision;
-    bool didTerminate;
+    std::atomic_bool doBegin {false};
+    std::atomic_bool doTerminate {false};
+    std::atomic_bool doCrash {false};
 
     // State alerts child->parent
-    bool isInitialized;
-    bool hasSolution;
-    SatResult result;
-    int solutionRevision;
-    
+    std::atomic_bool didTerminate {false};
+    std::atomic_bool isInitialized {false};
+    std::atomic_bool hasSolution {false};
+    SatResult result {UNKNOWN};
+    int solutionRevision {-1};
+
     // Clause buffers: parent->child
     int exportBufferAllocatedSize;
-    int exportBufferMaxSize;
     int importBufferMaxSize;
-    int importBufferSize;
-    int importBufferRevision;
-    int returnedBufferSize;
-    Checksum importChecksum;
-    
+    int taskRingSize;
+
     // Clause buffers: child->parent
-    int exportBufferTrueSize;
-    Checksum exportChecksum;
-    int filterSize;
     int lastNumClausesToImport;
     int lastNumAdmittedClausesToImport;
+    ImportAcceptance lastImportAcceptance;
 };
@@ -0,0 +1,41 @@
+
+#pragma once
+
+#include <list>
+
+// Order in which the clause sharing sessions of a job - job-wide ones, possibly several
+// in flight at once, and host-level ones - perform their local operations on the job.
+// The job can only process one sharing operation of each kind at a time:
+// - Prepared clauses are handed to the oldest session (by creation) which still lacks them.
+// - A job-wide session only filters its broadcast clauses once all older job-wide
+//   sessions have digested theirs (with the global filter).
+// A Session provides its order of creation (_seq), isValid() - whether it is still
+// in progress - and isLocallyDigested() - whether its filtering and digestion on the
+// job are done or will never happen.
+struct SessionOrder {
+
+    // Calls advance(session, oldestWithoutClauses, mayFilter) for each valid job-wide
+    // session and advanceHost(session, oldestWithoutClauses) for each valid host-level
+    // session, where needsClauses(session) tells whether a session still lacks clauses.
+    template <typename Session, typename NeedsClauses, typename Advance, typename AdvanceHost>
+    static void advance(std::list<Session>& sessions, std::list<Session>& hostSessions,
+            NeedsClauses needsClauses, Advance advance, AdvanceHost advanceHost) {
+
+        const Session* oldestWithoutClauses = nullptr;
+        for (auto* list : {&sessions, &hostSessions}) for (auto& session : *list) {
+            if (!needsClauses(session)) continue;
+            if (oldestWithoutClauses == nullptr || session._seq < oldestWithoutClauses->_seq)
+                oldestWithoutClauses = &session;
+        }
+        bool olderSessionsDigested = true;
+        for (auto& session : sessions) {
+            if (!session.isValid()) continue;
+            advance(session, &session == oldestWithoutClauses, olderSessionsDigested);
+            olderSessionsDigested &= session.isLocallyDigested();
+        }
+        for (auto& session : hostSessions) {
+            if (!session.isValid()) continue;
+            advanceHost(session, &session == oldestWithoutClauses);
+        }
+    }
+};
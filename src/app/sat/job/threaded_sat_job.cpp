@@ -155,7 +155,16 @@ void ThreadedSatJob::appl_communicate(int source, int mpiTag, JobMessage& msg) {
 }
 
 void ThreadedSatJob::appl_memoryPanic() {
-    // TODO
+    if (!_initialized || _destroy_future.valid() || getNumThreads() <= 1) return;
+    // Remove a solver thread from the engine
+    setNumThreads(getNumThreads()-1);
+    LOG(V1_WARN, "[WARN] %s : memory panic triggered - reducing solver to %i threads\n", toStr(), getNumThreads());
+    _solver->setNumThreads(getNumThreads());
+}
+
+void ThreadedSatJob::appl_setNumActiveThreads(int nbThreads) {
+    if (!_initialized || _destroy_future.valid() || getState() != ACTIVE) return;
+    _solver->setNumThreads(nbThreads);
 }
 
 bool ThreadedSatJob::isInitialized() {
@@ -166,10 +175,9 @@ void ThreadedSatJob::prepareSharing(int maxSize) {
     // Already prepared sharing?
     if (!_clause_buffer.empty()) return;
     
-    _clause_buffer.resize(2*maxSize+100);
+    // The engine runs in this process: take over its export buffer as is
     _clause_checksum = Checksum();
-    int actualSize = _solver->prepareSharing(_clause_buffer.data(), maxSize);
-    _clause_buffer.resize(actualSize);
+    _clause_buffer = _solver->prepareSharing(maxSize);
 }
 bool ThreadedSatJob::hasPreparedSharing() {
     return !_clause_buffer.empty();
@@ -183,13 +191,16 @@ std::vector<int> ThreadedSatJob::getPreparedClauses(Checksum& checksum) {
 std::pair<int, int> ThreadedSatJob::getLastAdmittedClauseShare() {
     return _solver->getLastAdmittedClauseShare();
 }
+ImportAcceptance ThreadedSatJob::getImportAcceptance() {
+    return _solver->getImportAcceptance();
+}
 
-void ThreadedSatJob::filterSharing(std::vector<int>& clauses) {
+void ThreadedSatJob::filterSharing(std::vector<int>&& clauses) {
     auto maxFilterSize = clauses.size()/(8*sizeof(int))+1;
     if (_filter.size() < maxFilterSize) _filter.resize(maxFilterSize);
     int filterSize = _solver->filterSharing(clauses.data(), clauses.size(), _filter.data());
     _filter.resize(filterSize);
-    _clauses_to_filter = clauses;
+    _clauses_to_filter = std::move(clauses);
     _did_filter = true;
 }
 bool ThreadedSatJob::hasFilteredSharing() {
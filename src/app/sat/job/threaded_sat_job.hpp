@@ -59,6 +59,7 @@ public:
     void appl_dumpStats() override;
     bool appl_isDestructible() override;
     void appl_memoryPanic() override;
+    void appl_setNumActiveThreads(int nbThreads) override;
 
     // Methods that are not overridden, but use the default implementation:
     // int getDemand(int prevVolume) const override;
@@ -72,8 +73,9 @@ public:
     bool hasPreparedSharing() override;
     std::vector<int> getPreparedClauses(Checksum& checksum) override;
     std::pair<int, int> getLastAdmittedClauseShare() override;
+    ImportAcceptance getImportAcceptance() override;
     
-    virtual void filterSharing(std::vector<int>& clauses) override;
+    virtual void filterSharing(std::vector<int>&& clauses) override;
     virtual bool hasFilteredSharing() override;
     virtual std::vector<int> getLocalFilter() override;
     virtual void applyFilter(std::vector<int>& filter) override;
@@ -17,6 +17,7 @@
 #include "data/checksum.hpp"
 #include "execution/sat_process.hpp"
 #include "util/sys/fileutils.hpp"
+#include "job/sat_process_pool.hpp"
 
 #ifndef MALLOB_VERSION
 #define MALLOB_VERSION "(dbg)"
@@ -35,8 +36,6 @@ int main(int argc, char *argv[]) {
 
     int rankOfParent = config.mpirank;
 
-    Random::init(config.mpisize, rankOfParent);
-
     ProcessWideThreadPool::init(1);
 
     // Initialize signal handlers
@@ -56,14 +55,22 @@ int main(int argc, char *argv[]) {
     logConfig.logDirOrNull = logdir.empty() ? nullptr : &logdir;
     logConfig.logFilenameOrNull = &logFilename;
     Logger::init(logConfig);
+
+    // A pre-started process waits until a job adopts it, then takes over the job's options
+    if (params.satProcessPoolSlot.isSet()) {
+        if (!SatProcessPool::awaitAdoption(params.satProcessPoolSlot(), params)) {
+            Logger::getMainInstance().flush();
+            Process::doExit(0);
+        }
+        config = SatProcessConfig(params.satEngineConfig());
+    }
+
+    Random::init(config.mpisize, rankOfParent);
     Logger::getMainInstance().setLinePrefix(" <" + config.getJobStr() + ">");
     
     pid_t pid = Proc::getPid();
     LOG(V3_VERB, "Mallob SAT engine %s pid=%lu\n", MALLOB_VERSION, pid);
     
-    // Clean up subprocess command tmp file
-    FileUtils::rm("/tmp/mallob_subproc_cmd_" + std::to_string(pid));
-    
     try {
         // Launch program
         SatProcess p(params, config, Logger::getMainInstance());
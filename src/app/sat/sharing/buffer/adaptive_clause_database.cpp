@@ -422,8 +422,8 @@ int AdaptiveClauseDatabase::stealBudgetFromSlot(Slot<T>& slot, int desiredLitera
     return freeBudget + nbCollectedLits;
 }
 
-BufferReader AdaptiveClauseDatabase::getBufferReader(int* begin, size_t size, bool useChecksums) {
-    return BufferReader(begin, size, _max_clause_length, _slots_for_sum_of_length_and_lbd, useChecksums);
+BufferReader AdaptiveClauseDatabase::getBufferReader(int* begin, size_t size, bool useChecksums, bool computeHashes) {
+    return BufferReader(begin, size, _max_clause_length, _slots_for_sum_of_length_and_lbd, useChecksums, computeHashes);
 }
 
 BufferMerger AdaptiveClauseDatabase::getBufferMerger(int sizeLimit) {
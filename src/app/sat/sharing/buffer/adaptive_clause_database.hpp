@@ -210,8 +210,10 @@ public:
     as exported by exportBuffer. Must have been created by an AdaptiveClauseDatabase
     or a BufferMerger with the same parametrization as this instance.
     Throughout the life time of the BufferReader, the underlying vector must be valid.
+    If computeHashes is set, the reader hashes the clauses of each bucket at once and
+    provides the hash of each clause via getCurrentClauseHash.
     */
-    BufferReader getBufferReader(int* begin, size_t size, bool useChecksums = false);
+    BufferReader getBufferReader(int* begin, size_t size, bool useChecksums = false, bool computeHashes = false);
     BufferMerger getBufferMerger(int sizeLimit);
     BufferBuilder getBufferBuilder(std::vector<int>* out = nullptr);
 
@@ -41,7 +41,7 @@ std::vector<int> BufferMerger::merge(std::vector<int>* excessClauses) {
 
     // Setup builders for main buffer and excess clauses buffer
     BufferBuilder mainBuilder(_size_limit, _max_clause_length, _slots_for_sum_of_length_and_lbd);
-    BufferBuilder* excessBuilder;
+    BufferBuilder* excessBuilder = nullptr;
     if (excessClauses != nullptr) {
         excessBuilder = new BufferBuilder(_size_limit, _max_clause_length, _slots_for_sum_of_length_and_lbd);
     }
@@ -64,6 +64,8 @@ std::vector<int> BufferMerger::merge(std::vector<int>* excessClauses) {
             // Try to append to current builder
             bool success = currentBuilder->append(lastSeenClause);
             if (!success && currentBuilder == &mainBuilder) {
+                // Main buffer is full: done unless excess clauses are collected
+                if (excessBuilder == nullptr) break;
                 // Switch from normal output to excess clauses output
                 currentBuilder = excessBuilder;
                 success = currentBuilder->append(lastSeenClause);
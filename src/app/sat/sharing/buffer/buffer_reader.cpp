@@ -2,8 +2,10 @@
 #include "buffer_reader.hpp"
 #include "util/logger.hpp"
 
-BufferReader::BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, bool useChecksum) : 
-        _buffer(buffer), _size(size), _it(maxClauseLength, slotsForSumOfLengthAndLbd), _use_checksum(useChecksum) {
+BufferReader::BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, 
+        bool useChecksum, bool computeHashes) : 
+        _buffer(buffer), _size(size), _it(maxClauseLength, slotsForSumOfLengthAndLbd), 
+        _use_checksum(useChecksum), _compute_hashes(computeHashes || useChecksum) {
     
     int numInts = sizeof(size_t)/sizeof(int);
     if (_use_checksum && _size > 0) {
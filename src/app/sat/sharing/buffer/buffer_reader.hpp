@@ -2,10 +2,13 @@
 #pragma once
 
 #include <cstring>
+#include <vector>
+#include <algorithm>
 
 #include "util/assert.hpp"
 #include "buffer_iterator.hpp"
 #include "../../data/clause.hpp"
+#include "../../data/batch_clause_hasher.hpp"
 #include "util/hashing.hpp"
 #include "util/logger.hpp"
 
@@ -23,9 +26,16 @@ private:
     size_t _hash;
     size_t _true_hash = 1;
 
+    // Commutative hashes of the clauses of the current bucket, computed all at once
+    bool _compute_hashes;
+    std::vector<size_t> _bucket_hashes;
+    size_t _bucket_hash_idx = 0;
+    size_t _current_hash = 0;
+
 public:
     BufferReader() = default;
-    BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, bool useChecksum = false);
+    BufferReader(int* buffer, int size, int maxClauseLength, bool slotsForSumOfLengthAndLbd, 
+        bool useChecksum = false, bool computeHashes = false);
 
     void releaseBuffer() {_buffer = nullptr;}
     
@@ -33,6 +43,9 @@ public:
     size_t getCurrentBufferPosition() const {return _current_pos;} 
     size_t getRemainingSize() const {return _size - _current_pos;}
     size_t getNumRemainingClausesInBucket() const {return _remaining_cls_of_bucket;}
+    // Mallob::commutativeHash(.., 3) of the current clause; only valid if the reader
+    // was constructed with computeHashes (or useChecksum) set.
+    size_t getCurrentClauseHash() const {return _current_hash;}
     const BufferIterator& getCurrentBufferIterator() const {return _it;} 
     
     inline const Mallob::Clause& getNextIncomingClause() {
@@ -51,6 +64,8 @@ public:
                 _it.nextLengthLbdGroup();
                 _remaining_cls_of_bucket = _buffer[_current_pos++];
                 assert(_remaining_cls_of_bucket >= 0);
+                _bucket_hashes.clear();
+                _bucket_hash_idx = 0;
             
             } while (_remaining_cls_of_bucket == 0);
 
@@ -71,10 +86,10 @@ public:
             abort();
         }
 
-        if (_use_checksum) {
-            hash_combine(_hash, Mallob::ClauseHasher::hash(
-                _buffer+_current_pos, _current_clause.size, 3
-            ));
+        if (_compute_hashes) {
+            if (_bucket_hash_idx == _bucket_hashes.size()) hashRemainingClausesOfBucket();
+            _current_hash = _bucket_hashes[_bucket_hash_idx++];
+            if (_use_checksum) hash_combine(_hash, _current_hash);
         }
 
         // Set pointer to literals
@@ -89,4 +104,13 @@ public:
 
 private:
     const Mallob::Clause& endReading();
+
+    void hashRemainingClausesOfBucket() {
+        size_t numClauses = std::min(_remaining_cls_of_bucket, 
+            (_size - _current_pos) / _current_clause.size);
+        _bucket_hashes.resize(numClauses);
+        _bucket_hash_idx = 0;
+        Mallob::BatchClauseHasher::commutativeHashes(_buffer+_current_pos, 
+            _current_clause.size, numClauses, _bucket_hashes.data(), 3);
+    }
 };
@@ -30,42 +30,62 @@ public:
         _hist_admitted_to_db(maxClauseLength), 
         _hist_dropped_before_db(maxClauseLength) {}
 
-    void produce(int* begin, int size, int lbd, int producerId, int epoch) {
-
-        if (_filter.tryAcquireLock()) {
-
-            // Insert clause directly
-            auto result = _filter.tryRegisterAndInsert(
-                ProducedClauseCandidate(begin, size, lbd, producerId, epoch), 
-                _cdb
-            );
-            handleResult(producerId, result, size);
-
-            // Also decrease backlog size by some amount
-            std::list<ProducedClauseCandidate> backlogSplice;
-            {
-                auto lock = _backlog_mutex.getLock();
-                if (!_export_backlog.empty()) {
-                    backlogSplice.splice(backlogSplice.begin(), _export_backlog, 
-                        _export_backlog.begin(),
-                        std::next(_export_backlog.begin(), std::min(16ul, _export_backlog.size()))
-                    );
-                }
+    // Inserts a batch of clauses, each given as its size, its LBD, and its literals.
+    // The literals of each clause may be reordered in place.
+    void produce(int* batch, size_t batchSize, int producerId, int epoch) {
+
+        // Try to insert the clauses directly, without copying them
+        std::list<ProducedClauseCandidate> busyClauses;
+        size_t numClauses = 0;
+        for (size_t pos = 0; pos < batchSize; pos += 2+batch[pos]) {
+            numClauses++;
+            ProducedClauseCandidate pcc;
+            pcc.begin = batch+pos+2;
+            pcc.size = batch[pos];
+            pcc.lbd = batch[pos+1];
+            pcc.producerId = producerId;
+            pcc.epoch = epoch;
+            auto result = _filter.tryRegisterAndInsert(pcc, _cdb, /*blocking=*/false);
+            if (result == ProducedClauseFilter::BUSY) {
+                // Filter shard busy: Copy clause for the backlog
+                busyClauses.emplace_back(pcc.begin, pcc.size, pcc.lbd, producerId, epoch);
+            } else {
+                handleResult(producerId, result, pcc.size);
             }
-            for (auto& pcc : backlogSplice) {
-                int clauseLength = pcc.size;
-                int producerId = pcc.producerId;
-                result = _filter.tryRegisterAndInsert(std::move(pcc), _cdb);
-                handleResult(producerId, result, clauseLength);
+            pcc.releaseData();
+        }
+        if (!busyClauses.empty()) {
+            // Append clauses to backlog
+            auto lock = _backlog_mutex.getLock();
+            _export_backlog.splice(_export_backlog.end(), busyClauses);
+        }
+        
+        // Also decrease backlog size by some amount, proportional to the batch
+        std::list<ProducedClauseCandidate> backlogSplice;
+        {
+            auto lock = _backlog_mutex.getLock();
+            if (!_export_backlog.empty()) {
+                size_t numSpliced = std::min(std::max(16ul, numClauses), _export_backlog.size());
+                backlogSplice.splice(backlogSplice.begin(), _export_backlog, 
+                    _export_backlog.begin(), std::next(_export_backlog.begin(), numSpliced)
+                );
             }
-
-            _filter.releaseLock();
-
-        } else {
-
-            // Filter busy: Append clause to backlog
+        }
+        if (backlogSplice.empty()) return;
+        for (auto it = backlogSplice.begin(); it != backlogSplice.end();) {
+            int clauseLength = it->size;
+            int producerId = it->producerId;
+            auto result = _filter.tryRegisterAndInsert(*it, _cdb, /*blocking=*/false);
+            if (result == ProducedClauseFilter::BUSY) {
+                ++it; // keep in backlog
+                continue;
+            }
+            handleResult(producerId, result, clauseLength);
+            it = backlogSplice.erase(it);
+        }
+        if (!backlogSplice.empty()) {
             auto lock = _backlog_mutex.getLock();
-            _export_backlog.emplace_back(begin, size, lbd, producerId, epoch);        
+            _export_backlog.splice(_export_backlog.begin(), backlogSplice);
         }
     }
 
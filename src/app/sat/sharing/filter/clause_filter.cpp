@@ -9,12 +9,46 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <algorithm>
 
 bool ClauseFilter::registerClause(const std::vector<int>& cls) {
 	return registerClause(cls.data(), cls.size());
 }
 
+size_t ClauseFilter::getNumBitsFor(size_t expectedNumClauses) {
+	return std::max(MIN_NUM_BITS, expectedNumClauses * BITS_PER_CLAUSE);
+}
+
+// Salts for deriving one bit position per word of a block from a single 32-bit hash
+// (cf. the "split block" Bloom filters of Apache Impala / Parquet)
+static constexpr uint32_t BLOCK_SALTS[AtomicBlockedBitset::WORDS_PER_BLOCK] = 
+	{0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+	0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+size_t ClauseFilter::getBlockIndexAndMask(size_t hash, AtomicBlockedBitset::Mask& mask) const {
+	
+	// Commutative hash, finalized (MurmurHash3 fmix64) to spread the bits evenly
+	uint64_t h = hash;
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdULL;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ULL;
+	h ^= h >> 33;
+	
+	// Upper 32 bits select the block, lower 32 bits select the bits within the block
+	size_t blockIdx = ((h >> 32) * _bitset.getNumBlocks()) >> 32;
+	uint32_t lower = (uint32_t) h;
+	for (size_t i = 0; i < AtomicBlockedBitset::WORDS_PER_BLOCK; i++) {
+		mask.words[i] = 1ULL << ((lower * BLOCK_SALTS[i]) >> 26);
+	}
+	return blockIdx;
+}
+
 bool ClauseFilter::registerClause(const int* begin, int size) {
+	return registerClause(begin, size, ClauseHasher::hash(begin, size, 3));
+}
+
+bool ClauseFilter::registerClause(const int*, int size, size_t hash) {
 
 	// Block clauses above maximum length
 	if (_max_clause_length > 0 && size > _max_clause_length) return false;
@@ -24,16 +58,24 @@ bool ClauseFilter::registerClause(const int* begin, int size) {
 	if (_clear.compare_exchange_weak(isClearSet, false, std::memory_order_relaxed))
 		clear();
 
-	// Check all four hash functions
-	bool admitted = false;
-	for (int i = 1; i <= 4; i++) {
-		size_t h = ClauseHasher::hash(begin, size, i) % NUM_BITS;
-		// If not yet admitted, check if the bit is unset
-		if (!admitted) admitted = !_bitset.test(h, std::memory_order_relaxed);
-		// If admitted, set the bit
-		if (admitted) _bitset.set(h, true, std::memory_order_relaxed);
-	}
-	return admitted;
+	AtomicBlockedBitset::Mask mask;
+	size_t blockIdx = getBlockIndexAndMask(hash, mask);
+
+	// All bits already set? -> Filter clause without writing to the block
+	if (_bitset.testMask(blockIdx, mask)) return false;
+
+	// Set missing bits; admitted if this call actually changed the block
+	return _bitset.setMask(blockIdx, mask);
+}
+
+bool ClauseFilter::contains(const int* begin, int size) const {
+	return contains(ClauseHasher::hash(begin, size, 3));
+}
+
+bool ClauseFilter::contains(size_t hash) const {
+	AtomicBlockedBitset::Mask mask;
+	size_t blockIdx = getBlockIndexAndMask(hash, mask);
+	return _bitset.testMask(blockIdx, mask);
 }
 
 void ClauseFilter::clear() {
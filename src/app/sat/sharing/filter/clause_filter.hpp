@@ -10,7 +10,7 @@ using namespace Mallob;
 
 #include "util/sys/threading.hpp"
 #include "util/logger.hpp"
-#include "util/atomic_bitset/atomic_bitset.hpp"
+#include "util/atomic_bitset/atomic_blocked_bitset.hpp"
 
 class ExactSortedClauseFilter {
 
@@ -75,61 +75,68 @@ struct ClauseComparator {
 };
 
 /*
-Comment D. Schreiber 09/2021
-
-In a Bloom filter, we use k distinct hash functions to set specific bits of a bitset of size m
-in order to "register" (query and insert) n elements.
-
-In our case, we set m=26843543 and k=4. Depending on the number n of inserted elements
-we get the following false positive probabilities:
-
-n		  	  p
-     1'000 	  4.92891e-16
-    10'000 	  4.91571e-12
-   100'000 	  4.78579e-08
-   500'000    2.65734e-05
- 1'000'000	  0.00036
-10'000'000 	  0.36010
-
-Generally: p = (1 - e^(-k*n/m))^k
-Source: https://en.wikipedia.org/wiki/Bloom_filter#Probability_of_false_positives
-
-For a low number of threads (1-16), the number of clauses exported within a second
-is not expected to surpass anything near a million, at which point an expected number 
-of 360 clauses would be spuriously discarded. At 500'000 clauses (still a high number)
-we expect a much lower number of 13 spuriously discarded clauses, and at below 300'000
-clauses we expect this for less than a single clause to occur. However, a high thoughput
-of clauses does imply that the clause filter needs to be cleaned up quite frequently
-or we otherwise need to put up with noticeable false positive rates.
-
-In addition, we can reduce the number of inserted clauses by only registering a learnt
-clause in a filter if there is (probably) still space for the clause in the database structure.
+The clause filter is a *blocked* Bloom filter. Each clause is mapped to a single
+512-bit block (one cache line) in which it sets one bit in each of the block's eight
+64-bit words (k=8). A query therefore costs a single cache miss instead of k of them,
+at the price of a slightly higher false positive rate than a classic Bloom filter
+of the same size m, where p = (1 - e^(-k*n/m))^k for n registered elements
+(see https://en.wikipedia.org/wiki/Bloom_filter#Probability_of_false_positives).
+
+The size m is derived from the expected number of clauses registered between two
+clean-ups (see getNumBitsFor), with BITS_PER_CLAUSE bits each. For BITS_PER_CLAUSE=16,
+the false positive rate stays around 0.1-0.2% as long as the expected number of clauses
+is not exceeded substantially. Beyond that, it grows quickly: a high throughput of clauses
+implies that the filter needs to be cleaned up frequently.
+
+If compiled with AVX2 support (-DMALLOB_USE_AVX2=1), a block is tested with two 256-bit
+operations instead of eight 64-bit ones.
 */
 
+// Former fixed size of the filter, now only used as the default size
 //#define NUM_BITS 268435399 // 32MB
 #define NUM_BITS 26843543 // 3,2MB
 
 class ClauseFilter {
 
+public:
+	// Number of filter bits reserved per expected registered clause
+	static constexpr size_t BITS_PER_CLAUSE = 16;
+	static constexpr size_t MIN_NUM_BITS = 1 << 16;
+
 private:
-	//std::bitset<NUM_BITS> _bitset;
-	AtomicBitset _bitset;
+	AtomicBlockedBitset _bitset;
 	int _max_clause_length = 0;
 	std::atomic_bool _clear{false};
 
 public:
-	ClauseFilter() : _bitset(NUM_BITS), _max_clause_length(0) {}
-	ClauseFilter(int maxClauseLen) : _bitset(NUM_BITS), _max_clause_length(maxClauseLen) {}
+	ClauseFilter() : _bitset(getNumBlocksFor(NUM_BITS)), _max_clause_length(0) {}
+	ClauseFilter(int maxClauseLen) : _bitset(getNumBlocksFor(NUM_BITS)), _max_clause_length(maxClauseLen) {}
+	ClauseFilter(size_t numBits, int maxClauseLen) : _bitset(getNumBlocksFor(numBits)), _max_clause_length(maxClauseLen) {}
 	ClauseFilter(const ClauseFilter& other) : _bitset(other._bitset), _max_clause_length(other._max_clause_length) {}
 	ClauseFilter(ClauseFilter&& other) : _bitset(std::move(other._bitset)), _max_clause_length(other._max_clause_length) {}
 	virtual ~ClauseFilter() {}
 
+	/**
+	 * Compute a suitable filter size for the given number of clauses
+	 * which are registered in the filter before it is cleared.
+	 */
+	static size_t getNumBitsFor(size_t expectedNumClauses);
+
 	/**
 	 * Return false if the given clause has already been registered
 	 * otherwise add it to the filter and return true.
 	 */
 	bool registerClause(const std::vector<int>& cls);
 	bool registerClause(const int* first, int size);
+	// Variant with a precomputed hash (Mallob::commutativeHash(.., 3)) of the clause.
+	bool registerClause(const int* first, int size, size_t hash);
+
+	/**
+	 * Return true iff the given clause has (probably) been registered before.
+	 * Does not modify the filter.
+	 */
+	bool contains(const int* first, int size) const;
+	bool contains(size_t hash) const;
 
 	/**
 	 * Clear the filter, i.e., return to its initial state.
@@ -139,4 +146,13 @@ public:
 	void setClear();
 
 	void clearHalf();
+
+	size_t getNumBits() const {return _bitset.size();}
+	size_t getNumBytes() const {return _bitset.size() / 8;}
+
+private:
+	static size_t getNumBlocksFor(size_t numBits) {
+		return (numBits + AtomicBlockedBitset::BITS_PER_BLOCK - 1) / AtomicBlockedBitset::BITS_PER_BLOCK;
+	}
+	size_t getBlockIndexAndMask(size_t hash, AtomicBlockedBitset::Mask& mask) const;
 };
@@ -0,0 +1,242 @@
+
+#pragma once
+
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <algorithm>
+#include <memory>
+
+#include "util/assert.hpp"
+
+// Hash table which maps (sorted) clauses to values of type V without any
+// per-clause heap allocations. Clauses are partitioned by their length into
+// size classes. For each size class, the entries are stored densely in an
+// arena of fixed-size records which hold the literals inline:
+//   [value | lit_1 ... lit_size]
+// The arena consists of small chunks (1 KiB). Chunks which are emptied when entries
+// are erased (i.e., at the garbage collection of an epoch) are kept for recycling
+// by subsequent insertions of any size class, up to a fraction of the chunks in use;
+// the arena never needs to be reallocated and copied as a whole.
+// The arena is indexed by an open-addressing table (linear probing) of 64-bit
+// slots, each of which holds a 32-bit fingerprint of the clause hash and the
+// position of the entry in the arena. The fingerprint is compared before the
+// arena record is touched, so an unsuccessful lookup usually incurs a single
+// cache miss and a successful one two.
+// The hash of a clause must be given by Hasher::hash(lits, size); it is supplied
+// by the caller for lookups and insertions and only recomputed when the index grows.
+template <typename V, typename Hasher>
+class InlineClauseTable {
+
+private:
+    static constexpr size_t VALUE_INTS = (sizeof(V) + sizeof(int) - 1) / sizeof(int);
+    static constexpr size_t INITIAL_CAPACITY = 64;
+    static constexpr uint64_t EMPTY = 0;
+    static constexpr size_t CHUNK_INTS = 1024 / sizeof(int);
+    // At most one chunk is kept for recycling per this many chunks in use
+    static constexpr size_t USED_CHUNKS_PER_FREE_CHUNK = 4;
+
+    typedef std::unique_ptr<int[]> Chunk;
+    struct SizeClass {
+        int clauseSize = 0;
+        size_t recordInts = 0;
+        size_t recordsPerChunk = 0;
+        size_t numEntries = 0;
+        std::vector<uint64_t> index; // capacity is a power of two (or zero)
+        std::vector<Chunk> chunks;
+    };
+    std::vector<SizeClass> _classes;
+    size_t _num_entries = 0;
+    size_t _num_used_chunks = 0;
+    // Chunks of CHUNK_INTS ints which are not in use
+    std::vector<Chunk> _free_chunks;
+    size_t _allocated_bytes = 0;
+
+public:
+    // Returns a pointer to the value associated with the provided clause,
+    // or nullptr if the clause is not contained. The literals must be sorted.
+    // The pointer is invalidated by any subsequent modification of the table.
+    V* find(const int* lits, int size, size_t hash) {
+        if (size >= (int)_classes.size()) return nullptr;
+        auto& sc = _classes[size];
+        if (sc.numEntries == 0) return nullptr;
+        uint64_t h = mix(hash);
+        uint32_t fp = getFingerprint(h);
+        size_t mask = sc.index.size()-1;
+        for (size_t idx = h & mask;; idx = (idx+1) & mask) {
+            uint64_t slot = sc.index[idx];
+            if (slot == EMPTY) return nullptr;
+            if ((uint32_t) (slot >> 32) != fp) continue;
+            int* record = getRecord(sc, getEntryIndex(slot));
+            if (memcmp(record+VALUE_INTS, lits, size*sizeof(int)) == 0)
+                return reinterpret_cast<V*>(record);
+        }
+    }
+
+    // Inserts the provided clause, which must not be contained yet, with the provided value.
+    // The literals must be sorted.
+    V* insert(const int* lits, int size, size_t hash, const V& value) {
+        auto& sc = getSizeClass(size);
+        if (4*(sc.numEntries+1) > 3*sc.index.size()) grow(sc);
+
+        // Append record to arena
+        size_t entryIdx = sc.numEntries;
+        if (entryIdx == sc.chunks.size() * sc.recordsPerChunk) sc.chunks.push_back(acquireChunk(sc));
+        int* record = getRecord(sc, entryIdx);
+        memcpy(record, &value, sizeof(V));
+        memcpy(record+VALUE_INTS, lits, size*sizeof(int));
+
+        // Index record
+        uint64_t h = mix(hash);
+        *findFreeSlot(sc, h) = toSlot(getFingerprint(h), entryIdx);
+        sc.numEntries++;
+        _num_entries++;
+        return reinterpret_cast<V*>(record);
+    }
+
+    // Removes all entries whose value satisfies the provided predicate.
+    // The surviving entries are compacted within each arena and re-indexed. Emptied
+    // chunks are recycled (or released), and memory of indices which became much
+    // too large is released. Returns the number of removed entries.
+    template <typename Predicate>
+    size_t eraseIf(Predicate pred) {
+        size_t numErased = 0;
+        for (auto& sc : _classes) {
+            if (sc.numEntries == 0) continue;
+            size_t numKept = 0;
+            for (size_t i = 0; i < sc.numEntries; i++) {
+                int* record = getRecord(sc, i);
+                if (pred(*reinterpret_cast<V*>(record))) continue;
+                if (numKept != i) memcpy(getRecord(sc, numKept), record, sc.recordInts*sizeof(int));
+                numKept++;
+            }
+            if (numKept == sc.numEntries) continue;
+            numErased += sc.numEntries - numKept;
+            sc.numEntries = numKept;
+            size_t numChunks = (numKept + sc.recordsPerChunk - 1) / sc.recordsPerChunk;
+            while (sc.chunks.size() > numChunks) {
+                releaseChunk(sc, std::move(sc.chunks.back()));
+                sc.chunks.pop_back();
+            }
+            // Smallest index capacity which respects the maximum load factor
+            size_t capacity = INITIAL_CAPACITY;
+            while (4*numKept > 3*capacity) capacity *= 2;
+            if (capacity < sc.index.size()) {
+                _allocated_bytes -= sc.index.capacity() * sizeof(uint64_t);
+                sc.index.assign(capacity, EMPTY);
+                sc.index.shrink_to_fit();
+                _allocated_bytes += sc.index.capacity() * sizeof(uint64_t);
+            }
+            reindex(sc);
+        }
+        _num_entries -= numErased;
+        size_t maxFreeChunks = _num_used_chunks / USED_CHUNKS_PER_FREE_CHUNK;
+        if (_free_chunks.size() > maxFreeChunks) {
+            _allocated_bytes -= (_free_chunks.size() - maxFreeChunks) * CHUNK_INTS * sizeof(int);
+            _free_chunks.resize(maxFreeChunks);
+            _free_chunks.shrink_to_fit();
+        }
+        return numErased;
+    }
+
+    // Calls f(lits, size, value) for each entry.
+    template <typename F>
+    void forEach(F f) const {
+        for (auto& sc : _classes) {
+            for (size_t i = 0; i < sc.numEntries; i++) {
+                const int* record = getRecord(sc, i);
+                f(record+VALUE_INTS, sc.clauseSize, *reinterpret_cast<const V*>(record));
+            }
+        }
+    }
+
+    size_t size() const {return _num_entries;}
+
+    // Number of bytes allocated for the index and the arena of all size classes,
+    // including the chunks kept for recycling.
+    size_t getAllocatedBytes() const {
+        return _allocated_bytes;
+    }
+
+private:
+    SizeClass& getSizeClass(int size) {
+        if (size >= (int)_classes.size()) _classes.resize(size+1);
+        auto& sc = _classes[size];
+        if (sc.recordInts == 0) {
+            sc.clauseSize = size;
+            sc.recordInts = VALUE_INTS + size;
+            sc.recordsPerChunk = std::max((size_t) 1, CHUNK_INTS / sc.recordInts);
+        }
+        return sc;
+    }
+
+    // (Only records of huge clauses exceed the regular chunk size)
+    static size_t getChunkInts(const SizeClass& sc) {
+        return std::max(CHUNK_INTS, sc.recordInts);
+    }
+    Chunk acquireChunk(const SizeClass& sc) {
+        _num_used_chunks++;
+        if (getChunkInts(sc) == CHUNK_INTS && !_free_chunks.empty()) {
+            Chunk chunk = std::move(_free_chunks.back());
+            _free_chunks.pop_back();
+            return chunk;
+        }
+        _allocated_bytes += getChunkInts(sc) * sizeof(int);
+        return Chunk(new int[getChunkInts(sc)]);
+    }
+    void releaseChunk(const SizeClass& sc, Chunk&& chunk) {
+        _num_used_chunks--;
+        if (getChunkInts(sc) == CHUNK_INTS) _free_chunks.push_back(std::move(chunk));
+        else _allocated_bytes -= getChunkInts(sc) * sizeof(int);
+    }
+
+    // The lower bits of the mixed hash select the home slot, the upper bits the fingerprint
+    static inline uint64_t mix(size_t hash) {
+        uint64_t h = hash;
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return h;
+    }
+    static inline uint32_t getFingerprint(uint64_t mixedHash) {
+        return (uint32_t) (mixedHash >> 32);
+    }
+    // An occupied slot is never EMPTY since the stored entry index is offset by one
+    static inline uint64_t toSlot(uint32_t fingerprint, size_t entryIdx) {
+        return (((uint64_t) fingerprint) << 32) | (uint64_t) (entryIdx+1);
+    }
+    static inline size_t getEntryIndex(uint64_t slot) {
+        return (size_t) (slot & 0xffffffffULL) - 1;
+    }
+    static inline int* getRecord(const SizeClass& sc, size_t entryIdx) {
+        return sc.chunks[entryIdx / sc.recordsPerChunk].get() + (entryIdx % sc.recordsPerChunk) * sc.recordInts;
+    }
+
+    uint64_t* findFreeSlot(SizeClass& sc, uint64_t mixedHash) {
+        size_t mask = sc.index.size()-1;
+        for (size_t idx = mixedHash & mask;; idx = (idx+1) & mask) {
+            if (sc.index[idx] == EMPTY) return &sc.index[idx];
+        }
+    }
+
+    void grow(SizeClass& sc) {
+        size_t newCapacity = sc.index.empty() ? INITIAL_CAPACITY : 2*sc.index.size();
+        _allocated_bytes -= sc.index.capacity() * sizeof(uint64_t);
+        sc.index.resize(newCapacity);
+        _allocated_bytes += sc.index.capacity() * sizeof(uint64_t);
+        reindex(sc);
+    }
+
+    void reindex(SizeClass& sc) {
+        std::fill(sc.index.begin(), sc.index.end(), EMPTY);
+        // Re-index all entries by scanning the arena sequentially
+        // (the hash is not stored and needs to be recomputed)
+        for (size_t i = 0; i < sc.numEntries; i++) {
+            const int* lits = getRecord(sc, i) + VALUE_INTS;
+            uint64_t h = mix(Hasher::hash(lits, sc.clauseSize));
+            *findFreeSlot(sc, h) = toSlot(getFingerprint(h), i);
+        }
+    }
+};
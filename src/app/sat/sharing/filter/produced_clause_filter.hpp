@@ -2,13 +2,19 @@
 #pragma once
 
 #include <array>
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <atomic>
 
 #include "util/tsl/robin_map.h"
 #include "../../data/produced_clause.hpp"
 #include "../../data/produced_clause_candidate.hpp"
 #include "util/sys/threading.hpp"
+#include "inline_clause_table.hpp"
+#include "clause_filter.hpp"
 
-// Packed struct to get in all meta data within a 32 bit integer.
+// Packed struct to get in all meta data within 64 bits.
 struct ClauseInfo {
  
     // Best LBD so far this clause was PRODUCED (+inserted into buffer) with
@@ -17,20 +23,32 @@ struct ClauseInfo {
     uint8_t minSharedLbd:5;
     // Bitset of which local solver(s) exported the clause 
     uint8_t producers:6;
-    // Epoch of last modification (production, or sharing:=true)
+    // Epoch of last sharing
     uint16_t lastSharedEpoch:16;
+    // Epoch of last production
+    uint16_t lastProducedEpoch:16;
 
     ClauseInfo() {
         minProducedLbd = 0;
         minSharedLbd = 0;
         producers = 0;
         lastSharedEpoch = 0;
+        lastProducedEpoch = 0;
     }
     ClauseInfo(const ProducedClauseCandidate& c) {
         minProducedLbd = c.lbd;
         minSharedLbd = 0;
         producers = 1 << c.producerId;
         lastSharedEpoch = 0;
+        lastProducedEpoch = c.epoch;
+    }
+
+    // Number of epochs since the clause was last produced or shared
+    // (epochs are stored modulo 2^16)
+    int getAge(int epoch) const {
+        int age = (uint16_t) (epoch - lastProducedEpoch);
+        if (minSharedLbd > 0) age = std::min(age, (int) (uint16_t) (epoch - lastSharedEpoch));
+        return age;
     }
 };
 
@@ -40,126 +58,333 @@ struct ClauseInfo {
 // subset of solvers should receive the clauses (because they did not export it themselves).
 // The structure takes space linear in the number of clauses successfully added to the
 // AdaptiveClauseDatabase instance which is used for tryRegisterAndInsert. 
+// The clauses are hash-partitioned into a number of shards, each of which is guarded
+// by its own mutex, so that concurrent accesses only contend if they hit the same shard.
+// (The literal budget of the AdaptiveClauseDatabase is maintained with atomics and
+// can therefore be shared by all shards without further locking.)
+// Entries which have neither been produced nor shared within the epoch horizon are
+// garbage collected incrementally, a few shards per epoch. If a memory limit is set
+// and exceeded, additional shards are swept with a successively shorter horizon, which
+// evicts the least recently used entries (at the granularity of epochs) first. This work
+// is bounded per epoch as well, so the limit may be exceeded for a few epochs.
+// The memory usage is tracked in an atomic counter which can be read without locking.
+// Optionally, a (blocked) Bloom filter over all registered clauses lets the lookups
+// of clauses which were never produced locally - the majority of incoming clauses -
+// skip the shard lock and the table. It is rebuilt after each full sweep of the shards;
+// lookups which overlap with a rebuild fall back to the shard's table.
 class ProducedClauseFilter {
 
 template <typename T>
 using ProducedMap = tsl::robin_map<T, ClauseInfo, ProducedClauseHasher<T>, ProducedClauseEqualsCommutative<T>>;
 
-private:
-    ProducedMap<ProducedUnitClause> _map_units;
-    ProducedMap<ProducedBinaryClause> _map_binaries;
-    ProducedMap<ProducedLargeClause> _map_large_clauses;
+struct LargeClauseHasher {
+    static inline size_t hash(const int* lits, int size) {
+        return Mallob::commutativeHash(lits, size, 3);
+    }
+};
+// Large clauses are stored inline (with sorted literals) in a specialized hash table
+// instead of in a map of heap-allocated ProducedLargeClause objects
+using LargeClauseTable = InlineClauseTable<ClauseInfo, LargeClauseHasher>;
 
-    Mutex _map_mutex;
+private:
+    struct Shard {
+        ProducedMap<ProducedUnitClause> mapUnits;
+        ProducedMap<ProducedBinaryClause> mapBinaries;
+        LargeClauseTable tableLargeClauses;
+        Mutex mtx;
+        size_t memoryBytes = 0; // last contribution to _memory_bytes
+    };
+    std::vector<Shard> _shards;
+    std::atomic<size_t> _memory_bytes {0};
 
     const int _epoch_horizon;
     const bool _reshare_improved_lbd;
+    const size_t _max_memory_bytes;
+
+    int _gc_cursor = 0;
+    // Under memory pressure, a full pass over the shards takes this many epochs
+    static constexpr int PRESSURE_SWEEP_EPOCHS = 4;
+    int _pressure_cursor = 0;
+    int _pressure_horizon = -1;
+    size_t _num_evicted = 0;
+
+    std::unique_ptr<ClauseFilter> _registered_clauses;
+    // Incremented before and after each rebuild of the Bloom filter (odd while rebuilding)
+    std::atomic_int _bloom_filter_version {0};
 
     ClauseInfo _empty_clause_info;
 
 public:
-    ProducedClauseFilter(int epochHorizon, bool reshareImprovedLbd) : 
-        _epoch_horizon(epochHorizon), _reshare_improved_lbd(reshareImprovedLbd) {}
+    // If bloomFilterBits > 0 (and the epoch horizon is not infinite), lookups are
+    // accelerated with a Bloom filter of this size (see ClauseFilter::getNumBitsFor),
+    // but of at most a quarter of the memory limit if there is one.
+    ProducedClauseFilter(int epochHorizon, bool reshareImprovedLbd, int numShards = 1, size_t maxMemoryBytes = 0, 
+            size_t bloomFilterBits = 0) : 
+        _shards(std::max(1, numShards)),
+        _epoch_horizon(epochHorizon), _reshare_improved_lbd(reshareImprovedLbd),
+        _max_memory_bytes(maxMemoryBytes) {
+        
+        if (maxMemoryBytes > 0) bloomFilterBits = std::min(bloomFilterBits, 8 * maxMemoryBytes / 4);
+        if (bloomFilterBits > 0 && epochHorizon >= 0)
+            _registered_clauses.reset(new ClauseFilter(bloomFilterBits, /*maxClauseLen=*/0));
+    }
+
+    enum ExportResult {ADMITTED, FILTERED, DROPPED, BUSY};
 
-    enum ExportResult {ADMITTED, FILTERED, DROPPED};
-    ExportResult tryRegisterAndInsert(ProducedClauseCandidate&& c, AdaptiveClauseDatabase& cdb) {
+    // Try to register the clause and, if it is not filtered, insert it into the provided database.
+    // If blocking is false and the according shard is currently locked, BUSY is returned
+    // and the candidate remains untouched.
+    ExportResult tryRegisterAndInsert(ProducedClauseCandidate& c, AdaptiveClauseDatabase& cdb, bool blocking = true) {
         
+        size_t hash = LargeClauseHasher::hash(c.begin, c.size);
+        auto& shard = getShard(hash);
+        if (blocking) shard.mtx.lock();
+        else if (!shard.mtx.tryLock()) return BUSY;
+
+        ExportResult result;
         if (c.size == 1) {
             ProducedUnitClause pc;
             pc.literal = *c.begin;
-            return tryRegisterAndInsert(pc, c, _map_units, cdb);
+            auto& map = shard.mapUnits;
+            result = tryRegisterAndInsert(find(map, pc), c, prod_cls::data(pc), cdb, [&]() {
+                map.insert({pc, ClauseInfo(c)});
+            });
 
         } else if (c.size == 2) {
             ProducedBinaryClause pc;
             pc.literals[0] = std::min(c.begin[0], c.begin[1]);
             pc.literals[1] = std::max(c.begin[0], c.begin[1]);
-            return tryRegisterAndInsert(pc, c, _map_binaries, cdb);
+            auto& map = shard.mapBinaries;
+            result = tryRegisterAndInsert(find(map, pc), c, prod_cls::data(pc), cdb, [&]() {
+                map.insert({pc, ClauseInfo(c)});
+            });
 
         } else {
-            ProducedLargeClause pc;
-            pc.size = c.size;
-            pc.data = c.releaseData();
-            return tryRegisterAndInsert(pc, c, _map_large_clauses, cdb);
+            std::sort(c.begin, c.begin+c.size);
+            auto& table = shard.tableLargeClauses;
+            result = tryRegisterAndInsert(table.find(c.begin, c.size, hash), c, c.begin, cdb, [&]() {
+                table.insert(c.begin, c.size, hash, ClauseInfo(c));
+            });
         }
+        if (result == ADMITTED) {
+            updateMemoryUsage(shard);
+            if (_registered_clauses) _registered_clauses->registerClause(c.begin, c.size, hash);
+        }
+
+        shard.mtx.unlock();
+        return result;
     }
 
-    template<typename T>
-    ExportResult tryRegisterAndInsert(T& pc, ProducedClauseCandidate& c, ProducedMap<T>& map, AdaptiveClauseDatabase& cdb) {
-        
-        // Try to find clause
+    uint8_t getProducers(Mallob::Clause& c) {
+        return getProducers(c, LargeClauseHasher::hash(c.begin, c.size));
+    }
+    // Variant with a precomputed hash (Mallob::commutativeHash(.., 3)) of the clause.
+    uint8_t getProducers(Mallob::Clause& c, size_t hash) {
+        if (!mayBeRegistered(hash)) return 0;
+        auto info = findAndLock(c, hash);
+        uint8_t producers = info.first == nullptr ? 0 : info.first->producers;
+        info.second->mtx.unlock();
+        return producers;
+    }
+
+    bool admitSharing(Mallob::Clause& c, int epoch) {
+        return admitSharing(c, LargeClauseHasher::hash(c.begin, c.size), epoch);
+    }
+    // Variant with a precomputed hash (Mallob::commutativeHash(.., 3)) of the clause.
+    bool admitSharing(Mallob::Clause& c, size_t hash, int epoch) {
+        // (a clause without an entry is admitted without any changes)
+        if (!mayBeRegistered(hash)) return true;
+        auto info = findAndLock(c, hash);
+        bool admitted = admitSharing(info.first, c.lbd, epoch);
+        info.second->mtx.unlock();
+        return admitted;
+    }
+
+    // To be called once per epoch. Removes entries which have not been produced or shared
+    // within the epoch horizon from a subset of the shards such that each shard is swept
+    // once per horizon. If the memory limit is exceeded, up to 1/PRESSURE_SWEEP_EPOCHS
+    // of the shards are swept in addition (until the limit is met) with a horizon which
+    // is halved after each full pass over the shards. Returns the number of evicted entries.
+    size_t collectGarbage(int epoch) {
+        size_t numEvicted = 0;
+        bool sweptAllShards = false;
+
+        if (_epoch_horizon >= 0) {
+            int numShardsToSweep = (_shards.size() + std::max(1, _epoch_horizon) - 1) / std::max(1, _epoch_horizon);
+            for (int i = 0; i < numShardsToSweep; i++) {
+                numEvicted += sweep(_shards[_gc_cursor], epoch, _epoch_horizon);
+                _gc_cursor = (_gc_cursor+1) % _shards.size();
+                if (_gc_cursor == 0) sweptAllShards = true;
+            }
+        }
+
+        if (_max_memory_bytes > 0 && getMemoryUsage() > _max_memory_bytes) {
+            // Memory pressure: shorten horizon until the limit is met
+            if (_pressure_horizon < 0) {
+                int horizon = _epoch_horizon >= 0 ? _epoch_horizon : std::numeric_limits<uint16_t>::max();
+                // (no entry is older than the number of epochs so far)
+                _pressure_horizon = std::min(horizon, std::max(0, epoch)) / 2;
+            }
+            int maxShardsToSweep = (_shards.size() + PRESSURE_SWEEP_EPOCHS - 1) / PRESSURE_SWEEP_EPOCHS;
+            for (int i = 0; i < maxShardsToSweep && getMemoryUsage() > _max_memory_bytes; i++) {
+                numEvicted += sweep(_shards[_pressure_cursor], epoch, _pressure_horizon);
+                _pressure_cursor = (_pressure_cursor+1) % _shards.size();
+                if (_pressure_cursor == 0) {
+                    sweptAllShards = true;
+                    _pressure_horizon /= 2;
+                }
+            }
+        } else _pressure_horizon = -1;
+
+        if (sweptAllShards && _registered_clauses) rebuildBloomFilter();
+
+        _num_evicted += numEvicted;
+        return numEvicted;
+    }
+
+    // Number of bytes allocated for the entries of all shards (approximate for the maps)
+    // and for the Bloom filter.
+    size_t getMemoryUsage() const {
+        return _memory_bytes.load(std::memory_order_relaxed)
+            + (_registered_clauses ? _registered_clauses->getNumBytes() : 0);
+    }
+
+    size_t getNumEvictedClauses() const {return _num_evicted;}
+
+    int getNumShards() const {return _shards.size();}
+
+private:
+    // False only if the clause with the provided hash is definitely not contained.
+    // A lookup which overlaps with a rebuild of the Bloom filter (seen via a changed
+    // or odd version) may have missed a cleared entry and is answered with true.
+    bool mayBeRegistered(size_t hash) const {
+        if (!_registered_clauses) return true;
+        int version = _bloom_filter_version.load(std::memory_order_acquire);
+        if (version % 2 == 1) return true;
+        bool contained = _registered_clauses->contains(hash);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return contained || _bloom_filter_version.load(std::memory_order_relaxed) != version;
+    }
+
+    // Re-registers exactly the present entries. Concurrent insertions are safe since
+    // each shard is re-registered under its lock only after the filter was cleared;
+    // concurrent lookups fall back to the tables (see mayBeRegistered).
+    void rebuildBloomFilter() {
+        _bloom_filter_version.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        _registered_clauses->clear();
+        for (auto& shard : _shards) {
+            auto lock = shard.mtx.getLock();
+            for (auto& [pc, info] : shard.mapUnits)
+                _registered_clauses->registerClause(&pc.literal, 1, LargeClauseHasher::hash(&pc.literal, 1));
+            for (auto& [pc, info] : shard.mapBinaries)
+                _registered_clauses->registerClause(pc.literals, 2, LargeClauseHasher::hash(pc.literals, 2));
+            shard.tableLargeClauses.forEach([&](const int* lits, int size, const ClauseInfo&) {
+                _registered_clauses->registerClause(lits, size, LargeClauseHasher::hash(lits, size));
+            });
+        }
+        _bloom_filter_version.fetch_add(1, std::memory_order_release);
+    }
+
+    inline Shard& getShard(size_t hash) {
+        // Same (commutative) hash as used within the maps, but the shard is selected
+        // via multiplicative hashing of its upper bits such that the shard index
+        // is independent of the bits which select a bucket within the shard's maps
+        return _shards[((hash * 0x9E3779B97F4A7C15ULL) >> 32) % _shards.size()];
+    }
+
+    // Removes all entries of the shard which are older than the provided horizon.
+    size_t sweep(Shard& shard, int epoch, int horizon) {
+        auto isOld = [&](const ClauseInfo& info) {return info.getAge(epoch) > horizon;};
+        auto lock = shard.mtx.getLock();
+        size_t numEvicted = eraseIf(shard.mapUnits, isOld) + eraseIf(shard.mapBinaries, isOld);
+        numEvicted += shard.tableLargeClauses.eraseIf(isOld);
+        updateMemoryUsage(shard);
+        return numEvicted;
+    }
+
+    // Accounts for the current size of the (locked) shard.
+    void updateMemoryUsage(Shard& shard) {
+        size_t bytes = shard.mapUnits.bucket_count() * (sizeof(ProducedUnitClause) + sizeof(ClauseInfo) + sizeof(size_t))
+            + shard.mapBinaries.bucket_count() * (sizeof(ProducedBinaryClause) + sizeof(ClauseInfo) + sizeof(size_t))
+            + shard.tableLargeClauses.getAllocatedBytes();
+        if (bytes == shard.memoryBytes) return;
+        // (wraps around correctly if the shard shrank)
+        _memory_bytes.fetch_add(bytes - shard.memoryBytes, std::memory_order_relaxed);
+        shard.memoryBytes = bytes;
+    }
+
+    template <typename T, typename Predicate>
+    size_t eraseIf(ProducedMap<T>& map, Predicate pred) {
+        size_t sizeBefore = map.size();
+        for (auto it = map.begin(); it != map.end();) {
+            if (pred(it->second)) it = map.erase(it);
+            else ++it;
+        }
+        size_t numErased = sizeBefore - map.size();
+        // Release memory of maps which became sparse
+        if (numErased > 0 && map.size() < map.bucket_count() / 8) map.rehash(0);
+        return numErased;
+    }
+
+    template <typename T>
+    inline ClauseInfo* find(ProducedMap<T>& map, const T& pc) {
         auto it = map.find(pc);
+        return it == map.end() ? nullptr : &it.value();
+    }
+
+    // Locks the clause's shard and returns the clause's meta data (or nullptr if not contained)
+    // together with the locked shard.
+    std::pair<ClauseInfo*, Shard*> findAndLock(const Mallob::Clause& c, size_t hash) {
+        auto& shard = getShard(hash);
+        shard.mtx.lock();
+        if (c.size == 1) {
+            ProducedUnitClause pc(c);
+            return {find(shard.mapUnits, pc), &shard};
+        }
+        if (c.size == 2) {
+            ProducedBinaryClause pc(c);
+            return {find(shard.mapBinaries, pc), &shard};
+        }
+        // Large clauses are stored with sorted literals; clauses from 
+        // clause buffers are usually sorted already
+        if (std::is_sorted(c.begin, c.begin+c.size))
+            return {shard.tableLargeClauses.find(c.begin, c.size, hash), &shard};
+        std::vector<int> sorted(c.begin, c.begin+c.size);
+        std::sort(sorted.begin(), sorted.end());
+        return {shard.tableLargeClauses.find(sorted.data(), c.size, hash), &shard};
+    }
+
+    template<typename Insert>
+    ExportResult tryRegisterAndInsert(ClauseInfo* info, ProducedClauseCandidate& c, 
+            int* lits, AdaptiveClauseDatabase& cdb, Insert insert) {
                 
         // If clause is contained:
-        bool contained = it != map.end();
+        bool contained = info != nullptr;
         if (contained) {
-            int oldLbd = it.value().minProducedLbd;
+            int oldLbd = info->minProducedLbd;
             // No improvement in LBD value? Filter clause.
             if (oldLbd > 0 && c.lbd >= oldLbd) {
-                updateClauseInfo(c, it.value(), /*updateLbd=*/false);
+                updateClauseInfo(c, *info, /*updateLbd=*/false);
                 return FILTERED;
             }
             // Clause can be accepted (again) due to improved LBD score
         }
 
         // Try to insert to sharing database
-        if (!cdb.addClause(prod_cls::data(pc), c.size, c.lbd, /*sortLargeClause=*/true)) {
+        if (!cdb.addClause(lits, c.size, c.lbd, /*sortLargeClause=*/true)) {
             // No space left in database: update meta data, drop clause
             // (Do not update LBD value because the clause was not exported)
-            if (contained) updateClauseInfo(c, it.value(), /*updateLbd=*/false);
+            if (contained) updateClauseInfo(c, *info, /*updateLbd=*/false);
             return DROPPED;
         }
 
         // Inserted: do register and set epoch to current epoch
-        if (contained) updateClauseInfo(c, it.value(), /*updateLbd=*/true);
-        else map.insert({std::move(pc), ClauseInfo(c)});
+        if (contained) updateClauseInfo(c, *info, /*updateLbd=*/true);
+        else insert();
         return ADMITTED;
     }
 
-    uint8_t getProducers(Mallob::Clause& c, int epoch) {
-
-        if (c.size == 1) {
-            ProducedUnitClause pc(c);
-            return getProducers(pc, _map_units, epoch);
-
-        } else if (c.size == 2) {
-            ProducedBinaryClause pc(c);
-            return getProducers(pc, _map_binaries, epoch);
-
-        } else {
-            ProducedLargeClause pc;
-            pc.size = c.size;
-            pc.data = c.begin;
-            auto info = getProducers(pc, _map_large_clauses, epoch);
-            pc.data = nullptr;
-            return info;
-        }
-    }
-
-    bool admitSharing(Mallob::Clause& c, int epoch) {
-
-        if (c.size == 1) {
-            ProducedUnitClause pc(c);
-            return admitSharing(pc, _map_units, c.lbd, epoch);
-
-        } else if (c.size == 2) {
-            ProducedBinaryClause pc(c);
-            return admitSharing(pc, _map_binaries, c.lbd, epoch);
-
-        } else {
-            ProducedLargeClause pc;
-            pc.data = c.begin;
-            pc.size = c.size;
-            bool admitted = admitSharing(pc, _map_large_clauses, c.lbd, epoch);
-            pc.data = nullptr; // avoid freeing of clause data reference
-            return admitted;
-        }
-    }
-
-    inline bool tryAcquireLock() {return _map_mutex.tryLock();}
-    inline void acquireLock() {_map_mutex.lock();}
-    inline void releaseLock() {_map_mutex.unlock();}
-
-private:
     void updateClauseInfo(const ProducedClauseCandidate& c, ClauseInfo& info, bool updateLbd) {
         assert(c.lbd > 0);
         if (updateLbd) {
@@ -170,16 +395,15 @@ private:
         }
         // Add producing solver as a producer
         info.producers |= (1 << c.producerId);
+        info.lastProducedEpoch = c.epoch;
     }
 
-    template <typename T>
-    inline bool admitSharing(const T& pc, ProducedMap<T>& map, int lbd, int epoch) {
+    inline bool admitSharing(ClauseInfo* infoPtr, int lbd, int epoch) {
         
-        auto it = map.find(pc);
-        if (it == map.end()) return true; // No entry? -> Admit trivially
+        if (infoPtr == nullptr) return true; // No entry? -> Admit trivially
         
         // There is a present entry for this clause
-        ClauseInfo& info = it.value();
+        ClauseInfo& info = *infoPtr;
         if (info.minSharedLbd > 0) {
             // Clause was shared before
             if (epoch - info.lastSharedEpoch <= _epoch_horizon) {
@@ -200,12 +424,4 @@ private:
         info.lastSharedEpoch = epoch;
         return true;
     }
-
-    template <typename T>
-    inline uint8_t getProducers(const T& pc, ProducedMap<T>& map, int epoch) {
-        auto it = map.find(pc);
-        if (it == map.end()) return 0;
-        ClauseInfo& info = it.value();
-        return info.producers;
-    }
 };
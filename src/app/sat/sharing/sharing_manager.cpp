@@ -6,6 +6,8 @@
  */
 
 #include <signal.h>
+#include <cstdio>
+#include <map>
 
 #include "util/assert.hpp"
 
@@ -13,6 +15,7 @@
 #include "util/sys/timer.hpp"
 #include "util/shuffle.hpp"
 #include "buffer/buffer_reducer.hpp"
+#include "util/sys/proc.hpp"
 
 SharingManager::SharingManager(
 		std::vector<std::shared_ptr<PortfolioSolverInterface>>& solvers, 
@@ -20,7 +23,13 @@ SharingManager::SharingManager(
 	: _solvers(solvers),
 	_max_deferred_lits_per_solver(maxDeferredLitsPerSolver), 
 	_params(params), _logger(logger), _job_index(jobIndex),
-	_filter(params.clauseFilterClearInterval(), params.reshareImprovedLbd()),
+	_filter(params.clauseFilterClearInterval(), params.reshareImprovedLbd(), 
+		/*numShards=*/4*std::max(1ul, solvers.size()),
+		/*maxMemoryBytes=*/((size_t) params.clauseFilterMemoryLimit()) * 1024*1024,
+		// entries are kept for up to two horizons (see collectGarbage), and about as many
+		// clauses as the export buffer holds literals are admitted per epoch at most
+		/*bloomFilterBits=*/ClauseFilter::getNumBitsFor(2 * std::max(1, (int) params.clauseFilterClearInterval())
+			* (size_t) params.clauseBufferBaseSize() * params.numChunksForExport())),
 	_cdb([&]() {
 		AdaptiveClauseDatabase::Setup setup;
 		setup.maxClauseLength = _params.strictClauseLengthLimit();
@@ -40,8 +49,22 @@ SharingManager::SharingManager(
 	_stats.histDeletedInSlots = &_cdb.getDeletedClausesHistogram();
 	_stats.histReturnedToDb = &_hist_returned_to_db;
 
+	if (params.retainedClauseLiterals() > 0 && !_solvers.empty() 
+			&& _solvers[0]->getSolverSetup().isJobIncremental) {
+		AdaptiveClauseDatabase::Setup setup;
+		setup.maxClauseLength = _params.strictClauseLengthLimit();
+		setup.maxLbdPartitionedSize = _params.maxLbdPartitioningSize();
+		setup.numLiterals = _params.retainedClauseLiterals();
+		_retained_cdb.reset(new AdaptiveClauseDatabase(setup));
+	}
+
 	auto callback = getCallback();
 	
+	// Solvers may be added later on: The solver threads must never
+	// observe a reallocation of the per-solver data
+	size_t maxNumSolvers = std::max(_solvers.size(), (size_t) params.numThreadsPerProcess());
+	_solver_revisions.reserve(maxNumSolvers);
+	_solver_stats.reserve(maxNumSolvers);
     for (size_t i = 0; i < _solvers.size(); i++) {
 		_solvers[i]->setExtLearnedClauseCallback(callback);
 		_solver_revisions.push_back(_solvers[i]->getSolverSetup().solverRevision);
@@ -49,7 +72,7 @@ SharingManager::SharingManager(
 	}
 }
 
-void SharingManager::onProduceClause(int solverId, int solverRevision, const Clause& clause, int condVarOrZero) {
+void SharingManager::onProduceClauses(int solverId, int solverRevision, std::vector<int>& batch, int condVarOrZero) {
 		
 	if (_solver_revisions[solverId] != solverRevision) return;
 
@@ -61,90 +84,79 @@ void SharingManager::onProduceClause(int solverId, int solverRevision, const Cla
 		}
 	}
 
-	auto clauseBegin = clause.begin;
-	auto clauseSize = clause.size;
-
-	// If necessary, apply a transformation to the clause:
+	// If necessary, apply a transformation to each clause:
 	// Add the supplied conditional variable in negated form to the clause.
 	// This effectively renders the found conflict relative to the assumptions
 	// which were added not as assumptions but as permanent unit clauses.
-	std::vector<int>* tldClauseVec = nullptr;
-	if (condVarOrZero != 0) {
-		tldClauseVec = new std::vector<int>(clause.size+1);
-		for (int i = 0; i < clause.size; i++) tldClauseVec->at(i) = clause.begin[i];
-		tldClauseVec->at(clause.size) = -condVarOrZero;
-		clauseBegin = tldClauseVec->data();
-		clauseSize++;
-
-		if (clauseSize > _params.strictClauseLengthLimit())
-			return;
-	}
+	std::vector<int> tldBatch;
+	if (condVarOrZero != 0) tldBatch.reserve(batch.size() + batch.size()/4);
+
+	// (The solver may be removed concurrently, which resets its statistics pointer)
+	SolverStatistics* solverStats = _solver_stats[solverId];
+	for (size_t pos = 0; pos < batch.size(); pos += 2+batch[pos]) {
+		int clauseSize = batch[pos];
+		int& clauseLbd = batch[pos+1];
+
+		if (clauseSize == 1) assert(clauseLbd == 1);
+		else {
+			assert(clauseLbd >= 1 || LOG_RETURN_FALSE("[ERROR] len=%i lbd=%i!\n", clauseSize, clauseLbd));
+			assert(clauseLbd <= clauseSize);
+		}
+		if (condVarOrZero != 0 && clauseSize+1 > _params.strictClauseLengthLimit()) continue;
 
-	/*
-	if (clauseSize == 1 && clause.lbd != 1) {
-		_logger.log(V1_WARN, "Observed unit LBD of %i\n", clause.lbd);
-	}
-	if (clauseSize > 1) {
-		_observed_nonunit_lbd_of_zero |= clause.lbd == 0;
-		_observed_nonunit_lbd_of_one |= clause.lbd == 1;
-		_observed_nonunit_lbd_of_two |= clause.lbd == 2;
-		_observed_nonunit_lbd_of_length_minus_one |= clause.lbd == clause.size-1;
-		_observed_nonunit_lbd_of_length |= clause.lbd == clause.size;
-	}
-	*/
+		// Add clause length to statistics
+		if (solverStats) {
+			solverStats->producedClauses++;
+			solverStats->histProduced->increment(clauseSize);
+		}
 
-	if (clauseSize == 1) assert(clause.lbd == 1);
-	else {
-		assert(clause.lbd >= 1 || LOG_RETURN_FALSE("[ERROR] len=%i lbd=%i!\n", clause.size, clause.lbd));
-		assert(clause.lbd <= clause.size);
-	}
-	int clauseLbd = clauseSize == 1 ? 1 : std::max(2, clause.lbd + (condVarOrZero == 0 ? 0 : 1));
-
-	// Add clause length to statistics
-	_hist_produced.increment(clauseSize);
-	auto& solverStats = _solver_stats[solverId];
-	if (solverStats) {
-		solverStats->producedClauses++;
-		solverStats->histProduced->increment(clause.size);
+		if (condVarOrZero == 0) {
+			clauseLbd = clauseSize == 1 ? 1 : std::max(2, clauseLbd);
+			_hist_produced.increment(clauseSize);
+			if (_retained_cdb && (clauseSize <= _params.qualityClauseLengthLimit() 
+					|| clauseLbd <= _params.qualityLbdLimit())) {
+				_retained_cdb->addClause(batch.data()+pos+2, clauseSize, clauseLbd);
+			}
+			continue;
+		}
+		tldBatch.push_back(clauseSize+1);
+		tldBatch.push_back(std::max(2, clauseLbd+1));
+		tldBatch.insert(tldBatch.end(), batch.begin()+pos+2, batch.begin()+pos+2+clauseSize);
+		tldBatch.push_back(-condVarOrZero);
+		_hist_produced.increment(clauseSize+1);
 	}
 
-	_export_buffer.produce(clauseBegin, clauseSize, clauseLbd, solverId, _internal_epoch);
-	//log(V6_DEBGV, "%i : PRODUCED %s\n", solverId, tldClause.toStr().c_str());
+	auto& clauses = condVarOrZero == 0 ? batch : tldBatch;
+	_export_buffer.produce(clauses.data(), clauses.size(), solverId, _internal_epoch);
+}
 
-	/*
-	auto result = _cdb.addClause(solverId, tldClause);
-
-	if (result == SUCCESS) {
-		_hist_admitted_to_db.increment(clauseSize);
-		if (solverStats) solverStats->producedClausesAdmitted++;
-	} else if (result == NO_BUDGET) {
-		// completely dropping the clause
-		_hist_dropped_before_db.increment(clauseSize);
-		_stats.clausesDroppedAtExport++;
-		if (solverStats) solverStats->producedClausesDropped++;
-	} else {
-		// duplicate
-		_hist_failed_filter.increment(clauseSize);
-		_stats.clausesProcessFilteredAtExport++;
-		if (solverStats) solverStats->producedClausesSolverFiltered++;
-	}
-	*/
+int SharingManager::prepareSharing(int* begin, int totalLiteralLimit) {
 
-	if (tldClauseVec) delete tldClauseVec;
+	auto buffer = prepareSharing(totalLiteralLimit);
+	//assert(buffer.size() <= maxSize);
+	memcpy(begin, buffer.data(), buffer.size()*sizeof(int));
+	return buffer.size();
 }
 
-int SharingManager::prepareSharing(int* begin, int totalLiteralLimit) {
+std::vector<int> SharingManager::prepareSharing(int totalLiteralLimit) {
+
+	// Let the solvers hand over their pending learned clauses soon, regardless
+	// of the size and age of their export batches
+	for (auto& solver : _solvers) solver->requestLearnedClauseFlush();
 
 	int numExportedClauses = 0;
 	auto buffer = _cdb.exportBuffer(totalLiteralLimit, numExportedClauses);
-	//assert(buffer.size() <= maxSize);
-	memcpy(begin, buffer.data(), buffer.size()*sizeof(int));
 
 	LOGGER(_logger, V5_DEBG, "prepared %i clauses, size %i\n", numExportedClauses, buffer.size());
 	_stats.exportedClauses += numExportedClauses;
 	_internal_epoch++;
 
-	return buffer.size();
+	// Forget clauses which are too old to be filtered anymore
+	_filter.collectGarbage(_internal_epoch);
+	_stats.filterMemoryBytes = _filter.getMemoryUsage();
+	_stats.filterEvictedClauses = _filter.getNumEvictedClauses();
+
+	return buffer;
 }
 
 void SharingManager::returnClauses(int* begin, int buflen) {
@@ -160,7 +172,7 @@ void SharingManager::returnClauses(int* begin, int buflen) {
 
 int SharingManager::filterSharing(int* begin, int buflen, int* filterOut) {
 
-	auto reader = _cdb.getBufferReader(begin, buflen);
+	auto reader = _cdb.getBufferReader(begin, buflen, /*useChecksums=*/false, /*computeHashes=*/true);
 	
 	constexpr auto bitsPerElem = 8*sizeof(int);
 	int shift = bitsPerElem;
@@ -169,7 +181,6 @@ int SharingManager::filterSharing(int* begin, int buflen, int* filterOut) {
 	int nbFiltered = 0;
 	int nbTotal = 0;
 
-	_filter.acquireLock();
 	while (clause.begin != nullptr) {
 		++nbTotal;
 
@@ -179,7 +190,7 @@ int SharingManager::filterSharing(int* begin, int buflen, int* filterOut) {
 			shift = 0;
 		}
 		
-		if (!_filter.admitSharing(clause, _internal_epoch)) {
+		if (!_filter.admitSharing(clause, reader.getCurrentClauseHash(), _internal_epoch)) {
 			// filtered!
 			auto bitFiltered = 1 << shift;
 			filterOut[filterPos] |= bitFiltered;
@@ -189,7 +200,6 @@ int SharingManager::filterSharing(int* begin, int buflen, int* filterOut) {
 		++shift;
 		clause = reader.getNextIncomingClause();
 	}
-	_filter.releaseLock();
 
 	_logger.log(V4_VVER, "filtered %i/%i\n", nbFiltered, nbTotal);
 	return filterPos+1;
@@ -235,6 +245,31 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 		});
 	}
 
+	// Each solver's clauses are allocated on the solver's NUMA node (if any),
+	// so the buffer is traversed once for the solvers of each node
+	std::map<int, std::vector<PortfolioSolverInterface*>> solversPerNode;
+	for (auto solver : importingSolvers) solversPerNode[solver->getSolverSetup().numaNode].push_back(solver);
+	if (solversPerNode.empty()) solversPerNode[-1]; // still traverse the clauses for the statistics
+	bool firstTraversal = true;
+	for (auto& [numaNode, solvers] : solversPerNode) {
+		if (numaNode >= 0) Proc::setPreferredNumaNodeOfThisThread(numaNode);
+		importClauses(begin, buflen, solvers, firstTraversal ? &hist : nullptr);
+		if (numaNode >= 0) Proc::setPreferredNumaNodeOfThisThread(-1);
+		firstTraversal = false;
+	}
+	
+	// Process-wide stats
+	time = Timer::elapsedSeconds() - time;
+	_logger.log(verb, "sharing time:%.4f adm:%i/%i %s\n", time, 
+		_last_num_admitted_cls_to_import, _last_num_cls_to_import, hist.getReport().c_str());
+}
+
+// Distributes the clauses of the given (filtered) buffer among the given solvers
+void SharingManager::importClauses(int* begin, int buflen, const std::vector<PortfolioSolverInterface*>& importingSolvers, 
+		ClauseHistogram* hist) {
+
+	int verb = _job_index == 0 ? V3_VERB : V5_DEBG;
+
 	// Prepare to traverse clauses not filtered yet
 	std::vector<std::forward_list<int>> unitLists(importingSolvers.size());
 	std::vector<std::forward_list<std::pair<int, int>>> binaryLists(importingSolvers.size());
@@ -242,7 +277,7 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 	std::vector<int> currentCapacities(importingSolvers.size(), -1);
 	std::vector<int> currentAddedLiterals(importingSolvers.size(), 0);
 
-	auto reader = _cdb.getBufferReader(begin, buflen);
+	auto reader = _cdb.getBufferReader(begin, buflen, /*useChecksums=*/false, /*computeHashes=*/true);
 	BufferIterator it(_params.strictClauseLengthLimit(), /*slotsForSumOfLengthAndLbd=*/false);
 	auto clause = reader.getNextIncomingClause();
 	bool explicitLbds = false;
@@ -277,7 +312,6 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 
 	// Traverse clauses
 	bool initialized = false;
-	_filter.acquireLock();
 
 	_logger.log(verb+2, "DG import\n");
 
@@ -286,7 +320,6 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 		if (!initialized || clause.size != it.clauseLength || clause.lbd != it.lbd) {
 			initialized = true;
 			float publishTime = Timer::elapsedSeconds();
-			_filter.releaseLock();
 
 			doPublishClauseLists();
 
@@ -300,13 +333,12 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 				currentAddedLiterals[i] = 0;
 			}
 
-			_filter.acquireLock();
 			publishTime = Timer::elapsedSeconds() - publishTime;
 			_logger.log(verb+2, "DG published clause lists (%.4f s)\n", publishTime);
 		}
 
-		hist.increment(clause.size);
-		uint8_t producers = _filter.getProducers(clause, _internal_epoch);
+		if (hist != nullptr) hist->increment(clause.size);
+		uint8_t producers = _filter.getProducers(clause, reader.getCurrentClauseHash());
 
 		for (size_t i = 0; i < importingSolvers.size(); i++) {
 			auto& solver = *importingSolvers[i];
@@ -316,6 +348,9 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 			if (currentCapacities[i] < clause.size) {
 				// No import budget left
 				solverStats->receivedClausesDropped++;
+				// (acceptance is only counted for clauses the solver did not produce itself,
+				// for digests with and without a global filter alike)
+				if ((producers & (1 << sid)) == 0) _import_acceptance.add(clause.size, clause.lbd, false);
 				continue;
 			}
 			uint8_t producerFlag = 1 << sid;
@@ -336,18 +371,13 @@ void SharingManager::digestSharingWithFilter(int* begin, int buflen, const int*
 				}
 				currentCapacities[i] -= clause.size;
 				currentAddedLiterals[i] += clause.size;
+				_import_acceptance.add(clause.size, clause.lbd, true);
 			}
 		}
 
 		clause = reader.getNextIncomingClause();
 	}
-	_filter.releaseLock();
 	doPublishClauseLists();
-	
-	// Process-wide stats
-	time = Timer::elapsedSeconds() - time;
-	_logger.log(verb, "sharing time:%.4f adm:%i/%i %s\n", time, 
-		_last_num_admitted_cls_to_import, _last_num_cls_to_import, hist.getReport().c_str());
 }
 
 void SharingManager::digestSharingWithoutFilter(int* begin, int buflen) {
@@ -379,4 +409,75 @@ void SharingManager::continueClauseImport(int solverId) {
 	_solver_stats[solverId] = &_solvers[solverId]->getSolverStatsRef();
 }
 
+void SharingManager::addSolver(int solverId) {
+	assert(solverId >= 0 && solverId < (int)_solvers.size());
+	assert(solverId <= (int)_solver_revisions.size());
+	if (solverId == (int)_solver_revisions.size()) {
+		assert(_solver_revisions.size() < _solver_revisions.capacity());
+		_solver_revisions.push_back(-1);
+		_solver_stats.push_back(nullptr);
+	}
+
+	// (Like any (re-)started solver, the new solver receives the retained clauses,
+	// if any, along with its formula and then the clauses of each sharing.)
+	continueClauseImport(solverId);
+}
+
+std::vector<int> SharingManager::getRetainedClauses() {
+	std::vector<int> clauses;
+	if (!_retained_cdb) return clauses;
+
+	// Export all retained clauses and put them back into the database afterwards
+	int numClauses = 0;
+	auto buffer = _retained_cdb->exportBuffer(-1, numClauses);
+	auto reader = _retained_cdb->getBufferReader(buffer.data(), buffer.size());
+	auto c = reader.getNextIncomingClause();
+	while (c.begin != nullptr) {
+		clauses.push_back(c.size);
+		clauses.push_back(c.lbd);
+		clauses.insert(clauses.end(), c.begin, c.begin+c.size);
+		_retained_cdb->addClause(c);
+		c = reader.getNextIncomingClause();
+	}
+	return clauses;
+}
+
+void SharingManager::addRetainedClauses(const std::vector<int>& clauses) {
+	if (!_retained_cdb) return;
+	for (size_t pos = 0; pos+1 < clauses.size(); pos += 2+clauses[pos]) {
+		// (stop at incomplete or malformed clauses)
+		if (clauses[pos] <= 0 || pos+2+clauses[pos] > clauses.size()) break;
+		_retained_cdb->addClause((int*) clauses.data()+pos+2, clauses[pos], clauses[pos+1]);
+	}
+}
+
+bool SharingManager::writeRetainedClauses(const std::string& filename) {
+	auto clauses = getRetainedClauses();
+	if (clauses.empty()) return false;
+	// Write to a temporary file and move it in place
+	FILE* f = fopen((filename + ".tmp").c_str(), "wb");
+	if (f == nullptr) return false;
+	size_t numWritten = fwrite(clauses.data(), sizeof(int), clauses.size(), f);
+	fclose(f);
+	if (numWritten != clauses.size() || std::rename((filename + ".tmp").c_str(), filename.c_str()) != 0) {
+		std::remove((filename + ".tmp").c_str());
+		return false;
+	}
+	_logger.log(V4_VVER, "wrote %lu retained literals\n", numWritten);
+	return true;
+}
+
+void SharingManager::readRetainedClauses(const std::string& filename) {
+	FILE* f = fopen(filename.c_str(), "rb");
+	if (f == nullptr) return;
+	std::vector<int> clauses;
+	int buf[4096];
+	size_t numRead;
+	while ((numRead = fread(buf, sizeof(int), 4096, f)) > 0) clauses.insert(clauses.end(), buf, buf+numRead);
+	fclose(f);
+	std::remove(filename.c_str());
+	addRetainedClauses(clauses);
+	_logger.log(V4_VVER, "read %lu retained literals\n", clauses.size());
+}
+
 SharingManager::~SharingManager() {}
@@ -11,6 +11,7 @@
 #include "filter/produced_clause_filter.hpp"
 #include "export_buffer.hpp"
 #include "../data/sharing_statistics.hpp"
+#include "../data/import_acceptance.hpp"
 
 #define CLAUSE_LEN_HIST_LENGTH 256
 
@@ -44,9 +45,14 @@ protected:
 	ProducedClauseFilter _filter;
 	AdaptiveClauseDatabase _cdb;
 	ExportBuffer _export_buffer;
+	// High-quality clauses produced without any conditional variable, i.e., implied by
+	// the permanent formula alone, for solvers which are (re-)started later on
+	std::unique_ptr<AdaptiveClauseDatabase> _retained_cdb;
 	
 	int _last_num_cls_to_import = 0;
 	int _last_num_admitted_cls_to_import = 0;
+	// (cumulative) acceptance of the clauses offered to the solvers
+	ImportAcceptance _import_acceptance;
 
 	ClauseHistogram _hist_produced;
 	ClauseHistogram _hist_returned_to_db;
@@ -71,6 +77,7 @@ public:
 	~SharingManager();
 
     int prepareSharing(int* begin, int totalLiteralLimit);
+	std::vector<int> prepareSharing(int totalLiteralLimit);
 	int filterSharing(int* begin, int buflen, int* filterOut);
 	void digestSharingWithFilter(int* begin, int buflen, const int* filter);
     void digestSharingWithoutFilter(int* begin, int buflen);
@@ -82,22 +89,36 @@ public:
 	void stopClauseImport(int solverId);
 
 	void continueClauseImport(int solverId);
+	// Begins clause import for a solver which was (re-)added at the given ID
+	// after sharing has begun.
+	void addSolver(int solverId);
+	// Returns the retained clauses (each as size, LBD, literals), which remain retained.
+	std::vector<int> getRetainedClauses();
+	// Adds clauses (each as size, LBD, literals) to the retained clauses.
+	void addRetainedClauses(const std::vector<int>& clauses);
+	// Writes the retained clauses to the given file / adds the clauses from the given
+	// file (if present) to the retained clauses and removes the file.
+	bool writeRetainedClauses(const std::string& filename);
+	void readRetainedClauses(const std::string& filename);
 	int getLastNumClausesToImport() const {return _last_num_cls_to_import;}
 	int getLastNumAdmittedClausesToImport() const {return _last_num_admitted_cls_to_import;}
+	const ImportAcceptance& getImportAcceptance() const {return _import_acceptance;}
 
 private:
 	
-	void onProduceClause(int solverId, int solverRevision, const Clause& clause, int condVarOrZero);
+	void onProduceClauses(int solverId, int solverRevision, std::vector<int>& batch, int condVarOrZero);
 
 	ExtLearnedClauseCallback getCallback() {
-		return [this](const Clause& c, int solverId, int solverRevision, int condVarOrZero) {
-			onProduceClause(solverId, solverRevision, c, condVarOrZero);
+		return [this](std::vector<int>& batch, int solverId, int solverRevision, int condVarOrZero) {
+			onProduceClauses(solverId, solverRevision, batch, condVarOrZero);
 		};
 	};
 
 	void tryReinsertDeferredClauses(int solverId, std::list<Clause>& clauses, SolverStatistics* stats);
 	void digestDeferredFutureClauses();
 
+	void importClauses(int* begin, int buflen, const std::vector<PortfolioSolverInterface*>& importingSolvers, 
+		ClauseHistogram* hist);
 	void importClausesToSolver(int solverId, const std::vector<Clause>& clauses, const std::vector<uint32_t>& producersPerClause);
 
 };
@@ -28,6 +28,10 @@ void Cadical::addLiteral(int lit) {
 	solver->add(lit);
 }
 
+void Cadical::addClauses(const int* lits, size_t numLits) {
+	for (size_t i = 0; i < numLits; i++) solver->add(lits[i]);
+}
+
 void Cadical::diversify(int seed) {
 
 	// Options may only be set in the initialization phase, so the seed cannot be re-set
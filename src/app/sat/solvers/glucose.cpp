@@ -49,6 +49,26 @@ void MGlucose::addLiteral(int lit) {
 	}
 }
 
+void MGlucose::addClauses(const int* lits, size_t numLits) {
+	// Incremental mode: variables must be frozen right when they are introduced
+	if (incremental) {
+		PortfolioSolverInterface::addClauses(lits, numLits);
+		return;
+	}
+	resetMaps();
+	nomodel = true;
+	for (size_t i = 0; i < numLits; i++) {
+		int lit = lits[i];
+		if (lit != 0) {
+			clause.push(encodeLit(lit));
+			maxvar = std::max(maxvar, abs(lit));
+		} else {
+			addClause(clause);
+			clause.clear();
+		}
+	}
+}
+
 /*
  * This method uses some of the diversification from SolverConfiguration::configureSAT14().
  */
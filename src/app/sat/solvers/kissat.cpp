@@ -34,6 +34,15 @@ void Kissat::addLiteral(int lit) {
     numVars = std::max(numVars, std::abs(lit));
 }
 
+void Kissat::addClauses(const int* lits, size_t numLits) {
+	int maxVar = numVars;
+	for (size_t i = 0; i < numLits; i++) {
+		kissat_add(solver, lits[i]);
+		maxVar = std::max(maxVar, std::abs(lits[i]));
+	}
+	numVars = maxVar;
+}
+
 void Kissat::diversify(int seed) {
 
     if (seedSet) return;
@@ -74,7 +83,12 @@ int Kissat::getNumOriginalDiversifications() {
 }
 
 void Kissat::setPhase(const int var, const bool phase) {
-    assert(!initialVariablePhasesLocked);
+    // Initial phases cannot be changed once solving has begun
+    if (initialVariablePhasesLocked) {
+        if (numIgnoredPhases++ == 0)
+            LOGGER(_logger, V4_VVER, "Ignoring phases set after solving has begun\n");
+        return;
+    }
 	if (var >= initialVariablePhases.size())
         initialVariablePhases.resize(var+1);
     initialVariablePhases[var] = phase ? 1 : -1;
@@ -25,6 +25,7 @@ private:
 
 	std::vector<signed char> initialVariablePhases;
 	bool initialVariablePhasesLocked = false;
+	int numIgnoredPhases = 0;
 
 
 public:
@@ -33,6 +34,7 @@ public:
 
 	// Add a (list of) permanent clause(s) to the formula
 	void addLiteral(int lit) override;
+	void addClauses(const int* lits, size_t numLits) override;
 
 	void diversify(int seed) override;
 	void setPhase(const int var, const bool phase) override;
@@ -103,6 +103,16 @@ void Lingeling::addLiteral(int lit) {
 	lgladd(solver, lit);
 }
 
+void Lingeling::addClauses(const int* lits, size_t numLits) {
+	int maxVar = maxvar;
+	for (size_t i = 0; i < numLits; i++) {
+		lgladd(solver, lits[i]);
+		maxVar = std::max(maxVar, std::abs(lits[i]));
+	}
+	// Freezing variables which occur later in the batch is fine
+	if (maxVar > maxvar) updateMaxVar(maxVar);
+}
+
 void Lingeling::updateMaxVar(int lit) {
 	lit = abs(lit);
 	assert(lit <= 134217723); // lingeling internal literal limit
@@ -145,6 +145,18 @@ void MergeSatBackend::addLiteral(int lit) {
 	}
 }
 
+void MergeSatBackend::addClauses(const int* lits, size_t numLits) {
+	auto lock = clauseAddingLock.getLock();
+	for (size_t i = 0; i < numLits; i++) {
+		if (lits[i] == 0) {
+			clausesToAdd.push_back(clauseToAdd);
+			clauseToAdd.clear();
+		} else {
+			clauseToAdd.push_back(lits[i]);
+		}
+	}
+}
+
 void MergeSatBackend::addLearnedClause(const Mallob::Clause& c) {
 	auto lock = clauseAddingLock.getLock();
 	(c.size == 1 ? clausesToAdd : learnedClausesToAdd).push_back(std::vector<int>(c.begin, c.begin+c.size));
@@ -69,12 +69,36 @@ void PortfolioSolverInterface::setTerminate() {
 }
 
 void PortfolioSolverInterface::setExtLearnedClauseCallback(const ExtLearnedClauseCallback& callback) {
-	setLearnedClauseCallback([callback, this](const Mallob::Clause& c, int solverId) {
+	_ext_learned_clause_callback = callback;
+	_export_batch.reserve(EXPORT_BATCH_MAX_INTS + 2 + _setup.strictClauseLengthLimit);
+	_time_of_last_export_flush = Timer::elapsedSeconds();
+	setLearnedClauseCallback([this](const Mallob::Clause& c, int) {
 		if (_terminated || _clause_sharing_disabled) return;
+		_export_batch.push_back(c.size);
+		_export_batch.push_back(c.lbd);
+		_export_batch.insert(_export_batch.end(), c.begin, c.begin+c.size);
+		if (_export_batch.size() >= EXPORT_BATCH_MAX_INTS
+				|| _export_flush_requested.load(std::memory_order_relaxed)) {
+			flushLearnedClauses();
+		} else if (++_clauses_since_export_age_check == EXPORT_BATCH_AGE_CHECK_INTERVAL) {
+			_clauses_since_export_age_check = 0;
+			if (Timer::elapsedSeconds() - _time_of_last_export_flush >= EXPORT_BATCH_MAX_AGE_SECONDS)
+				flushLearnedClauses();
+		}
+	});
+}
+
+void PortfolioSolverInterface::flushLearnedClauses() {
+	_export_flush_requested.store(false, std::memory_order_relaxed);
+	_clauses_since_export_age_check = 0;
+	_time_of_last_export_flush = Timer::elapsedSeconds();
+	if (_export_batch.empty()) return;
+	if (!_terminated && !_clause_sharing_disabled && _ext_learned_clause_callback) {
 		int condVar = _current_cond_var_or_zero;
 		assert(condVar >= 0);
-		callback(c, solverId, getSolverSetup().solverRevision, condVar);
-	});
+		_ext_learned_clause_callback(_export_batch, _local_id, getSolverSetup().solverRevision, condVar);
+	}
+	_export_batch.clear();
 }
 
 void PortfolioSolverInterface::addLearnedClause(const Mallob::Clause& c) {
@@ -22,7 +22,9 @@ enum SatResult {
 void updateTimer(std::string jobName);
 
 typedef std::function<void(const Mallob::Clause&, int)> LearnedClauseCallback;
-typedef std::function<void(const Mallob::Clause&, int, int, int)> ExtLearnedClauseCallback;
+// Receives a batch of learned clauses, each given as its size, its LBD, and its literals,
+// together with the solver's local ID, the solver's revision, and the conditional variable
+typedef std::function<void(std::vector<int>&, int, int, int)> ExtLearnedClauseCallback;
 
 /**
  * Interface for solvers that can be used in the portfolio.
@@ -64,6 +66,12 @@ public:
 	// Add a permanent literal to the formula (zero for clause separator)
 	virtual void addLiteral(int lit) = 0;
 
+	// Add a sequence of permanent literals to the formula (zero for clause separator).
+	// The last clause may be continued by the next call.
+	virtual void addClauses(const int* lits, size_t numLits) {
+		for (size_t i = 0; i < numLits; i++) addLiteral(lits[i]);
+	}
+
 	// Set a function that should be called for each learned clause
 	virtual void setLearnedClauseCallback(const LearnedClauseCallback& callback) = 0;
 
@@ -130,8 +138,18 @@ public:
 		}
 	}
 
-	void setCurrentCondVarOrZero(int condVarOrZero) {_current_cond_var_or_zero = condVarOrZero;}
+	void setCurrentCondVarOrZero(int condVarOrZero) {
+		// Clauses exported so far are relative to the former conditional variable
+		if (condVarOrZero != _current_cond_var_or_zero) flushLearnedClauses();
+		_current_cond_var_or_zero = condVarOrZero;
+	}
 	void setExtLearnedClauseCallback(const ExtLearnedClauseCallback& callback);
+	// Hand the learned clauses collected so far to the sharing layer.
+	// Must be called from the solver's thread.
+	void flushLearnedClauses();
+	// Let the solver's thread flush its learned clauses when it exports its next clause.
+	// Can be called from any thread.
+	void requestLearnedClauseFlush() {_export_flush_requested.store(true, std::memory_order_relaxed);}
 
 	void setCurrentRevision(int revision) {_current_revision = revision;}
 	int getCurrentRevision() const {return _current_revision;}
@@ -179,6 +197,18 @@ private:
 	std::atomic_int _current_revision = 0;
 	std::atomic_bool _terminated = false;
 
+	// Learned clauses are exported in batches which are flushed when they are
+	// large enough, old enough (checked every few clauses), or requested by the
+	// sharing layer. A batch is only accessed by the solver's thread.
+	static constexpr size_t EXPORT_BATCH_MAX_INTS = 4096;
+	static constexpr float EXPORT_BATCH_MAX_AGE_SECONDS = 0.01;
+	static constexpr int EXPORT_BATCH_AGE_CHECK_INTERVAL = 64;
+	ExtLearnedClauseCallback _ext_learned_clause_callback;
+	std::vector<int> _export_batch;
+	float _time_of_last_export_flush = 0;
+	int _clauses_since_export_age_check = 0;
+	std::atomic_bool _export_flush_requested = false;
+
 	SolverStatistics _stats;
 	ImportBuffer _import_buffer;
 };
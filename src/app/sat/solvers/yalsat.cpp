@@ -0,0 +1,155 @@
+
+#include <cmath>
+
+#include "yalsat.hpp"
+#include "util/sys/timer.hpp"
+
+extern "C" {
+	#include "yalsat/yals.h"
+}
+
+int yalsTerminate(void* state) {
+	return ((YalSAT*) state)->shouldTerminate() ? 1 : 0;
+}
+
+YalSAT::YalSAT(const SolverSetup& setup) : PortfolioSolverInterface(setup) {}
+
+void YalSAT::addLiteral(int lit) {
+	formula.push_back(lit);
+	numVars = std::max(numVars, std::abs(lit));
+}
+
+void YalSAT::addClauses(const int* lits, size_t numLits) {
+	formula.insert(formula.end(), lits, lits+numLits);
+	for (size_t i = 0; i < numLits; i++) numVars = std::max(numVars, std::abs(lits[i]));
+}
+
+void YalSAT::diversify(int seed) {
+	this->seed = seed;
+	// Vary the length of the first round (and thereby the restart schedule)
+	flipsPerRound <<= (getDiversificationIndex() % getNumOriginalDiversifications());
+	setClauseSharing(getNumOriginalDiversifications());
+}
+
+int YalSAT::getNumOriginalDiversifications() {
+	return 4;
+}
+
+void YalSAT::setPhase(const int var, const bool phase) {
+	// Phases are only a starting point which is forgotten once a better assignment is found
+	if (bestNumUnsatClauses >= 0) return;
+	if (var >= (int)bestAssignment.size()) bestAssignment.resize(var+1, 0);
+	bestAssignment[var] = phase ? var : -var;
+}
+
+// Solve the formula with a given set of assumptions
+// return 10 for SAT, 20 for UNSAT, 0 for UNKNOWN
+SatResult YalSAT::solve(size_t numAssumptions, const int* assumptions) {
+
+	// Local search cannot make use of assumptions
+	assert(numAssumptions == 0);
+
+	while (!shouldTerminate()) {
+
+		// Set up a fresh solver which starts from the best assignment so far
+		importClauses();
+		if (solver != nullptr) yals_del(solver);
+		solver = yals_new();
+		yals_srand(solver, seed + numRounds);
+		yals_setime(solver, getTime);
+		yals_seterm(solver, yalsTerminate, this);
+		yals_setflipslimit(solver, flipsPerRound);
+		for (int lit : formula) yals_add(solver, lit);
+		for (int lit : importedUnits) {
+			yals_add(solver, lit);
+			yals_add(solver, 0);
+		}
+		for (int var = 1; var < (int)bestAssignment.size() && var <= numVars; var++) {
+			if (bestAssignment[var] != 0) yals_setphase(solver, bestAssignment[var]);
+		}
+
+		int res = yals_sat(solver);
+		numRounds++;
+		numFlips += yals_flips(solver);
+		if (res == 20) return UNSAT; // formula (with imported units) is trivially unsatisfiable
+		if (res != 10 && interrupted) break;
+
+		// Remember the best assignment of this round if it is the best one overall
+		int numUnsatClauses = res == 10 ? 0 : yals_minimum(solver);
+		if (bestNumUnsatClauses < 0 || numUnsatClauses < bestNumUnsatClauses) {
+			bestNumUnsatClauses = numUnsatClauses;
+			bestAssignment.resize(numVars+1);
+			bestAssignment[0] = 0;
+			for (int var = 1; var <= numVars; var++) {
+				bestAssignment[var] = yals_deref(solver, var) > 0 ? var : -var;
+			}
+			LOGGER(_logger, V5_DEBG, "round %lu: %i unsat clauses\n", numRounds, numUnsatClauses);
+			if (phaseHints != nullptr) phaseHints->publish(std::vector<int>(bestAssignment), numUnsatClauses);
+		}
+		if (res == 10) return SAT;
+		flipsPerRound *= 2;
+	}
+	return UNKNOWN;
+}
+
+void YalSAT::importClauses() {
+	// Fix variables according to the imported unit clauses
+	auto units = fetchLearnedUnitClauses();
+	importedUnits.insert(importedUnits.end(), units.begin(), units.end());
+	// Local search cannot make use of longer clauses
+	Mallob::Clause c;
+	while (fetchLearnedClause(c, AdaptiveClauseDatabase::NONUNITS)) {}
+}
+
+void YalSAT::setSolverInterrupt() {
+	interrupted = true;
+}
+void YalSAT::unsetSolverInterrupt() {
+	interrupted = false;
+}
+void YalSAT::setSolverSuspend() {
+	suspended = true;
+}
+void YalSAT::unsetSolverSuspend() {
+	suspended = false;
+	suspendCond.notify();
+}
+
+bool YalSAT::shouldTerminate() {
+	if (suspended) {
+		// Stay inside this function call as long as solver is suspended
+		suspendCond.wait(suspendMutex, [this]{return !suspended;});
+	}
+	return interrupted;
+}
+
+std::vector<int> YalSAT::getSolution() {
+	assert(bestNumUnsatClauses == 0);
+	return bestAssignment;
+}
+
+std::set<int> YalSAT::getFailedAssumptions() {
+	return std::set<int>();
+}
+
+void YalSAT::setLearnedClauseCallback(const LearnedClauseCallback& callback) {
+	// Local search does not learn any clauses
+}
+
+int YalSAT::getVariablesCount() {
+	return numVars;
+}
+
+int YalSAT::getSplittingVariable() {
+	return 0;
+}
+
+void YalSAT::writeStatistics(SolverStatistics& stats) {
+	stats.decisions = numFlips;
+	stats.restarts = numRounds;
+	stats.imported = importedUnits.size();
+}
+
+YalSAT::~YalSAT() {
+	if (solver != nullptr) yals_del(solver);
+}
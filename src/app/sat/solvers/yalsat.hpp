@@ -0,0 +1,88 @@
+
+#pragma once
+
+#include <vector>
+
+#include "portfolio_solver_interface.hpp"
+#include "util/sys/threading.hpp"
+#include "util/logger.hpp"
+#include "../data/phase_hints.hpp"
+
+struct Yals;
+
+// Stochastic local search (YalSAT). The search proceeds in rounds of a growing
+// number of flips; each round restarts from the best assignment found so far and
+// fixes the unit clauses imported in the meantime. The search can only find models,
+// but its best assignments are published as phase hints for the other solvers.
+class YalSAT : public PortfolioSolverInterface {
+
+private:
+	Yals* solver = nullptr;
+	// The formula (and units) added so far, to be loaded into each round's solver
+	std::vector<int> formula;
+	std::vector<int> importedUnits;
+	int numVars = 0;
+
+	// best assignment found so far and its number of unsatisfied clauses
+	std::vector<int> bestAssignment;
+	int bestNumUnsatClauses = -1;
+	PhaseHints* phaseHints = nullptr;
+
+	unsigned long long seed = 0;
+	long long flipsPerRound = 100000;
+	unsigned long numRounds = 0;
+	unsigned long long numFlips = 0;
+
+	volatile bool interrupted = false;
+	volatile bool suspended = false;
+	Mutex suspendMutex;
+	ConditionVariable suspendCond;
+
+	friend int yalsTerminate(void* state);
+
+public:
+	YalSAT(const SolverSetup& setup);
+	 ~YalSAT() override;
+
+	// Add a (list of) permanent clause(s) to the formula
+	void addLiteral(int lit) override;
+	void addClauses(const int* lits, size_t numLits) override;
+
+	void diversify(int seed) override;
+	void setPhase(const int var, const bool phase) override;
+
+	// Solve the formula with a given set of assumptions
+	SatResult solve(size_t numAssumptions, const int* assumptions) override;
+
+	void setSolverInterrupt() override;
+	void unsetSolverInterrupt() override;
+	void setSolverSuspend() override;
+	void unsetSolverSuspend() override;
+
+	std::vector<int> getSolution() override;
+	std::set<int> getFailedAssumptions() override;
+
+	// Set a function that should be called for each learned clause
+	void setLearnedClauseCallback(const LearnedClauseCallback& callback) override;
+
+	// Get the number of variables of the formula
+	int getVariablesCount() override;
+
+	int getNumOriginalDiversifications() override;
+
+	// Get a variable suitable for search splitting
+	int getSplittingVariable() override;
+
+	// Get solver statistics
+	void writeStatistics(SolverStatistics& stats) override;
+
+	bool supportsIncrementalSat() override {return false;}
+	bool exportsConditionalClauses() override {return false;}
+
+	// Publish the best assignments found to the given hints
+	void setPhaseHints(PhaseHints* hints) {phaseHints = hints;}
+
+private:
+	void importClauses();
+	bool shouldTerminate();
+};
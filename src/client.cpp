@@ -506,21 +506,26 @@ void Client::handleSendJobResult(MessageHandle& handle) {
         std::stringstream modelString;
         int numAdded = 0;
         auto solSize = jobResult.getSolutionSize();
-        for (size_t x = 1; x < solSize; x++) {
-            if (numAdded == 0) {
-                modelString << "v ";
-            }
-            modelString << std::to_string(jobResult.getSolution(x)) << " ";
-            numAdded++;
-            bool done = x+1 == solSize;
-            if (numAdded == 20 || done) {
-                if (done) modelString << "0";
-                modelString << "\n";
-                modelStrings.push_back(modelString.str());
-                modelString = std::stringstream();
-                numAdded = 0;
+        size_t x = 0;
+        // Expand the (possibly compact) model chunk by chunk
+        jobResult.decodeSolution([&](const int* lits, size_t numLits) {
+            for (size_t i = 0; i < numLits; i++, x++) {
+                if (x == 0) continue; // position zero
+                if (numAdded == 0) {
+                    modelString << "v ";
+                }
+                modelString << std::to_string(lits[i]) << " ";
+                numAdded++;
+                bool done = x+1 == solSize;
+                if (numAdded == 20 || done) {
+                    if (done) modelString << "0";
+                    modelString << "\n";
+                    modelStrings.push_back(modelString.str());
+                    modelString = std::stringstream();
+                    numAdded = 0;
+                }
             }
-        }
+        });
     }
     if (_params.solutionToFile.isSet()) {
         std::ofstream file;
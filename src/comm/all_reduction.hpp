@@ -0,0 +1,78 @@
+
+#pragma once
+
+#include <list>
+#include <vector>
+#include <functional>
+
+#include "data/job_transfer.hpp"
+#include "comm/mympi.hpp"
+
+// Interface of an all-reduction among the nodes of a job. The participating nodes exchange
+// JobMessages with the MPI tags MSG_JOB_TREE_REDUCTION and MSG_JOB_TREE_BROADCAST, which
+// need to be handed to receive(). The contributed elements are combined with an associative
+// aggregator; how and in which order they are combined depends on the implementation.
+class AllReduction {
+
+public:
+    typedef std::vector<int> AllReduceElement;
+    typedef std::function<AllReduceElement(std::list<AllReduceElement>&)> Aggregator;
+    // Sends a message to the given rank with the given MPI tag
+    typedef std::function<void(int, int, JobMessage&)> Sender;
+
+protected:
+    JobMessage _base_msg;
+    AllReduceElement _neutral_elem;
+    Aggregator _aggregator;
+    Sender _sender = [](int rank, int tag, JobMessage& msg) {MyMpi::isend(rank, tag, msg);};
+
+public:
+    AllReduction(JobMessage baseMsg, AllReduceElement&& neutralElem, Aggregator aggregator) :
+        _base_msg(baseMsg), _neutral_elem(std::move(neutralElem)), _aggregator(aggregator) {}
+    virtual ~AllReduction() {}
+
+    // Replace the transport of messages (by default: MyMpi::isend),
+    // e.g., in order to simulate many nodes within a single process.
+    void setSender(Sender sender) {_sender = sender;}
+
+    const AllReduceElement& getNeutralElement() const {return _neutral_elem;}
+
+    // Set the function to compute the local contribution for the all-reduction.
+    // This function is invoked immediately
+    virtual void produce(std::function<AllReduceElement()> localProducer) = 0;
+
+    // Process an incoming message and advance the all-reduction accordingly.
+    // Returns false if the message does not belong to this all-reduction (any more).
+    virtual bool receive(int source, int tag, JobMessage& msg) = 0;
+
+    // Advances the all-reduction, e.g., because the local producer finished
+    // or the aggregation function finished. No-op if the result was already extracted.
+    virtual void advance() = 0;
+
+    // Leave the all-reduction, supplying the neutral element to all nodes which still await
+    // an element from this node.
+    virtual void cancel() = 0;
+
+    // Number of bytes currently held by the elements of this all-reduction.
+    // Elements under aggregation by another thread are not counted.
+    virtual size_t getMemoryFootprint() const = 0;
+
+    virtual bool hasProducer() const = 0;
+    virtual bool isAggregating() const = 0;
+    // Whether an aggregation was started whose result was not yet processed by advance().
+    virtual bool isAggregationPending() const = 0;
+    virtual bool isValid() const = 0;
+
+    // Whether the final result to the all-reduction is present.
+    virtual bool hasResult() const = 0;
+
+    // Extract the final result to the all-reduction. hasResult() must be true.
+    // After this call, hasResult() returns false.
+    virtual AllReduceElement extractResult() = 0;
+
+    // Whether this object can be destructed at this point in time
+    // without waiting for another thread.
+    virtual bool isDestructible() const = 0;
+
+    virtual void destroy() = 0;
+};
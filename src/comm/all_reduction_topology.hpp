@@ -0,0 +1,90 @@
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "app/job_tree.hpp"
+#include "comm/all_reduction.hpp"
+#include "comm/job_tree_all_reduction.hpp"
+#include "comm/butterfly_all_reduction.hpp"
+
+// Describes along which communication structure the nodes of a job perform an all-reduction:
+// the binary job tree itself, a k-ary tree, or butterfly exchanges. The latter two are defined
+// over a fixed list of the participating ranks (the position of a rank in the list takes the
+// role of its index), which the initiator of the all-reduction distributes to all participants.
+struct AllReductionTopology {
+
+    enum Type {JOB_TREE, KARY_TREE, BUTTERFLY};
+    Type type = JOB_TREE;
+    int fanIn = 2;
+    std::vector<int> ranks;
+    int myIndex = -1;
+
+    AllReductionTopology() = default;
+    AllReductionTopology(Type type, int fanIn, const std::vector<int>& ranks, int myRank) :
+            type(type), fanIn(fanIn), ranks(ranks) {
+        for (size_t i = 0; i < ranks.size(); i++) if (ranks[i] == myRank) myIndex = i;
+    }
+
+    static const char* getName(Type type) {
+        switch (type) {
+        case KARY_TREE: return "k-ary tree";
+        case BUTTERFLY: return "butterfly";
+        default: return "job tree";
+        }
+    }
+
+    // Serialization as [type, fan-in, rank of position 0, rank of position 1, ...]
+    std::vector<int> serialize() const {
+        if (type == JOB_TREE) return std::vector<int>();
+        std::vector<int> data {type, fanIn};
+        data.insert(data.end(), ranks.begin(), ranks.end());
+        return data;
+    }
+    static AllReductionTopology deserialize(const std::vector<int>& data, int myRank) {
+        if (data.size() < 2) return AllReductionTopology();
+        return AllReductionTopology((Type) data[0], data[1],
+            std::vector<int>(data.begin()+2, data.end()), myRank);
+    }
+
+    // Whether this node takes part in the all-reduction.
+    bool isParticipant() const {return type == JOB_TREE || myIndex >= 0;}
+
+    // Ranks to which this node forwards the initiation of an all-reduction
+    // (unless the topology is the job tree).
+    std::vector<int> getInitiationChildren() const {
+        std::vector<int> children;
+        if (type == KARY_TREE) {
+            for (int i = fanIn*myIndex+1; i <= fanIn*myIndex+fanIn && i < (int)ranks.size(); i++)
+                children.push_back(ranks[i]);
+        }
+        if (type == BUTTERFLY) {
+            // Binomial tree: position i forwards to i + 2^k for each 2^k > i
+            int offset = 1;
+            while (offset <= myIndex) offset *= 2;
+            for (; myIndex + offset < (int)ranks.size(); offset *= 2)
+                children.push_back(ranks[myIndex + offset]);
+        }
+        return children;
+    }
+
+    // Creates an all-reduction over this topology. For the job tree, the all-reduction may
+    // be restricted to the member ranks given by isMember (see JobTreeAllReduction).
+    std::unique_ptr<AllReduction> createAllReduction(JobTree& tree, JobMessage baseMsg,
+            AllReduction::AllReduceElement&& neutralElem, AllReduction::Aggregator aggregator,
+            std::function<bool(int)> isMember = std::function<bool(int)>()) const {
+
+        if (type == KARY_TREE) {
+            int parentRank = myIndex == 0 ? -1 : ranks[(myIndex-1) / fanIn];
+            return std::unique_ptr<AllReduction>(new JobTreeAllReduction(parentRank,
+                getInitiationChildren(), baseMsg, std::move(neutralElem), aggregator));
+        }
+        if (type == BUTTERFLY) {
+            return std::unique_ptr<AllReduction>(new ButterflyAllReduction(ranks, myIndex,
+                baseMsg, std::move(neutralElem), aggregator));
+        }
+        return std::unique_ptr<AllReduction>(new JobTreeAllReduction(tree, baseMsg,
+            std::move(neutralElem), aggregator, isMember));
+    }
+};
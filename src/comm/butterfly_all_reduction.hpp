@@ -0,0 +1,213 @@
+
+#pragma once
+
+#include <list>
+#include <optional>
+#include <future>
+
+#include "util/sys/thread_pool.hpp"
+#include "util/logger.hpp"
+#include "data/job_transfer.hpp"
+#include "comm/all_reduction.hpp"
+
+// All-reduction by recursive doubling ("butterfly"): in round r, the node at position i
+// exchanges its current element with the node at position i XOR 2^r and aggregates both,
+// so that all nodes obtain the result after log2(n) rounds instead of the 2*log2(n)
+// sequential hops of reducing up a tree and broadcasting back down. If n is no power of two,
+// each node at a position i >= p (p: largest power of two <= n) first folds its element into
+// the node at position i-p and later receives the final result from it.
+// Within each aggregation, the elements are ordered by the positions of their origins, so all
+// nodes compute the same result as long as no node leaves the all-reduction prematurely.
+class ButterflyAllReduction : public AllReduction {
+
+private:
+    struct Step {
+        int partnerRank;
+        int partnerIndex;
+        bool send; // send the current element to the partner
+        bool receive; // aggregate the partner's element with the current element
+        bool receiveResult; // the partner's element is the final result
+        std::optional<AllReduceElement> partnerElem;
+    };
+    std::vector<Step> _steps;
+    size_t _current_step = 0;
+    int _my_index;
+    // Node at position index + p to forward the final result to (or -1)
+    int _fold_partner_rank = -1;
+
+    std::optional<AllReduceElement> _current_elem;
+    std::list<AllReduceElement> _elems_to_aggregate;
+
+    bool _aggregating = false;
+    std::future<void> _future_aggregate;
+    std::optional<AllReduceElement> _aggregated_elem;
+
+    bool _has_producer = false;
+    bool _finished = false;
+    bool _valid = true;
+
+public:
+    // ranks: the world rank of each participating node by its position;
+    // myIndex: the position of this node.
+    ButterflyAllReduction(const std::vector<int>& ranks, int myIndex, JobMessage baseMsg,
+            AllReduceElement&& neutralElem, Aggregator aggregator) :
+        AllReduction(baseMsg, std::move(neutralElem), aggregator), _my_index(myIndex) {
+
+        int n = ranks.size();
+        assert(myIndex >= 0 && myIndex < n);
+        int p = 1;
+        while (2*p <= n) p *= 2;
+
+        if (myIndex >= p) {
+            _steps.push_back(Step{ranks[myIndex-p], myIndex-p, true, false, true, {}});
+            return;
+        }
+        if (myIndex + p < n) {
+            _steps.push_back(Step{ranks[myIndex+p], myIndex+p, false, true, false, {}});
+            _fold_partner_rank = ranks[myIndex+p];
+        }
+        for (int bit = 1; bit < p; bit *= 2) {
+            int partner = myIndex ^ bit;
+            _steps.push_back(Step{ranks[partner], partner, true, true, false, {}});
+        }
+    }
+
+    void produce(std::function<AllReduceElement()> localProducer) override {
+        assert(!_has_producer);
+        _has_producer = true;
+        _current_elem = localProducer();
+    }
+
+    bool receive(int source, int tag, JobMessage& msg) override {
+
+        assert(tag == MSG_JOB_TREE_REDUCTION || tag == MSG_JOB_TREE_BROADCAST);
+
+        bool accept = msg.jobId == _base_msg.jobId
+                    && msg.epoch == _base_msg.epoch
+                    && msg.revision == _base_msg.revision
+                    && msg.tag == _base_msg.tag;
+        if (!accept || _finished) return false;
+
+        // Find the (unfinished) step this message belongs to
+        for (size_t i = _current_step; i < _steps.size(); i++) {
+            auto& step = _steps[i];
+            if (step.partnerRank != source || step.partnerElem.has_value()) continue;
+            // (the final result may also arrive as a reduction message, namely
+            // the neutral element on behalf of a partner which left)
+            if (tag == MSG_JOB_TREE_BROADCAST ? !step.receiveResult : !(step.receive || step.receiveResult)) continue;
+            step.partnerElem = std::move(msg.payload);
+            advance();
+            return true;
+        }
+        return false;
+    }
+
+    void advance() override {
+
+        if (_finished) return;
+
+        if (_aggregating) return;
+        if (_future_aggregate.valid()) {
+            // Aggregation of the current step done
+            _future_aggregate.get();
+            _current_elem = std::move(_aggregated_elem);
+            _aggregated_elem.reset();
+            _current_step++;
+        }
+        if (!_current_elem.has_value()) return; // not produced yet
+
+        while (_current_step < _steps.size()) {
+            auto& step = _steps[_current_step];
+            if (step.send) {
+                _base_msg.payload = _current_elem.value();
+                _sender(step.partnerRank, MSG_JOB_TREE_REDUCTION, _base_msg);
+                _base_msg.payload.clear();
+                step.send = false;
+            }
+            if (!step.partnerElem.has_value()) {
+                if (step.receive || step.receiveResult) return; // wait for partner
+                _current_step++;
+                continue;
+            }
+            if (step.receiveResult) {
+                _current_elem = std::move(step.partnerElem);
+                _current_step++;
+                continue;
+            }
+            // Aggregate the partner's element, ordering both elements by their origin
+            _elems_to_aggregate.clear();
+            _elems_to_aggregate.push_back(std::move(_current_elem.value()));
+            if (step.partnerIndex < _my_index) _elems_to_aggregate.push_front(std::move(step.partnerElem.value()));
+            else _elems_to_aggregate.push_back(std::move(step.partnerElem.value()));
+            _current_elem.reset();
+            step.partnerElem.reset();
+            _aggregating = true;
+            _future_aggregate = ProcessWideThreadPool::get().addTask([&]() {
+                _aggregated_elem = _aggregator(_elems_to_aggregate);
+                _aggregating = false;
+            });
+            return;
+        }
+
+        // All steps done: forward the result to the folded-in node (if any)
+        _finished = true;
+        _base_msg.payload = std::move(_current_elem.value());
+        _current_elem.reset();
+        if (_fold_partner_rank >= 0)
+            _sender(_fold_partner_rank, MSG_JOB_TREE_BROADCAST, _base_msg);
+    }
+
+    void cancel() override {
+
+        if (_finished) return;
+
+        // Supply the neutral element to each partner which still awaits an element from this node
+        _base_msg.payload = _neutral_elem;
+        for (size_t i = _current_step; i < _steps.size(); i++) {
+            auto& step = _steps[i];
+            if (step.send) _sender(step.partnerRank, MSG_JOB_TREE_REDUCTION, _base_msg);
+        }
+        if (_fold_partner_rank >= 0)
+            _sender(_fold_partner_rank, MSG_JOB_TREE_BROADCAST, _base_msg);
+        _base_msg.payload.clear();
+        // finished but not valid
+        _finished = true;
+        _valid = false;
+    }
+
+    size_t getMemoryFootprint() const override {
+        if (_aggregating) return 0;
+        size_t numInts = _base_msg.payload.capacity();
+        if (_current_elem.has_value()) numInts += _current_elem.value().capacity();
+        for (auto& step : _steps) if (step.partnerElem.has_value())
+            numInts += step.partnerElem.value().capacity();
+        for (auto& elem : _elems_to_aggregate) numInts += elem.capacity();
+        if (_aggregated_elem.has_value()) numInts += _aggregated_elem.value().capacity();
+        return numInts * sizeof(int);
+    }
+
+    bool hasProducer() const override {return _has_producer;}
+    bool isAggregating() const override {return _aggregating;}
+    bool isAggregationPending() const override {return _future_aggregate.valid();}
+    bool isValid() const override {return _valid;}
+    bool hasResult() const override {return _finished && _valid;}
+
+    AllReduceElement extractResult() override {
+        assert(hasResult());
+        _valid = false;
+        return std::move(_base_msg.payload);
+    }
+
+    bool isDestructible() const override {
+        if (_future_aggregate.valid() && _aggregating) return false;
+        return true;
+    }
+
+    void destroy() override {
+        if (_future_aggregate.valid()) _future_aggregate.get();
+    }
+
+    ~ButterflyAllReduction() {
+        destroy();
+    }
+};
@@ -36,6 +36,9 @@ private:
     int _active_job_index = -1;
     float _last_contributed_criticality = 0;
 
+    // Host "color" of each rank (in MPI_COMM_WORLD) of the parent communicator
+    static inline robin_hood::unordered_map<int, int> _host_color_of_rank;
+
 public:
     HostComm(MPI_Comm parentComm, const Parameters& params) : _params(params), _parent_comm(parentComm) {}
     ~HostComm() {
@@ -86,12 +89,28 @@ public:
         // Create communicator using the minimum found rank as its "color"
         MPI_Comm_split(_parent_comm, color, MyMpi::rank(_parent_comm), &_comm);
 
+        // Make the colors of all ranks known to each rank
+        int myPair[2] = {MyMpi::rank(MPI_COMM_WORLD), color};
+        std::vector<int> pairs(2*MyMpi::size(_parent_comm));
+        MPI_Allgather(myPair, 2, MPI_INT, pairs.data(), 2, MPI_INT, _parent_comm);
+        for (size_t i = 0; i < pairs.size(); i += 2) _host_color_of_rank[pairs[i]] = pairs[i+1];
+
         LOG(V2_INFO, "Machine color %i with %i total workers (my rank: %i)\n", 
             color, MyMpi::size(_comm), MyMpi::rank(_comm));
         
         _sysstate = new SysState<4>(_comm, /*periodSeconds=*/1, SysState<4>::ALLGATHER);
     }
 
+    // Whether the two provided ranks (in MPI_COMM_WORLD) reside on the same host.
+    // Returns false if this is not known.
+    static bool isOnSameHost(int rank, int otherRank) {
+        auto it = _host_color_of_rank.find(rank);
+        if (it == _host_color_of_rank.end()) return false;
+        auto otherIt = _host_color_of_rank.find(otherRank);
+        if (otherIt == _host_color_of_rank.end()) return false;
+        return it->second == otherIt->second;
+    }
+
     void setRamUsageThisWorkerGbs(float ramGbs) {
         _ram_usage_this_worker_gb = ramGbs;
     }
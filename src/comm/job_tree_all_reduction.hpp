@@ -6,26 +6,24 @@
 #include "app/job_tree.hpp"
 #include "util/sys/thread_pool.hpp"
 #include "data/job_transfer.hpp"
+#include "comm/all_reduction.hpp"
 
-class JobTreeAllReduction {
-
-public:
-    typedef std::vector<int> AllReduceElement;
+// All-reduction which reduces the elements up a tree and broadcasts the result back down.
+// By default, the tree is the (binary) job tree; alternatively, the parent and the children
+// of this node can be specified explicitly, e.g., for a tree of a higher degree.
+class JobTreeAllReduction : public AllReduction {
 
 private:
-    JobTree& _tree;
-    JobMessage _base_msg;
-    AllReduceElement _neutral_elem;
+    int _parent_rank;
     
     std::optional<AllReduceElement> _local_elem;
     std::list<AllReduceElement> _child_elems;
     int _num_expected_child_elems;
-    IntPair _expected_child_ranks;
-    std::pair<bool, bool> _received_child_elems;
+    std::vector<int> _expected_child_ranks;
+    std::vector<bool> _received_child_elems;
 
     bool _aggregating = false;
     std::future<void> _future_aggregate;
-    std::function<AllReduceElement(std::list<AllReduceElement>&)> _aggregator;
     std::optional<AllReduceElement> _aggregated_elem;
 
     bool _has_transformation_at_root = false;
@@ -35,22 +33,39 @@ private:
     bool _reduction_locally_done = false;
     bool _finished = false;
     bool _valid = true;
+    bool _is_root;
 
 public:
+    // All-reduction along the job tree.
+    // If isMember is provided, the all-reduction only spans the connected part of the job tree
+    // around this node which consists of member ranks: children which are no members are
+    // ignored, and a node whose parent is no member acts as the root of the all-reduction.
     JobTreeAllReduction(JobTree& jobTree, JobMessage baseMsg, AllReduceElement&& neutralElem, 
-            std::function<AllReduceElement(std::list<AllReduceElement>&)> aggregator) :
-        _tree(jobTree), _base_msg(baseMsg), _neutral_elem(std::move(neutralElem)), 
-        _num_expected_child_elems(_tree.getNumChildren()), _aggregator(aggregator) {
-
-        int leftRank = _tree.hasLeftChild() ? _tree.getLeftChildNodeRank() : -1;
-        int rightRank = _tree.hasRightChild() ? _tree.getRightChildNodeRank() : -1;
-        _expected_child_ranks = IntPair(leftRank, rightRank);
-        _received_child_elems = std::pair<bool, bool>(false, false);
+            Aggregator aggregator, std::function<bool(int)> isMember = std::function<bool(int)>()) :
+        AllReduction(baseMsg, std::move(neutralElem), aggregator) {
+
+        int parentRank = jobTree.isRoot() ? -1 : jobTree.getParentNodeRank();
+        std::vector<int> childRanks;
+        if (jobTree.hasLeftChild()) childRanks.push_back(jobTree.getLeftChildNodeRank());
+        if (jobTree.hasRightChild()) childRanks.push_back(jobTree.getRightChildNodeRank());
+        if (isMember) {
+            if (parentRank >= 0 && !isMember(parentRank)) parentRank = -1;
+            for (auto& rank : childRanks) if (!isMember(rank)) rank = -1;
+        }
+        setNeighbors(parentRank, childRanks);
+    }
+
+    // All-reduction along an explicitly given tree: parentRank is -1 at the root,
+    // and children of rank -1 are ignored.
+    JobTreeAllReduction(int parentRank, const std::vector<int>& childRanks, JobMessage baseMsg, 
+            AllReduceElement&& neutralElem, Aggregator aggregator) :
+        AllReduction(baseMsg, std::move(neutralElem), aggregator) {
+        setNeighbors(parentRank, childRanks);
     }
 
     // Set the function to compute the local contribution for the all-reduction.
     // This function is invoked immediately
-    void produce(std::function<AllReduceElement()> localProducer) {
+    void produce(std::function<AllReduceElement()> localProducer) override {
         assert(!_has_producer);
         _has_producer = true;
         _local_elem = localProducer();
@@ -62,7 +77,7 @@ public:
     }
 
     // Process an incoming message and advance the all-reduction accordingly. 
-    bool receive(int source, int tag, JobMessage& msg) {
+    bool receive(int source, int tag, JobMessage& msg) override {
 
         assert(tag == MSG_JOB_TREE_REDUCTION || tag == MSG_JOB_TREE_BROADCAST);
 
@@ -78,15 +93,18 @@ public:
                 return false; // already internally aggregating elements (or already done)!
 
             // check if this message comes from a child which didn't already send something
-            bool fromLeftChild = !_received_child_elems.first && source == _expected_child_ranks.first;
-            bool fromRightChild = !_received_child_elems.second && source == _expected_child_ranks.second;
-            accept &= fromLeftChild || fromRightChild;
-            if (!accept) return false;
+            int childIdx = -1;
+            for (size_t i = 0; i < _expected_child_ranks.size(); i++) {
+                if (!_received_child_elems[i] && source == _expected_child_ranks[i]) {
+                    childIdx = i;
+                    break;
+                }
+            }
+            if (childIdx < 0) return false;
             
             // message accepted: store and check off
             _child_elems.push_back(std::move(msg.payload));
-            if (fromLeftChild) _received_child_elems.first = true;
-            if (fromRightChild) _received_child_elems.second = true;
+            _received_child_elems[childIdx] = true;
             LOG_ADD_SRC(V5_DEBG, "CS got %i/%i elems", source, _child_elems.size(), _num_expected_child_elems);
             advance();
         }
@@ -98,7 +116,7 @@ public:
 
     // Advances the all-reduction, e.g., because the local producer finished
     // or the aggregation function finished. No-op if getResult() was already called.
-    void advance() {
+    void advance() override {
 
         if (_finished) return;
 
@@ -120,7 +138,7 @@ public:
             _future_aggregate.get();
             _reduction_locally_done = true;
             
-            if (_tree.isRoot()) {
+            if (_is_root) {
                 // Transform reduced element at root
                 if (_has_transformation_at_root) {
                     _aggregated_elem.emplace(_transformation_at_root(_aggregated_elem.value()));
@@ -130,34 +148,48 @@ public:
             } else {
                 // Send to parent
                 _base_msg.payload = std::move(_aggregated_elem.value());
-                MyMpi::isend(_tree.getParentNodeRank(), MSG_JOB_TREE_REDUCTION, _base_msg);
+                _sender(_parent_rank, MSG_JOB_TREE_REDUCTION, _base_msg);
             }
         }
     }
 
-    void cancel() {
+    void cancel() override {
 
         if (_finished) return;
 
-        if (!_reduction_locally_done) {
+        if (!_reduction_locally_done && !_is_root) {
             // Aggregation upwards was not performed yet: Send neutral element upwards
             _base_msg.payload = _neutral_elem;
-            MyMpi::isend(_tree.getParentNodeRank(), MSG_JOB_TREE_REDUCTION, _base_msg);
+            _sender(_parent_rank, MSG_JOB_TREE_REDUCTION, _base_msg);
         }
         // finished but not valid
         _finished = true;
         _valid = false;
     }
 
-    bool hasProducer() const {return _has_producer;}
-    bool isValid() const {return _valid;}
+    // Number of bytes currently held by the elements of this all-reduction.
+    // Elements under aggregation by another thread are not counted.
+    size_t getMemoryFootprint() const override {
+        if (_aggregating) return 0;
+        size_t numInts = _base_msg.payload.capacity();
+        if (_local_elem.has_value()) numInts += _local_elem.value().capacity();
+        for (auto& elem : _child_elems) numInts += elem.capacity();
+        if (_aggregated_elem.has_value()) numInts += _aggregated_elem.value().capacity();
+        return numInts * sizeof(int);
+    }
+
+    bool hasProducer() const override {return _has_producer;}
+    bool isRoot() const {return _is_root;}
+    bool isAggregating() const override {return _aggregating;}
+    bool isAggregationPending() const override {return _future_aggregate.valid();}
+    bool isValid() const override {return _valid;}
 
     // Whether the final result to the all-reduction is present.
-    bool hasResult() const {return _finished && _valid;}
+    bool hasResult() const override {return _finished && _valid;}
     
     // Extract the final result to the all-reduction. hasResult() must be true.
     // After this call, hasResult() returns false.
-    AllReduceElement extractResult() {
+    AllReduceElement extractResult() override {
         assert(hasResult());
         _valid = false;
         return std::move(_base_msg.payload);
@@ -165,12 +197,12 @@ public:
 
     // Whether this object can be destructed at this point in time 
     // without waiting for another thread.
-    bool isDestructible() const {
+    bool isDestructible() const override {
         if (_future_aggregate.valid() && _aggregating) return false;
         return true;
     }
 
-    void destroy() {
+    void destroy() override {
         if (_future_aggregate.valid()) _future_aggregate.get();
     }
 
@@ -179,13 +211,19 @@ public:
     }
 
 private:
+    void setNeighbors(int parentRank, const std::vector<int>& childRanks) {
+        _parent_rank = parentRank;
+        _is_root = parentRank < 0;
+        for (int rank : childRanks) if (rank >= 0) _expected_child_ranks.push_back(rank);
+        _num_expected_child_elems = _expected_child_ranks.size();
+        _received_child_elems.assign(_expected_child_ranks.size(), false);
+    }
+
     void receiveAndForwardFinalElem(AllReduceElement&& elem) {
         _finished = true;
         _base_msg.payload = std::move(elem);
-        if (_expected_child_ranks.first >= 0) 
-            MyMpi::isend(_expected_child_ranks.first, MSG_JOB_TREE_BROADCAST, _base_msg);
-        if (_expected_child_ranks.second >= 0) 
-            MyMpi::isend(_expected_child_ranks.second, MSG_JOB_TREE_BROADCAST, _base_msg);
+        for (int rank : _expected_child_ranks)
+            _sender(rank, MSG_JOB_TREE_BROADCAST, _base_msg);
     }
 
 };
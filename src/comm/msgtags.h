@@ -160,6 +160,8 @@ const int MSG_ALLREDUCE_CLAUSES = 417;
 const int MSG_ALLREDUCE_FILTER = 418;
 const int MSG_AGGREGATE_RANKLIST = 419;
 const int MSG_BROADCAST_RANKLIST = 420; // blaze it
+const int MSG_INITIATE_HOST_CLAUSE_SHARING = 421;
+const int MSG_ALLREDUCE_HOST_CLAUSES = 422;
 
 
 
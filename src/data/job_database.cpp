@@ -9,6 +9,7 @@
 
 #include "app/sat/job/forked_sat_job.hpp"
 #include "app/sat/job/threaded_sat_job.hpp"
+#include "app/sat/job/sat_process_pool.hpp"
 #include "app/dummy/dummy_job.hpp"
 
 #include "util/sys/timer.hpp"
@@ -36,6 +37,10 @@ JobDatabase::JobDatabase(Parameters& params, MPI_Comm& comm, WorkerSysState& sys
         Proc::nameThisThread("JobJanitor");
         runJanitor();
     });
+
+    // Pre-start SAT processes for jobs to adopt
+    if (_params.applicationSpawnMode() == "fork" && _params.satProcessPoolSize() > 0)
+        SatProcessPool::init(_params);
 }
 
 Job& JobDatabase::createJob(int commSize, int worldRank, int jobId, JobDescription::Application application) {
@@ -740,6 +745,8 @@ JobDatabase::~JobDatabase() {
     watchdog.stop();
     _janitor.stop();
 
+    SatProcessPool::shutdown();
+
     DataStatistics stats(std::move(_desire_latencies));
     stats.computeStats();
     LOG(V3_VERB, "STATS treegrowth_latencies num:%ld min:%.6f max:%.6f med:%.6f mean:%.6f\n", 
@@ -46,6 +46,13 @@ JobResult& JobResult::deserialize(const std::vector<uint8_t>& packed) {
     n = sizeof(int); memcpy(&result, packed.data()+i, n); i += n;
     n = sizeof(int); memcpy(&revision, packed.data()+i, n); i += n;
     n = sizeof(EncodedType); memcpy(&encodedType, packed.data()+i, n); i += n;
+    if (encodedType == MODEL_BITS || encodedType == MODEL_RLE) {
+        // Expand compact model
+        JobResult res {std::vector<uint8_t>(packed)};
+        solution = res.extractSolution();
+        encodedType = INT;
+        return *this;
+    }
     n = packed.size()-i; solution.resize(n/sizeof(int));
     memcpy(solution.data(), packed.data()+i, n); i += n;
     return *this;
@@ -67,13 +74,146 @@ void JobResult::setSolutionToSerialize(const int* solutionPtr, size_t solutionSi
     n = solutionSize * sizeof(int); memcpy(packedData.data()+i, solutionPtr, n); i += n;
 }
 
+void JobResult::setModelToSerialize(const int* model, size_t size) {
+
+    // Is this a model, i.e., is each entry v either v or -v (and thus zero at position 0)?
+    // A zero at a later position is not part of a model: it would be decoded as -v.
+    // Count the runs of equal values on the way.
+    size_t rleSize = 0;
+    size_t runLength = 0;
+    bool runValue = false;
+    for (size_t v = 0; v < size; v++) {
+        if (model[v] != (int)v && model[v] != -(int)v) {
+            encodedType = INT;
+            setSolutionToSerialize(model, size);
+            return;
+        }
+        bool value = model[v] > 0;
+        if (value != runValue) {
+            for (size_t l = runLength; l >= 128; l >>= 7) rleSize++;
+            rleSize++;
+            runValue = value;
+            runLength = 0;
+        }
+        runLength++;
+    }
+    for (size_t l = runLength; l >= 128; l >>= 7) rleSize++;
+    rleSize++;
+
+    size_t numWords = (size+31) / 32;
+    encodedType = rleSize < numWords*sizeof(uint32_t) ? MODEL_RLE : MODEL_BITS;
+    packedData.resize(HEADER_SIZE + sizeof(int) + (encodedType == MODEL_RLE ? rleSize : numWords*sizeof(uint32_t)));
+
+    int i = 0, n;
+    int numLits = size;
+    n = sizeof(int); memcpy(packedData.data()+i, &id, n); i += n;
+    n = sizeof(int); memcpy(packedData.data()+i, &result, n); i += n;
+    n = sizeof(int); memcpy(packedData.data()+i, &revision, n); i += n;
+    n = sizeof(EncodedType); memcpy(packedData.data()+i, &encodedType, n); i += n;
+    n = sizeof(int); memcpy(packedData.data()+i, &numLits, n); i += n;
+
+    if (encodedType == MODEL_BITS) {
+        for (size_t w = 0; w < numWords; w++) {
+            uint32_t word = 0;
+            for (size_t v = 32*w; v < std::min(size, 32*(w+1)); v++) {
+                if (model[v] > 0) word |= 1u << (v%32);
+            }
+            memcpy(packedData.data()+i, &word, sizeof(uint32_t)); i += sizeof(uint32_t);
+        }
+        return;
+    }
+
+    // Variable-length run lengths: 7 bits per byte, high bit set if more bytes follow
+    auto writeRun = [&](size_t length) {
+        while (length >= 128) {
+            packedData[i++] = (uint8_t) (length & 127) | 128;
+            length >>= 7;
+        }
+        packedData[i++] = (uint8_t) length;
+    };
+    runLength = 0;
+    runValue = false;
+    for (size_t v = 0; v < size; v++) {
+        bool value = model[v] > 0;
+        if (value != runValue) {
+            writeRun(runLength);
+            runValue = value;
+            runLength = 0;
+        }
+        runLength++;
+    }
+    writeRun(runLength);
+    assert(i == packedData.size());
+}
+
 size_t JobResult::getSolutionSize() const {
     static_assert(sizeof(int) == sizeof(EncodedType));
+    if (!packedData.empty() && (encodedType == MODEL_BITS || encodedType == MODEL_RLE)) {
+        int numLits;
+        memcpy(&numLits, packedData.data()+HEADER_SIZE, sizeof(int));
+        return numLits;
+    }
     if (!packedData.empty()) return packedData.size()/sizeof(int) - 4;
     return solution.size();
 }
 
+void JobResult::decodeSolution(const std::function<void(const int*, size_t)>& onChunk, size_t chunkSize) const {
+
+    if (packedData.empty() || (encodedType != MODEL_BITS && encodedType != MODEL_RLE)) {
+        const int* data = packedData.empty() ? solution.data() : (const int*) (packedData.data() + HEADER_SIZE);
+        size_t size = getSolutionSize();
+        for (size_t pos = 0; pos < size; pos += chunkSize)
+            onChunk(data+pos, std::min(chunkSize, size-pos));
+        return;
+    }
+
+    size_t size = getSolutionSize();
+    std::vector<int> chunk;
+    chunk.reserve(std::min(chunkSize, size));
+    auto append = [&](int lit) {
+        chunk.push_back(lit);
+        if (chunk.size() == chunkSize) {
+            onChunk(chunk.data(), chunk.size());
+            chunk.clear();
+        }
+    };
+
+    const uint8_t* data = packedData.data() + HEADER_SIZE + sizeof(int);
+    if (encodedType == MODEL_BITS) {
+        for (size_t v = 0; v < size; v++) {
+            uint32_t word;
+            memcpy(&word, data + (v/32)*sizeof(uint32_t), sizeof(uint32_t));
+            append(((word >> (v%32)) & 1) ? (int)v : -(int)v);
+        }
+    } else {
+        size_t v = 0;
+        size_t i = 0;
+        bool value = false;
+        while (v < size) {
+            assert(i < packedData.size() - HEADER_SIZE - sizeof(int));
+            size_t length = 0;
+            int shift = 0;
+            while (data[i] & 128) {
+                length |= (size_t) (data[i++] & 127) << shift;
+                shift += 7;
+            }
+            length |= (size_t) data[i++] << shift;
+            for (size_t end = v+length; v < end; v++) append(value ? (int)v : -(int)v);
+            value = !value;
+        }
+    }
+    if (!chunk.empty()) onChunk(chunk.data(), chunk.size());
+}
+
 std::vector<int> JobResult::extractSolution() {
+    if (!packedData.empty() && (encodedType == MODEL_BITS || encodedType == MODEL_RLE)) {
+        std::vector<int> out;
+        out.reserve(getSolutionSize());
+        decodeSolution([&](const int* lits, size_t size) {
+            out.insert(out.end(), lits, lits+size);
+        });
+        return out;
+    }
     if (!packedData.empty()) {
         JobResult res; res.deserialize(packedData);
         return res.solution;
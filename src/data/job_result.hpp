@@ -5,6 +5,7 @@
 #include <memory>
 #include <vector>
 #include <cstring>
+#include <functional>
 
 #include "serializable.hpp"
 #include "util/assert.hpp"
@@ -14,12 +15,18 @@ struct JobResult : public Serializable {
     int id = 0;
     int revision;
     int result;
-    enum EncodedType {INT, FLOAT} encodedType = INT;
+    // INT, FLOAT: one 32-bit value per solution entry.
+    // MODEL_BITS: a SAT model (v or -v at position v) with one bit per variable.
+    // MODEL_RLE: a SAT model as the run lengths of its bit vector, alternating
+    // between false and true runs (starting with false), as variable-length integers.
+    enum EncodedType {INT, FLOAT, MODEL_BITS, MODEL_RLE} encodedType = INT;
 
 private:
     std::vector<int> solution;
     std::vector<uint8_t> packedData;
 
+    static constexpr size_t HEADER_SIZE = 3*sizeof(int) + sizeof(EncodedType);
+
 public:
     JobResult() {}
     JobResult(std::vector<uint8_t>&& packedData);
@@ -34,12 +41,22 @@ public:
 
     void setSolution(std::vector<int>&& solution);
     void setSolutionToSerialize(const int* begin, size_t size);
+    // Serializes a SAT model (v or -v at position v) with one bit per variable
+    // or, if smaller, run-length encoded. Falls back to INT for other solutions.
+    void setModelToSerialize(const int* begin, size_t size);
 
     size_t getSolutionSize() const;
+    // Random access is not supported for MODEL_RLE: use decodeSolution instead.
     inline int getSolution(size_t pos) const {
         assert(pos < getSolutionSize());
         static_assert(sizeof(int) == sizeof(EncodedType));
         if (!packedData.empty()) {
+            assert(encodedType != MODEL_RLE);
+            if (encodedType == MODEL_BITS) {
+                uint32_t word;
+                memcpy(&word, packedData.data() + HEADER_SIZE + sizeof(int) + (pos/32)*sizeof(uint32_t), sizeof(uint32_t));
+                return ((word >> (pos%32)) & 1) ? (int)pos : -(int)pos;
+            }
             return *(
                 (int*) (packedData.data() + (4+pos)*sizeof(int))
             );
@@ -47,6 +64,9 @@ public:
         return solution[pos];
     }
 
+    // Expands the solution in order into chunks of at most chunkSize values
+    // and calls the provided function for each chunk.
+    void decodeSolution(const std::function<void(const int*, size_t)>& onChunk, size_t chunkSize = 65536) const;
     std::vector<int> extractSolution();
 };
 
@@ -260,12 +260,11 @@ void JsonInterface::handleJobDone(JobResult&& result, const JobDescription::Stat
         mkfifo(solutionFile.c_str(), 0666);
     } else {
         auto solution = result.extractSolution();
-        if (result.encodedType == JobResult::INT) {
-            j["result"]["solution"] = std::move(solution);
-        }
         if (result.encodedType == JobResult::FLOAT) {
             // Convert result from integers to floats
             j["result"]["solution"] = intVecToFloatVec(solution);
+        } else {
+            j["result"]["solution"] = std::move(solution);
         }
     }
     j["stats"] = {
@@ -283,27 +282,30 @@ void JsonInterface::handleJobDone(JobResult&& result, const JobDescription::Stat
     // Send back feedback over whichever connection the job arrived
     img->feedback(j);
 
+    if (!img->incremental) {
+        _job_name_to_id_rev.erase(img->userQualifiedName);
+        _job_id_rev_to_image.erase(std::pair<int, int>(result.id, result.revision));
+        delete img;
+    }
+
     if (useSolutionFile) {
-        ProcessWideThreadPool::get().addTask([solutionFile, sol = result.extractSolution()]() {
+        // Keep the result in its compact form and expand it only while writing
+        ProcessWideThreadPool::get().addTask([solutionFile, result = std::move(result)]() {
             
             int fd = open(solutionFile.c_str(), O_WRONLY);
-            LOG(V4_VVER, "Writing solution: %i ints (%i,%i,...,%i,%i)\n", sol.size(), 
-                sol[0], sol[1], sol[sol.size()-2], sol[sol.size()-1]);
-            int numWritten = 0;
-
-            while (numWritten < sol.size()*sizeof(int)) {
-                int n = write(fd, ((char*)sol.data())+numWritten, 
-                    sol.size() * sizeof(int) - numWritten);
-                if (n < 0) break;
-                numWritten += n;
-            }
+            LOG(V4_VVER, "Writing solution: %lu ints\n", result.getSolutionSize());
+
+            bool error = false;
+            result.decodeSolution([&](const int* lits, size_t numLits) {
+                size_t numWritten = 0;
+                while (!error && numWritten < numLits*sizeof(int)) {
+                    int n = write(fd, ((char*)lits)+numWritten, 
+                        numLits * sizeof(int) - numWritten);
+                    if (n < 0) error = true;
+                    else numWritten += n;
+                }
+            });
             close(fd);
         });
     }
-
-    if (!img->incremental) {
-        _job_name_to_id_rev.erase(img->userQualifiedName);
-        _job_id_rev_to_image.erase(std::pair<int, int>(result.id, result.revision));
-        delete img;
-    }
 }
@@ -14,6 +14,7 @@ OptMap _map;
 //  TYPE  member name                    option ID (short, long)                      default (, min, max)     description
 
 OPT_BOOL(abortNonincrementalSubprocess,  "ans", "abort-noninc-subproc",               false,                   "Abort (hence restart) each sub-process which works (partially) non-incrementally upon the arrival of a new revision")
+OPT_BOOL(adaptSolverThreads,             "ast", "adapt-solver-threads",               false,                   "Adjust number of solver threads of the active job to the host's idle cores while solving")
 OPT_BOOL(collectClauseHistory,           "ch", "collect-clause-history",              false,                   "Employ clause history collection mechanism")
 OPT_BOOL(coloredOutput,                  "colors", "",                                false,                   "Colored terminal output based on messages' verbosity")
 OPT_BOOL(continuousGrowth,               "cg", "continuous-growth",                   true,                    "Continuous growth of job demands")
@@ -49,8 +50,13 @@ OPT_BOOL(zeroOnlyLogging,                "0o", "zero-only-logging",
 OPT_INT(activeJobsPerClient,             "ajpc", "active-jobs-per-client",            0,         0, LARGE_INT, "Make each client have up to this many active jobs at any given time")
 OPT_INT(bufferedImportedClsGenerations,  "bicg", "buffered-imported-cls-generations", 4,         1, LARGE_INT, "Number of subsequent full clause sharings to fit in each solver's import buffer")
 OPT_INT(clauseBufferBaseSize,            "cbbs", "clause-buffer-base-size",           1500,      0, MAX_INT,   "Clause buffer base size in integers")
+OPT_INT(clauseFilterMemoryLimit,         "cfml", "clause-filter-mem-limit",           0,         0, MAX_INT,   "Max. memory (in MB) of each process' filter of produced clauses; beyond it, least recently used clauses are evicted (0: no limit)")
 OPT_INT(clauseHistoryAggregationFactor,  "chaf", "clause-history-aggregation",        5,         1, LARGE_INT, "Aggregate historic clause batches by this factor")
 OPT_INT(clauseHistoryShortTermMemSize,   "chstms", "clause-history-shortterm-size",   10,        1, LARGE_INT, "Save this many \"full\" aggregated epochs until reducing them")
+OPT_INT(clauseSharingFanIn,              "csfi", "clause-sharing-fan-in",             4,         2, LARGE_INT, "Fan-in of the k-ary tree for clause sharing (-cst=1)")
+OPT_INT(clauseSharingTopology,           "cst", "clause-sharing-topology",            0,         0, 2,         "Collective operation for clause sharing in large jobs: 0=binary job tree, 1=k-ary tree, 2=butterfly (1 and 2 require -jcup > 0)")
+OPT_INT(clauseSharingTopologyMinVolume,  "cstmv", "clause-sharing-topology-min-volume", 512,     1, LARGE_INT, "Only use the collective operation of -cst for jobs of at least this volume")
+OPT_INT(cubeDepth,                       "cube", "cube-depth",                        0,         0, 16,        "Split the search space into 2^d cubes among the solver threads of each SAT process (not among processes), solved under assumptions by solvers supporting them (0: pure portfolio)")
 OPT_INT(firstApiIndex,                   "fapii", "first-api-index",                  0,    0, LARGE_INT,      "1st API index: with c clients, uses .api/jobs.{<index>..<index>+c-1}/ as directories")
 OPT_INT(hopsBetweenBfs,                  "hbbfs", "hops-between-bfs",                 10,   0, MAX_INT,        "After a job request hopped this many times after unsuccessful \"hill climbing\" BFS, perform another BFS")
 OPT_INT(hopsUntilBfs,                    "hubfs", "hops-until-bfs",                   LARGE_INT, 0, MAX_INT,   "After a job request hopped this many times, perform a \"hill climbing\" BFS")
@@ -62,6 +68,7 @@ OPT_INT(maxDemand,                       "md", "max-demand",
 OPT_INT(maxIdleDistance,                 "mid", "max-idle-distance",                  0,    0, LARGE_INT,      "Propagate idle distance of workers up to this limit through worker graph to weight randomness in request bouncing")
 OPT_INT(maxJobsPerStreamer,              "mjps", "max-jobs-per-streamer",             0,    0, LARGE_INT,      "Maximum number of jobs to introduce per streamer")
 OPT_INT(maxLbdPartitioningSize,          "mlbdps", "max-lbd-partition-size",          8,    1, LARGE_INT,      "Store clauses with up to this LBD in separate buckets")
+OPT_INT(maxSharingEpochsInFlight,        "msef", "max-sharing-epochs-in-flight",      1,    1, LARGE_INT,      "Max. number of clause sharing epochs of a job which may be in progress at the same time (1: no pipelining of epochs)")
 OPT_INT(messageBatchingThreshold,        "mbt", "message-batching-threshold",         1000000, 1000, MAX_INT,  "Employ batching of messages in batches of provided size")
 OPT_INT(minNumChunksForImportPerSolver,  "mcips", "min-import-chunks-per-solver",     10,   1, LARGE_INT,      "Min. number of cbbs-sized chunks for buffering produced clauses for export")
 OPT_INT(numBounceAlternatives,           "ba", "bounce-alternatives",                 4,    1, LARGE_INT,      "Number of bounce alternatives per PE (only relevant if -derandomize)")
@@ -69,10 +76,13 @@ OPT_INT(numChunksForExport,              "nce", "export-chunks",
 OPT_INT(numClients,                      "c", "clients",                              1,    -1, LARGE_INT,     "Number of client PEs to initialize (counting backwards from last rank), -1: all PEs are clients")
 OPT_INT(numJobs,                         "J", "jobs",                                 0,    0, LARGE_INT,      "Exit as soon as this number of jobs has been processed")
 OPT_INT(numThreadsPerProcess,            "t", "threads-per-process",                  1,    0, LARGE_INT,      "Number of worker threads per node")
+OPT_INT(numaMode,                        "numa", "numa-mode",                         0,    0, 2,              "NUMA placement of SAT solver threads and formula memory: 0 - none, 1 - spread each process's threads over all nodes and interleave its formula, 2 - place each process on a single node (by MPI rank, see -pph)")
 OPT_INT(maxLiteralsPerThread,            "mlpt", "max-lits-per-thread",               50000000, 0, MAX_INT,    "If formula is larger than threshold, reduce #threads per PE until #threads=1 or until limit is met \"on average\"")
 OPT_INT(processesPerHost,                "pph", "processes-per-host",                 0,    0, LARGE_INT,      "Tells Mallob how many MPI processes are executed on each physical host")
 OPT_INT(qualityClauseLengthLimit,        "qcll", "quality-clause-length-limit",       8,    0, LARGE_INT,      "Clauses up to this length are considered \"high quality\"")
 OPT_INT(qualityLbdLimit,                 "qlbdl", "quality-lbd-limit",                2,    0, LARGE_INT,      "Clauses with an LBD score up to this value are considered \"high quality\"")
+OPT_INT(retainedClauseLiterals,          "rcl", "retained-clause-literals",           0,    0, LARGE_INT,      "Max. number of literals of high-quality, assumption-free learned clauses which each SAT process of an incremental job retains and hands to each solver it (re-)starts (0: none)")
+OPT_INT(satProcessPoolSize,              "spps", "sat-process-pool-size",             0,    0, LARGE_INT,      "Number of pre-started idle SAT processes per worker which new jobs adopt instead of starting a process (with -appmode=fork)")
 OPT_INT(seed,                            "seed", "",                                  0,    0, MAX_INT,        "Random seed")
 OPT_INT(sleepMicrosecs,                  "sleep", "",                                 100,  0, LARGE_INT,      "Sleep this many microseconds between loop cycles of worker main thread")
 OPT_INT(strictClauseLengthLimit,         "scll", "strict-clause-length-limit",        30,   0, LARGE_INT,      "Only clauses up to this length will be shared")
@@ -82,6 +92,7 @@ OPT_INT(numWorkers,                      "w", "workers",
 OPT_INT(watchdogAbortMillis,             "wam", "watchdog-abort-millis",              10000, 1, MAX_INT,       "Interval (in milliseconds) after which an un-reset watchdog in a worker's main thread will invoke a crash")
 
 OPT_FLOAT(appCommPeriod,                 "s", "app-comm-period",                      1,    0, LARGE_INT,      "Do job-internal communication every t seconds") 
+OPT_FLOAT(appHostCommPeriod,             "hs", "app-host-comm-period",                0,    0, LARGE_INT,      "Share clauses among the co-located nodes of a job every t seconds; only one node per host then joins the job-wide sharing every -s seconds (0: no hierarchical sharing)")
 OPT_FLOAT(balancingPeriod,               "p", "balancing-period",                     0.1,  0, LARGE_INT,      "Minimum interval between subsequent rounds of balancing")
 OPT_FLOAT(clauseBufferDiscountFactor,    "cbdf", "clause-buffer-discount",            0.9,  0.5, 1,            "Clause buffer discount factor: reduce buffer size per PE by <factor> each depth")
 OPT_FLOAT(clauseFilterClearInterval,     "cfci", "clause-filter-clear-interval",      20,   -1, LARGE_INT,     "Set clear interval of clauses in solver filters (-1: never clear, 0: always clear")
@@ -92,7 +103,11 @@ OPT_FLOAT(jobCommUpdatePeriod,           "jcup", "job-comm-update-period",
 OPT_FLOAT(jobCpuLimit,                   "jcl", "job-cpu-limit",                      0,    0, LARGE_INT,      "Timeout an instance after x cpu seconds")
 OPT_FLOAT(jobWallclockLimit,             "jwl", "job-wallclock-limit",                0,    0, LARGE_INT,      "Timeout an instance after x seconds wall clock time")
 OPT_FLOAT(loadFactor,                    "l", "load-factor",                          1,    0, 1,              "Load factor to be aimed at")
+OPT_FLOAT(phaseHintsPeriod,              "php", "phase-hints-period",                 5,    0, LARGE_INT,      "Interrupt CDCL solvers (which support repeated solving) at most every t seconds to apply improved phases from local search (0: only apply them at new solving attempts)")
+OPT_FLOAT(portfolioTunerPeriod,          "ptp", "portfolio-tuner-period",             10,   1, LARGE_INT,      "Reward the configurations of the SAT solvers and restart the worst solver every t seconds (with -ptf)")
 OPT_FLOAT(requestTimeout,                "rto", "request-timeout",                    0,    0, LARGE_INT,      "Request timeout: discard non-root job requests when older than this many seconds")
+OPT_FLOAT(sharingAcceptanceTarget,       "sact", "sharing-acceptance-target",         0,    0, 1,              "Adapt the clause sharing volume and the admitted clause lengths of each job such that its solvers have the import budget to accept this share of the clauses offered to them (0: no adaptation)")
+OPT_FLOAT(sharingVolumeMaxAdjustment,    "svma", "sharing-volume-max-adjustment",     4,    1, LARGE_INT,      "Adapt the clause sharing volume of a job by at most this factor in either direction (with -sact)")
 OPT_FLOAT(sysstatePeriod,                "y", "sysstate-period",                      1,    0.1, 50,           "Period for aggregating and logging global system state")
 OPT_FLOAT(timeLimit,                     "T", "time-limit",                           0,    0, LARGE_INT,      "Run entire system for at most this many seconds")
 
@@ -104,7 +119,9 @@ OPT_STRING(jobDescriptionTemplate,       "job-desc-template", "",
 OPT_STRING(jobTemplate,                  "job-template", "",                          "",                      "JSON template file which each client uses to instantiate jobs indeterminately")
 OPT_STRING(logDirectory,                 "log", "log-directory",                      "",                      "Directory to save logs in")
 OPT_STRING(monoFilename,                 "mono", "",                                  "",                      "Mono instance: Solve the provided CNF instance with full power, then exit")
-OPT_STRING(satSolverSequence,            "satsolver",  "",                            "L",                     "Sequence of SAT solvers to cycle through (capital letter for true incremental solver, lowercase for pseudo-incremental solving): L|l:Lingeling C|c:CaDiCaL G|g:Glucose k:Kissat m:MergeSAT")
+OPT_STRING(portfolioTunerFile,           "ptf", "portfolio-tuner-file",               "",                      "File in which to keep the statistics of the online selection of SAT solver configurations per formula family (app config key \"family\"); empty: no online selection")
+OPT_STRING(satProcessPoolSlot,           "spslot", "",                                "",                      "Shared memory slot of a pre-started SAT process [internal option, do not use]")
+OPT_STRING(satSolverSequence,            "satsolver",  "",                            "L",                     "Sequence of SAT solvers to cycle through (capital letter for true incremental solver, lowercase for pseudo-incremental solving): L|l:Lingeling C|c:CaDiCaL G|g:Glucose k:Kissat m:MergeSAT y:YalSAT (local search)")
 OPT_STRING(solutionToFile,               "s2f", "solution-to-file",                   "",                      "Write solutions to file with provided base name + job ID")
 OPT_STRING(subprocessPrefix,             "subproc-prefix", "",                        "",                      "Execute SAT subprocess with this prefix (e.g., \"valgrind\")")
 OPT_STRING(traceDirectory,               "trace-dir", "",                             ".",                     "Directory to write thread trace files to")
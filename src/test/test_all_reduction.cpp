@@ -0,0 +1,182 @@
+
+#include <iostream>
+#include "util/assert.hpp"
+#include <vector>
+#include <string>
+#include <list>
+#include <memory>
+#include <set>
+#include <thread>
+
+#include "util/sys/thread_pool.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "comm/mympi.hpp"
+#include "comm/all_reduction_topology.hpp"
+#include "app/sat/sharing/buffer/adaptive_clause_database.hpp"
+#include "app/sat/sharing/buffer/buffer_merger.hpp"
+
+// Simulates clause sharing all-reductions among N nodes within this process:
+// messages are queued and delivered by the simulation instead of MPI. Each message
+// takes one time unit ("hop") and messages are delivered in the order of their arrival
+// times, so the reported number of hops is the latency of the all-reduction.
+
+const int BASE_SIZE = 500;
+const float DISCOUNT = 0.9;
+
+AdaptiveClauseDatabase::Setup getSetup() {
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 30;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 100000;
+    return setup;
+}
+
+std::vector<int> getClauseBuffer() {
+    AdaptiveClauseDatabase cdb(getSetup());
+    for (int i = 0; i < 200; i++) {
+        int size = 1 + (int) (Random::rand()*30);
+        std::vector<int> lits;
+        for (int j = 0; j < size; j++) {
+            int lit = 1 + (int) (Random::rand()*1000000);
+            lits.push_back(Random::rand() < 0.5 ? -lit : lit);
+        }
+        std::sort(lits.begin(), lits.end());
+        cdb.addClause(lits.data(), size, size == 1 ? 1 : 2);
+    }
+    int numExported;
+    auto buf = cdb.exportBuffer(BASE_SIZE, numExported);
+    buf.push_back(1); // # aggregated nodes
+    return buf;
+}
+
+struct Result {
+    int hops = 0;
+    size_t numMessages = 0;
+    size_t numBytes = 0;
+    float time = 0;
+    std::vector<int> elem;
+};
+
+Result simulate(AllReductionTopology::Type type, int fanIn, int numNodes, int cancelledIndex = -1) {
+
+    AdaptiveClauseDatabase mergeCdb(getSetup());
+    auto aggregator = [&](std::list<std::vector<int>>& elems) {
+        int numAggregated = 0;
+        for (auto& elem : elems) {
+            numAggregated += elem.back();
+            elem.pop_back();
+        }
+        auto merger = mergeCdb.getBufferMerger(MyMpi::getBinaryTreeBufferLimit(numAggregated,
+            BASE_SIZE, DISCOUNT, MyMpi::ALL));
+        for (auto& elem : elems) merger.add(mergeCdb.getBufferReader(elem.data(), elem.size()));
+        auto merged = merger.merge();
+        merged.push_back(numAggregated);
+        return merged;
+    };
+
+    std::vector<int> ranks;
+    for (int i = 0; i < numNodes; i++) ranks.push_back(1000 + 7*i);
+    robin_hood::unordered_map<int, int> indexOfRank;
+    for (int i = 0; i < numNodes; i++) indexOfRank[ranks[i]] = i;
+    JobTree dummyTree(numNodes, 0, 0, false);
+
+    struct Envelope {
+        int clock; size_t seq; int source; int dest; int tag; JobMessage msg;
+        bool operator<(const Envelope& other) const {
+            return clock != other.clock ? clock < other.clock : seq < other.seq;
+        }
+    };
+    std::set<Envelope> queue;
+    std::vector<int> clocks(numNodes, 0);
+    Result result;
+
+    std::vector<std::unique_ptr<AllReduction>> nodes;
+    for (int i = 0; i < numNodes; i++) {
+        AllReductionTopology topology(type, fanIn, ranks, ranks[i]);
+        nodes.push_back(topology.createAllReduction(dummyTree, JobMessage(1, 0, 1, MSG_ALLREDUCE_CLAUSES),
+            std::vector<int>(1, 1), aggregator));
+        nodes.back()->setSender([&, i](int dest, int tag, JobMessage& msg) {
+            queue.insert(Envelope{clocks[i]+1, result.numMessages, ranks[i], dest, tag, msg});
+            result.numMessages++;
+            result.numBytes += msg.payload.size() * sizeof(int);
+        });
+    }
+    std::vector<std::vector<int>> buffers;
+    for (int i = 0; i < numNodes; i++) buffers.push_back(getClauseBuffer());
+
+    // Let a node perform all local work (i.e., aggregations) which is possible right now
+    auto advanceNode = [&](int i) {
+        nodes[i]->advance();
+        while (nodes[i]->isAggregationPending()) {
+            std::this_thread::yield();
+            nodes[i]->advance();
+        }
+    };
+
+    float time = Timer::elapsedSeconds();
+    for (int i = 0; i < numNodes; i++) {
+        if (i == cancelledIndex) nodes[i]->cancel();
+        else nodes[i]->produce([&]() {return buffers[i];});
+        advanceNode(i);
+    }
+    while (!queue.empty()) {
+        auto envelope = std::move(queue.extract(queue.begin()).value());
+        int dest = indexOfRank[envelope.dest];
+        clocks[dest] = std::max(clocks[dest], envelope.clock);
+        bool accepted = nodes[dest]->receive(envelope.source, envelope.tag, envelope.msg);
+        assert(accepted || dest == cancelledIndex);
+        advanceNode(dest);
+    }
+    result.time = Timer::elapsedSeconds() - time;
+    for (int i = 0; i < numNodes; i++) assert(i == cancelledIndex || nodes[i]->hasResult());
+
+    for (int i = 0; i < numNodes; i++) {
+        if (i == cancelledIndex) continue;
+        result.hops = std::max(result.hops, clocks[i]);
+        auto elem = nodes[i]->extractResult();
+        if (result.elem.empty()) result.elem = elem;
+        // Without failures, each node obtains the same result
+        if (cancelledIndex < 0) assert(elem == result.elem);
+        else assert(elem.back() <= numNodes);
+    }
+    if (cancelledIndex < 0) {
+        assert(result.elem.back() == numNodes);
+        assert(result.elem.size() <= 1 + sizeof(size_t)/sizeof(int) + MyMpi::getBinaryTreeBufferLimit(numNodes,
+            BASE_SIZE, DISCOUNT, MyMpi::ALL) + 31*31);
+    }
+    return result;
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V4_VVER);
+    ProcessWideThreadPool::init(1);
+
+    std::vector<std::pair<AllReductionTopology::Type, int>> topologies {
+        {AllReductionTopology::KARY_TREE, 2}, // same shape as the binary job tree
+        {AllReductionTopology::KARY_TREE, 4},
+        {AllReductionTopology::KARY_TREE, 8},
+        {AllReductionTopology::BUTTERFLY, 2}
+    };
+    for (int numNodes : {1, 2, 3, 7, 16, 100, 256}) {
+        for (auto [type, fanIn] : topologies) {
+            auto result = simulate(type, fanIn, numNodes);
+            LOG(V2_INFO, "n=%i %s (k=%i): %i hops, %lu msgs, %.3f MB, %.3fs, result len=%lu\n", numNodes,
+                AllReductionTopology::getName(type), fanIn, result.hops, result.numMessages,
+                result.numBytes/1e6, result.time, result.elem.size());
+        }
+    }
+
+    // A node leaving (or never joining) the all-reduction must not block the others
+    for (int numNodes : {2, 5, 13, 16}) {
+        for (int cancelled : {0, numNodes/2, numNodes-1}) {
+            for (auto [type, fanIn] : topologies) {
+                if (type != AllReductionTopology::BUTTERFLY) continue;
+                simulate(type, fanIn, numNodes, cancelled);
+            }
+        }
+    }
+}
@@ -81,6 +81,88 @@ void test() {
 }
 
 
+// Reference implementation of the former (unblocked) clause filter: 
+// k=4 bits scattered over a fixed-size bitset
+class ScatteredClauseFilter {
+private:
+    AtomicBitset _bitset;
+public:
+    ScatteredClauseFilter(size_t numBits) : _bitset(numBits) {}
+    bool registerClause(const int* begin, int size) {
+        bool admitted = false;
+        for (int i = 1; i <= 4; i++) {
+            size_t h = ClauseHasher::hash(begin, size, i) % _bitset.size();
+            if (!admitted) admitted = !_bitset.test(h, std::memory_order_relaxed);
+            if (admitted) _bitset.set(h, true, std::memory_order_relaxed);
+        }
+        return admitted;
+    }
+    bool contains(const int* begin, int size) const {
+        for (int i = 1; i <= 4; i++) {
+            size_t h = ClauseHasher::hash(begin, size, i) % _bitset.size();
+            if (!_bitset.test(h, std::memory_order_relaxed)) return false;
+        }
+        return true;
+    }
+};
+
+std::vector<std::vector<int>> getRandomClauses(size_t numClauses) {
+    std::vector<std::vector<int>> clauses(numClauses);
+    for (auto& cls : clauses) {
+        int size = 1 + (int) (Random::rand()*30);
+        for (int i = 0; i < size; i++) {
+            int lit = 1 + (int) (Random::rand()*1000000);
+            cls.push_back(Random::rand() < 0.5 ? -lit : lit);
+        }
+    }
+    return clauses;
+}
+
+template <typename Filter>
+void benchmarkFilter(const char* name, Filter& filter, size_t numBits,
+        const std::vector<std::vector<int>>& inserted, const std::vector<std::vector<int>>& queried) {
+
+    // Insert clauses
+    double time = Timer::elapsedSeconds();
+    size_t numAdmitted = 0;
+    for (auto& cls : inserted) numAdmitted += filter.registerClause(cls.data(), cls.size()) ? 1 : 0;
+    double insertTime = Timer::elapsedSeconds() - time;
+
+    // Each inserted clause must be filtered now
+    for (auto& cls : inserted) assert(!filter.registerClause(cls.data(), cls.size()));
+
+    // Query fresh clauses (without inserting them) to measure false positive rate
+    time = Timer::elapsedSeconds();
+    size_t numFalsePositives = 0;
+    for (auto& cls : queried) numFalsePositives += filter.contains(cls.data(), cls.size()) ? 1 : 0;
+    double queryTime = Timer::elapsedSeconds() - time;
+    
+    LOG(V2_INFO, "%s m=%lu n=%lu : insert %.1f Mcls/s (%lu admitted), query %.1f Mcls/s, FPR %.6f\n", 
+        name, numBits, inserted.size(), inserted.size() / insertTime / 1e6, numAdmitted,
+        queried.size() / queryTime / 1e6, ((double) numFalsePositives) / queried.size());
+}
+
+void testFilters() {
+
+    size_t numBits = ClauseFilter::getNumBitsFor(/*expectedNumClauses=*/400000);
+    for (size_t numClauses : {10000, 100000, 400000, 1000000}) {
+        auto inserted = getRandomClauses(numClauses);
+        auto queried = getRandomClauses(numClauses);
+        {
+            ScatteredClauseFilter filter(NUM_BITS);
+            benchmarkFilter("Scattered k=4  ", filter, NUM_BITS, inserted, queried);
+        }
+        {
+            ClauseFilter filter(NUM_BITS, 0);
+            benchmarkFilter("Blocked k=8    ", filter, filter.getNumBits(), inserted, queried);
+        }
+        {
+            ClauseFilter filter(numBits, 0);
+            benchmarkFilter("Blocked k=8 rt ", filter, filter.getNumBits(), inserted, queried);
+        }
+    }
+}
+
 int main() {
     Timer::init();
     Random::init(rand(), rand());
@@ -88,4 +170,5 @@ int main() {
     Process::init(0);
 
     test();
+    testFilters();
 }
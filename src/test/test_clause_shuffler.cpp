@@ -0,0 +1,91 @@
+
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "app/sat/execution/clause_shuffler.hpp"
+
+// Shuffles random formulae batch by batch (as done while feeding a solver)
+// and checks that exactly the original clauses are returned.
+
+std::vector<int> getFormula(size_t numClauses, int maxClauseSize) {
+    std::vector<int> formula;
+    for (size_t c = 0; c < numClauses; c++) {
+        int size = 1 + (int) (Random::rand() * maxClauseSize);
+        for (int i = 0; i < size; i++) {
+            int var = 1 + (int) (Random::rand() * 100000);
+            formula.push_back(Random::rand() < 0.5 ? var : -var);
+        }
+        formula.push_back(0);
+    }
+    return formula;
+}
+
+// Maps each clause (with sorted literals) to its number of occurrences
+std::map<std::vector<int>, int> getClauses(const std::vector<int>& formula) {
+    std::map<std::vector<int>, int> clauses;
+    std::vector<int> clause;
+    for (int lit : formula) {
+        if (lit == 0) {
+            std::sort(clause.begin(), clause.end());
+            clauses[clause]++;
+            clause.clear();
+        } else clause.push_back(lit);
+    }
+    return clauses;
+}
+
+void testShuffle(size_t numClauses, int maxClauseSize, size_t batchSize) {
+
+    auto formula = getFormula(numClauses, maxClauseSize);
+    ClauseShuffler shuffler(1);
+    float time = Timer::elapsedSeconds();
+    shuffler.reset(formula.data(), formula.size());
+    assert(shuffler.getNumClauses() == numClauses);
+
+    std::vector<int> shuffled;
+    std::vector<int> batch;
+    size_t maxBatchSize = 0;
+    while (shuffler.hasNext()) {
+        size_t size = shuffler.nextBatch(batch, batchSize);
+        assert(size == batch.size());
+        assert(size > 0 && batch.back() == 0); // whole clauses only
+        maxBatchSize = std::max(maxBatchSize, size);
+        shuffled.insert(shuffled.end(), batch.begin(), batch.end());
+    }
+    time = Timer::elapsedSeconds() - time;
+    assert(shuffled.size() == formula.size());
+    assert(maxBatchSize < batchSize + maxClauseSize + 1);
+    assert(getClauses(shuffled) == getClauses(formula));
+    if (numClauses >= 100) assert(shuffled != formula);
+    LOG(V2_INFO, "%lu clauses shuffled in %.4fs\n", numClauses, time);
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    // Empty formula
+    ClauseShuffler shuffler;
+    shuffler.reset(nullptr, 0);
+    assert(!shuffler.hasNext());
+
+    testShuffle(1, 5, 10);
+    for (size_t numClauses : {10, 1000, 100000, 1000000}) {
+        testShuffle(numClauses, 10, 100000);
+    }
+    testShuffle(10000, 3, 1); // one clause per batch
+
+    // Without permuting clauses, only literals are permuted
+    auto formula = getFormula(1000, 10);
+    shuffler.reset(formula.data(), formula.size(), /*permuteClauses=*/false, /*permuteLiterals=*/true);
+    std::vector<int> batch;
+    shuffler.nextBatch(batch, formula.size());
+    assert(batch.size() == formula.size());
+    for (size_t i = 0; i < batch.size(); i++) assert((batch[i] == 0) == (formula[i] == 0));
+}
@@ -0,0 +1,125 @@
+
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "app/sat/execution/cube_queue.hpp"
+
+// Hands out the cubes of a few revisions to a number of "solver" threads
+// and checks that each cube is refuted exactly once.
+
+void testSingleThread() {
+    CubeQueue q(3);
+    std::vector<int> cube;
+    assert(q.fetch(0, cube) == CubeQueue::GENERATE);
+    q.generate(0, {4, -7, 2, 9}); // only three variables are used
+    std::set<std::vector<int>> cubes;
+    for (int i = 0; i < 8; i++) {
+        assert(q.fetch(0, cube) == CubeQueue::CUBE);
+        assert(cube.size() == 3);
+        assert(std::abs(cube[0]) == 4 && std::abs(cube[1]) == 7 && std::abs(cube[2]) == 2);
+        cubes.insert(cube);
+    }
+    assert(cubes.size() == 8);
+    assert(q.fetch(0, cube) == CubeQueue::EXHAUSTED);
+
+    // Give one cube back and fetch it again
+    auto firstCube = *cubes.begin();
+    q.giveBack(0, std::vector<int>(firstCube));
+    assert(q.fetch(0, cube) == CubeQueue::CUBE);
+    assert(cube == firstCube);
+    for (int i = 0; i < 7; i++) assert(!q.refute(0));
+    assert(q.refute(0));
+    assert(!q.refute(0));
+
+    // A new revision resets the queue; the old revision is obsolete
+    assert(q.fetch(1, cube) == CubeQueue::GENERATE);
+    assert(q.fetch(0, cube) == CubeQueue::EXHAUSTED);
+    assert(!q.refute(0));
+    q.generate(1, {}); // no splitting variables: the empty cube
+    assert(q.fetch(1, cube) == CubeQueue::CUBE);
+    assert(cube.empty());
+    assert(q.refute(1));
+}
+
+void testConcurrentThreads(int numThreads, int depth, int numRevisions) {
+    CubeQueue q(depth);
+    float time = Timer::elapsedSeconds();
+    for (int rev = 0; rev < numRevisions; rev++) {
+        std::atomic_int numRefuted = 0;
+        std::atomic_int numLastCubes = 0;
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; t++) threads.emplace_back([&, t]() {
+            std::vector<int> cube;
+            while (true) {
+                auto status = q.fetch(rev, cube);
+                if (status == CubeQueue::EXHAUSTED) break;
+                if (status == CubeQueue::GENERATE) {
+                    std::vector<int> vars;
+                    for (int v = 1; v <= depth; v++) vars.push_back(v);
+                    q.generate(rev, vars);
+                    continue;
+                }
+                // Some cubes are "interrupted" once
+                if (Random::rand() < 0.1) {
+                    q.giveBack(rev, std::move(cube));
+                    continue;
+                }
+                numRefuted++;
+                if (q.refute(rev)) numLastCubes++;
+            }
+        });
+        for (auto& thread : threads) thread.join();
+        assert(numRefuted == (1 << depth));
+        assert(numLastCubes == 1);
+    }
+    time = Timer::elapsedSeconds() - time;
+    LOG(V2_INFO, "%i threads, depth %i: %i revisions in %.4fs\n", numThreads, depth, numRevisions, time);
+}
+
+void testWaitForGeneration() {
+    // Threads which fetch while another thread supplies the splitting variables
+    // block until the cubes are there
+    CubeQueue q(2);
+    std::vector<int> cube;
+    assert(q.fetch(0, cube) == CubeQueue::GENERATE);
+    std::atomic_int numFetched = 0;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 3; t++) threads.emplace_back([&]() {
+        std::vector<int> cube;
+        if (q.fetch(0, cube) == CubeQueue::CUBE) numFetched++;
+    });
+    usleep(10000);
+    assert(numFetched == 0);
+    q.generate(0, {1, 2});
+    for (auto& thread : threads) thread.join();
+    assert(numFetched == 3);
+
+    // A new revision releases threads waiting for cubes of the former revision
+    assert(q.fetch(1, cube) == CubeQueue::GENERATE);
+    std::thread waiting([&]() {
+        std::vector<int> cube;
+        assert(q.fetch(1, cube) == CubeQueue::EXHAUSTED);
+    });
+    usleep(10000);
+    assert(q.fetch(2, cube) == CubeQueue::GENERATE);
+    waiting.join();
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    testSingleThread();
+    testWaitForGeneration();
+    for (int numThreads : {1, 4, 16}) {
+        testConcurrentThreads(numThreads, 8, 20);
+    }
+}
@@ -1,9 +1,14 @@
 
 #include "util/hashing.hpp"
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/sys/timer.hpp"
+#include "util/logger.hpp"
 #include "app/sat/data/clause.hpp"
+#include "app/sat/data/batch_clause_hasher.hpp"
 
 #include <unordered_set>
-#include <iostream>
+#include <vector>
 
 size_t commutativeHash(const int* begin, int size, int which = 3) {
     static unsigned const int primes [] = 
@@ -28,10 +33,62 @@ size_t nonCommutativeHash(const int* begin, int size, int which = 3) {
     return res;
 }
 
+void testBatchHashing() {
+
+    // Buckets of clauses of the same length, as in a clause buffer
+    const std::vector<int> lengths {1, 2, 3, 5, 8, 13, 30};
+    std::vector<std::vector<int>> buckets;
+    for (int len : lengths) {
+        std::vector<int> lits(len * (2000000 / len));
+        for (auto& lit : lits) {
+            lit = 1 + (int) (Random::rand()*1000000);
+            if (Random::rand() < 0.5) lit = -lit;
+        }
+        buckets.push_back(std::move(lits));
+    }
+
+    auto originalIsa = Mallob::BatchClauseHasher::getIsa();
+    for (auto isa : {Mallob::BatchClauseHasher::SCALAR, Mallob::BatchClauseHasher::AVX2, Mallob::BatchClauseHasher::AVX512}) {
+        if (!Mallob::BatchClauseHasher::isSupported(isa)) continue;
+        Mallob::BatchClauseHasher::setIsa(isa);
+
+        float batchTime = 0, singleTime = 0;
+        for (size_t b = 0; b < buckets.size(); b++) {
+            auto& lits = buckets[b];
+            int len = lengths[b];
+            size_t numClauses = lits.size() / len;
+            std::vector<size_t> batchHashes(numClauses), singleHashes(numClauses);
+
+            float time = Timer::elapsedSeconds();
+            Mallob::BatchClauseHasher::commutativeHashes(lits.data(), len, numClauses, batchHashes.data());
+            batchTime += Timer::elapsedSeconds() - time;
+
+            time = Timer::elapsedSeconds();
+            for (size_t i = 0; i < numClauses; i++)
+                singleHashes[i] = Mallob::commutativeHash(lits.data() + i*len, len, 3);
+            singleTime += Timer::elapsedSeconds() - time;
+
+            // Hashes must be identical to the ones computed one clause at a time
+            for (size_t i = 0; i < numClauses; i++) assert(batchHashes[i] == singleHashes[i]);
+            // (Also check the non-commutative hash against its reference implementation)
+            for (size_t i = 0; i < numClauses; i += 1000) assert(
+                Mallob::nonCommutativeHash(lits.data() + i*len, len, 3) == nonCommutativeHash(lits.data() + i*len, len, 3));
+        }
+        LOG(V2_INFO, "%s: batched %.4fs, one at a time %.4fs\n", 
+            Mallob::BatchClauseHasher::getIsaName(isa), batchTime, singleTime);
+    }
+    Mallob::BatchClauseHasher::setIsa(originalIsa);
+}
+
 int main() {
+    Timer::init();
+    Random::init(rand(), rand());
+    Logger::init(0, V5_DEBG);
+
+    testBatchHashing();
 
     for (int shift = 0; shift < 64; shift += 4) {
-        std::cout << "shift=" << shift << std::endl;
+        LOG(V2_INFO, "shift=%i\n", shift);
 
         //std::unordered_set<size_t> commHashes;
         std::unordered_set<size_t> noncommHashes;
@@ -44,8 +101,8 @@ int main() {
             rhHashes.insert(robin_hood::hash<int>()(lit) << shift);
         }
 
-        //std::cout << commHashes.size() << " / 2'000'000 unique commutative hashes" << std::endl;
-        std::cout << noncommHashes.size() << " / 2'000'000 unique non-commutative hashes" << std::endl;
-        std::cout << rhHashes.size() << " / 2'000'000 unique robin_hood hashes" << std::endl;
+        //LOG(V2_INFO, "%lu / 2'000'000 unique commutative hashes\n", commHashes.size());
+        LOG(V2_INFO, "%lu / 2'000'000 unique non-commutative hashes\n", noncommHashes.size());
+        LOG(V2_INFO, "%lu / 2'000'000 unique robin_hood hashes\n", rhHashes.size());
     }
 }
@@ -0,0 +1,157 @@
+
+#include <vector>
+#include <set>
+#include <algorithm>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "app/sat/job/host_imported_clauses.hpp"
+
+// Checks that clauses imported from host-level sharing are recognized in job-wide
+// sharing results, and measures the job-wide (inter-host) bytes per useful import
+// with and without dropping these clauses in a simulated job of several hosts.
+
+const int maxClauseLength = 8;
+
+AdaptiveClauseDatabase::Setup getSetup() {
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = maxClauseLength;
+    setup.maxLbdPartitionedSize = 5;
+    setup.numLiterals = 1'000'000;
+    setup.slotsForSumOfLengthAndLbd = false;
+    return setup;
+}
+
+std::vector<int> getBuffer(const std::set<std::vector<int>>& clauses) {
+    AdaptiveClauseDatabase cdb(getSetup());
+    for (auto& lits : clauses) {
+        Mallob::Clause c((int*) lits.data(), lits.size(), std::min(2, (int)lits.size()));
+        assert(cdb.addClause(c));
+    }
+    int numExported;
+    auto buffer = cdb.exportBuffer(-1, numExported);
+    assert(numExported == clauses.size());
+    return buffer;
+}
+
+std::set<std::vector<int>> getClauses(AdaptiveClauseDatabase& cdb, std::vector<int>& buffer) {
+    std::set<std::vector<int>> clauses;
+    auto reader = cdb.getBufferReader(buffer.data(), buffer.size());
+    auto c = reader.getNextIncomingClause();
+    while (c.begin != nullptr) {
+        std::vector<int> lits(c.begin, c.begin+c.size);
+        std::sort(lits.begin(), lits.end());
+        clauses.insert(lits);
+        c = reader.getNextIncomingClause();
+    }
+    return clauses;
+}
+
+std::set<std::vector<int>> getRandomClauses(int num, int numVars) {
+    std::set<std::vector<int>> clauses;
+    while (clauses.size() < num) {
+        int size = 1 + (int) (Random::rand() * maxClauseLength);
+        std::set<int> vars;
+        while (vars.size() < size) vars.insert(1 + (int) (Random::rand() * numVars));
+        std::vector<int> lits;
+        for (int var : vars) lits.push_back(Random::rand() < 0.5 ? -var : var);
+        std::sort(lits.begin(), lits.end());
+        clauses.insert(lits);
+    }
+    return clauses;
+}
+
+void testRecognition() {
+    AdaptiveClauseDatabase cdb(getSetup());
+    HostImportedClauses hostImported(cdb, maxClauseLength, false);
+
+    auto hostClauses = getRandomClauses(200, 1000);
+    auto otherClauses = getRandomClauses(300, 1000);
+    for (auto& lits : hostClauses) otherClauses.erase(lits);
+
+    // Host-level session: all clauses are new and remembered
+    auto buffer = getBuffer(hostClauses);
+    assert(hostImported.removeKnownAndAdd(buffer, 1) == 0);
+    assert(getClauses(cdb, buffer) == hostClauses);
+    assert(hostImported.size() == hostClauses.size());
+
+    // Another host-level session with the same clauses: all are dropped
+    buffer = getBuffer(hostClauses);
+    assert(hostImported.removeKnownAndAdd(buffer, 2) == hostClauses.size());
+    assert(getClauses(cdb, buffer).empty());
+
+    // Job-wide result: exactly the host-level clauses are filtered
+    std::set<std::vector<int>> allClauses = hostClauses;
+    allClauses.insert(otherClauses.begin(), otherClauses.end());
+    buffer = getBuffer(allClauses);
+    int numKnown;
+    auto filter = hostImported.getFilter(buffer, numKnown);
+    assert(numKnown == hostClauses.size());
+    auto reader = cdb.getBufferReader(buffer.data(), buffer.size());
+    int clsIdx = 0;
+    auto c = reader.getNextIncomingClause();
+    while (c.begin != nullptr) {
+        std::vector<int> lits(c.begin, c.begin+c.size);
+        std::sort(lits.begin(), lits.end());
+        bool filtered = (filter[clsIdx / 32] & (1 << (clsIdx % 32))) != 0;
+        assert(filtered == (hostClauses.count(lits) > 0));
+        clsIdx++;
+        c = reader.getNextIncomingClause();
+    }
+    assert(clsIdx == allClauses.size());
+
+    // Clauses are forgotten after a while
+    hostImported.forgetOlderThan(2);
+    assert(hostImported.size() == 0);
+    filter = hostImported.getFilter(buffer, numKnown);
+    assert(numKnown == 0);
+}
+
+void measure(int numHosts, int nodesPerHost, int clausesPerNode) {
+    // Clauses of all nodes (partly overlapping among the nodes)
+    std::vector<std::set<std::vector<int>>> nodeClauses;
+    for (int n = 0; n < numHosts*nodesPerHost; n++)
+        nodeClauses.push_back(getRandomClauses(clausesPerNode, 3000));
+
+    // Host-level sessions, then a job-wide session among the host leaders
+    std::vector<std::set<std::vector<int>>> hostClauses(numHosts);
+    std::set<std::vector<int>> allClauses;
+    for (int n = 0; n < nodeClauses.size(); n++) {
+        hostClauses[n / nodesPerHost].insert(nodeClauses[n].begin(), nodeClauses[n].end());
+        allClauses.insert(nodeClauses[n].begin(), nodeClauses[n].end());
+    }
+    auto globalBuffer = getBuffer(allClauses);
+    size_t interHostBytes = numHosts * globalBuffer.size() * sizeof(int);
+
+    size_t numUseful = 0, numGlobalImports = 0, numGlobalImportsDeduplicated = 0;
+    for (int n = 0; n < nodeClauses.size(); n++) {
+        AdaptiveClauseDatabase cdb(getSetup());
+        HostImportedClauses hostImported(cdb, maxClauseLength, false);
+        auto hostBuffer = getBuffer(hostClauses[n / nodesPerHost]);
+        hostImported.removeKnownAndAdd(hostBuffer, 0);
+        auto buffer = globalBuffer;
+        int numKnown;
+        hostImported.getFilter(buffer, numKnown);
+        numGlobalImports += allClauses.size();
+        numGlobalImportsDeduplicated += allClauses.size() - numKnown;
+        // Only clauses not imported at host level are of use to the node
+        numUseful += allClauses.size() - hostClauses[n / nodesPerHost].size();
+    }
+    assert(numGlobalImportsDeduplicated == numUseful);
+    LOG(V2_INFO, "%i hosts x %i nodes: %lu inter-host bytes, %lu useful imports: %.1f bytes per useful import\n",
+        numHosts, nodesPerHost, interHostBytes, numUseful, (double)interHostBytes / numUseful);
+    LOG(V2_INFO, "  job-wide imports per node: %.1f, without host-imported clauses: %.1f (%.1f%% useful before)\n",
+        (double)numGlobalImports / nodeClauses.size(), (double)numGlobalImportsDeduplicated / nodeClauses.size(),
+        100.0 * numUseful / numGlobalImports);
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    testRecognition();
+    for (int nodesPerHost : {1, 2, 4, 8}) measure(4, nodesPerHost, 500);
+}
@@ -0,0 +1,210 @@
+
+#include <vector>
+#include <set>
+
+#include "util/assert.hpp"
+#include "util/logger.hpp"
+#include "util/params.hpp"
+#include "util/random.hpp"
+#include "util/sys/timer.hpp"
+#include "app/sat/data/import_acceptance.hpp"
+#include "app/sat/solvers/portfolio_solver_interface.hpp"
+#include "app/sat/sharing/sharing_manager.hpp"
+
+// Counts imported clauses by length and LBD bucket, aggregates the counts of several nodes
+// as done in the all-reduction of clauses, and checks the reported shares. Also checks
+// which clauses the sharing manager counts when digesting clauses without a global filter.
+
+void testBuckets() {
+    assert(ImportAcceptance::getLengthBucket(1) == 0);
+    assert(ImportAcceptance::getLengthBucket(2) == 1);
+    assert(ImportAcceptance::getLengthBucket(3) == 2);
+    assert(ImportAcceptance::getLengthBucket(4) == 2);
+    assert(ImportAcceptance::getLengthBucket(5) == 3);
+    assert(ImportAcceptance::getLengthBucket(16) == 4);
+    assert(ImportAcceptance::getLengthBucket(17) == 5);
+    assert(ImportAcceptance::getLengthBucket(1000) == 5);
+    for (int len = 1; len <= 16; len++) {
+        int bucket = ImportAcceptance::getLengthBucket(len);
+        assert(len <= ImportAcceptance::getMaxLength(bucket));
+        assert(bucket == 0 || len > ImportAcceptance::getMaxLength(bucket-1));
+    }
+    assert(ImportAcceptance::getLbdBucket(1) == 0);
+    assert(ImportAcceptance::getLbdBucket(2) == 0);
+    assert(ImportAcceptance::getLbdBucket(3) == 1);
+    assert(ImportAcceptance::getLbdBucket(4) == 1);
+    assert(ImportAcceptance::getLbdBucket(5) == 2);
+    assert(ImportAcceptance::getLbdBucket(100) == 2);
+    std::set<int> buckets;
+    for (int len = 1; len <= 32; len++) for (int lbd = 1; lbd <= len; lbd++) {
+        int bucket = ImportAcceptance::getBucket(len, lbd);
+        assert(bucket >= 0 && bucket < ImportAcceptance::NUM_BUCKETS);
+        buckets.insert(bucket);
+    }
+    // all buckets but (length 1-2, LBD 3+) and (length 3-4, LBD 5+)
+    assert(buckets.size() == ImportAcceptance::NUM_BUCKETS - 5);
+}
+
+void testSharesAndDifference() {
+    ImportAcceptance u;
+    assert(u.getAcceptedShare() == -1);
+    for (int i = 0; i < 10; i++) u.add(1, 1, true);
+    for (int i = 0; i < 30; i++) u.add(20, i < 15 ? 2 : 10, i < 10);
+    assert(u.getNumReceived() == 40);
+    assert(u.getNumAccepted() == 20);
+    assert(u.getAcceptedShareOfLength(0) == 1);
+    assert(u.getAcceptedShareOfLength(5) > 0.333 && u.getAcceptedShareOfLength(5) < 0.334);
+    assert(u.getAcceptedShareOfLength(1) == -1);
+    assert(u.getAcceptedShareOfLbd(0) == 0.8f); // 20 of 25
+    assert(u.getAcceptedShareOfLbd(1) == -1);
+    assert(u.getAcceptedShareOfLbd(2) == 0);
+    assert(u.getAcceptedShare() == 0.5);
+
+    // Counts since an earlier state
+    ImportAcceptance later = u;
+    later.add(2, 2, false);
+    later.add(2, 2, true);
+    auto diff = later.getDifference(u);
+    assert(diff.getNumReceived() == 2);
+    int bucket = ImportAcceptance::getBucket(2, 2);
+    assert(diff.received[bucket] == 2 && diff.accepted[bucket] == 1);
+    // Reset counters (e.g., restarted process): all counts are new
+    ImportAcceptance reset;
+    reset.add(3, 2, true);
+    diff = reset.getDifference(u);
+    assert(diff.getNumReceived() == 1);
+}
+
+void testSerialization() {
+    // Elements of three nodes: clauses, acceptance, number of aggregated nodes
+    std::vector<std::vector<int>> elems;
+    for (int node = 0; node < 3; node++) {
+        std::vector<int> elem {7, 7, 7}; // some clause data
+        ImportAcceptance u;
+        for (int i = 0; i <= node; i++) u.add(1 << (2*node), 2, node != 1);
+        u.serializeTo(elem);
+        elem.push_back(1);
+        assert(elem.size() == 3 + ImportAcceptance::SERIALIZED_SIZE + 1);
+        elems.push_back(std::move(elem));
+    }
+    ImportAcceptance aggregated;
+    int numAggregated = 0;
+    for (auto& elem : elems) {
+        numAggregated += elem.back();
+        elem.pop_back();
+        ImportAcceptance u;
+        u.deserializeFrom(elem);
+        assert(elem == std::vector<int>({7, 7, 7}));
+        aggregated.aggregate(u);
+    }
+    assert(numAggregated == 3);
+    assert(aggregated.getNumReceived() == 6);
+    assert(aggregated.getAcceptedShareOfLength(0) == 1);
+    assert(aggregated.getAcceptedShareOfLength(2) == 0);
+    assert(aggregated.getAcceptedShareOfLength(4) == 1);
+    assert(aggregated.received[ImportAcceptance::getBucket(16, 2)] == 3);
+    LOG(V2_INFO, "%s\n", aggregated.getReport().c_str());
+}
+
+class DummySolver : public PortfolioSolverInterface {
+
+private:
+    LearnedClauseCallback _callback;
+
+public:
+    DummySolver(const SolverSetup& setup) : PortfolioSolverInterface(setup) {}
+
+    // Reports a learned clause to the sharing layer
+    void learn(const std::vector<int>& lits) {
+        _callback(Mallob::Clause((int*) lits.data(), lits.size(), std::min(2, (int)lits.size())), getLocalId());
+    }
+
+    int getVariablesCount() override {return 0;}
+    int getSplittingVariable() override {return 0;}
+    void setPhase(const int var, const bool phase) override {}
+    SatResult solve(size_t numAssumptions, const int* assumptions) override {return UNKNOWN;}
+    std::vector<int> getSolution() override {return std::vector<int>();}
+    std::set<int> getFailedAssumptions() override {return std::set<int>();}
+    void addLiteral(int lit) override {}
+    void setLearnedClauseCallback(const LearnedClauseCallback& callback) override {_callback = callback;}
+    void writeStatistics(SolverStatistics& stats) override {}
+    void diversify(int seed) override {}
+    int getNumOriginalDiversifications() override {return 1;}
+    bool supportsIncrementalSat() override {return false;}
+    bool exportsConditionalClauses() override {return false;}
+    void setSolverInterrupt() override {}
+    void unsetSolverInterrupt() override {}
+    void setSolverSuspend() override {}
+    void unsetSolverSuspend() override {}
+};
+
+void testCountingInSharingManager() {
+    Parameters params;
+    std::vector<std::shared_ptr<PortfolioSolverInterface>> solvers;
+    std::vector<DummySolver*> dummies;
+    for (int i = 0; i < 2; i++) {
+        SolverSetup setup;
+        setup.logger = &Logger::getMainInstance();
+        setup.globalId = i;
+        setup.localId = i;
+        setup.jobname = "#1";
+        setup.diversificationIndex = i;
+        setup.solverType = 'c';
+        setup.minNumChunksPerSolver = params.minNumChunksForImportPerSolver();
+        setup.numBufferedClsGenerations = params.bufferedImportedClsGenerations();
+        setup.strictClauseLengthLimit = params.strictClauseLengthLimit();
+        setup.strictLbdLimit = params.strictLbdLimit();
+        setup.qualityClauseLengthLimit = params.qualityClauseLengthLimit();
+        setup.qualityLbdLimit = params.qualityLbdLimit();
+        setup.clauseBaseBufferSize = params.clauseBufferBaseSize();
+        setup.anticipatedLitsToImportPerCycle = 100000;
+        auto solver = std::make_shared<DummySolver>(setup);
+        dummies.push_back(solver.get());
+        solvers.push_back(solver);
+    }
+    SharingManager sharingManager(solvers, params, Logger::getMainInstance(), 1000, 0);
+    sharingManager.setRevision(0);
+
+    // Clauses to share, some of which were learned by solver 0 itself
+    std::vector<std::vector<int>> clauses;
+    for (int i = 0; i < 100; i++) clauses.push_back({i+1, -(i+1001), i+2001});
+    for (int i = 0; i < 10; i++) dummies[0]->learn(clauses[i]);
+    dummies[0]->flushLearnedClauses();
+    sharingManager.prepareSharing(100000); // (exports the learned clauses)
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = params.strictClauseLengthLimit();
+    setup.maxLbdPartitionedSize = params.maxLbdPartitioningSize();
+    setup.slotsForSumOfLengthAndLbd = params.groupClausesByLengthLbdSum();
+    setup.numLiterals = 100000;
+    AdaptiveClauseDatabase cdb(setup);
+    for (auto& lits : clauses) {
+        Mallob::Clause c(lits.data(), lits.size(), 2);
+        assert(cdb.addClause(c));
+    }
+    int numExported;
+    auto buffer = cdb.exportBuffer(-1, numExported);
+    assert(numExported == clauses.size());
+
+    // Digest as done with the clauses of host-level sharing: all clauses are counted
+    // except for those offered to their own producer
+    auto before = sharingManager.getImportAcceptance();
+    sharingManager.digestSharingWithoutFilter(buffer.data(), buffer.size());
+    auto diff = sharingManager.getImportAcceptance().getDifference(before);
+    LOG(V2_INFO, "acceptance after digest without filter: %s\n", diff.getReport().c_str());
+    assert(diff.getNumReceived() == 2*clauses.size() - 10);
+    assert(diff.received[ImportAcceptance::getBucket(3, 2)] == diff.getNumReceived());
+    assert(diff.getNumAccepted() <= diff.getNumReceived());
+    assert(diff.getNumAccepted() > 0);
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    testBuckets();
+    testSharesAndDifference();
+    testSerialization();
+    testCountingInSharingManager();
+}
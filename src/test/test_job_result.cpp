@@ -0,0 +1,90 @@
+
+#include <vector>
+#include <optional>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "data/job_result.hpp"
+
+// Serializes models of different shapes, transfers them as a byte vector
+// (as done via MPI) and checks that they are restored exactly.
+
+std::vector<int> getModel(size_t numVars, float switchProbability) {
+    std::vector<int> model(1, 0);
+    bool value = false;
+    for (int v = 1; v <= numVars; v++) {
+        if (Random::rand() < switchProbability) value = !value;
+        model.push_back(value ? v : -v);
+    }
+    return model;
+}
+
+JobResult transfer(JobResult& result, size_t& numBytes) {
+    result.id = 7;
+    result.revision = 3;
+    result.updateSerialization();
+    auto packed = result.moveSerialization();
+    numBytes = packed.size();
+    JobResult received(std::move(packed));
+    assert(received.id == 7);
+    assert(received.revision == 3);
+    assert(received.result == 10);
+    return received;
+}
+
+void testModel(const std::vector<int>& model, std::optional<JobResult::EncodedType> expectedType = {}) {
+
+    JobResult result;
+    result.result = 10;
+    result.setModelToSerialize(model.data(), model.size());
+    assert(!expectedType || result.encodedType == expectedType.value());
+    size_t numBytes;
+    auto received = transfer(result, numBytes);
+    assert(received.encodedType == result.encodedType);
+    assert(received.getSolutionSize() == model.size());
+
+    if (received.encodedType != JobResult::MODEL_RLE) {
+        for (size_t v = 0; v < model.size(); v++) assert(received.getSolution(v) == model[v]);
+    }
+    // Decode in small chunks
+    size_t v = 0;
+    received.decodeSolution([&](const int* lits, size_t size) {
+        assert(size <= 1000);
+        for (size_t i = 0; i < size; i++) assert(lits[i] == model[v++]);
+    }, 1000);
+    assert(v == model.size());
+    assert(received.extractSolution() == model);
+
+    LOG(V2_INFO, "%lu vars: %lu bytes (type %i) instead of %lu bytes\n", model.size()-1,
+        numBytes, (int) received.encodedType, model.size()*sizeof(int));
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    // Tiny models: either encoding
+    for (size_t numVars : {0, 1, 31, 32, 33}) {
+        testModel(getModel(numVars, 0.5));
+    }
+    // Random models: one bit per variable
+    for (size_t numVars : {1000, 100000, 10000000}) {
+        testModel(getModel(numVars, 0.5), JobResult::MODEL_BITS);
+    }
+    // Long runs of equal values: run-length encoding
+    for (size_t numVars : {1000, 100000, 10000000}) {
+        testModel(getModel(numVars, 0.001), JobResult::MODEL_RLE);
+    }
+    testModel(getModel(1000000, 0), JobResult::MODEL_RLE); // all false
+
+    // Not a model (e.g., failed assumptions): plain integers
+    std::vector<int> lits {0, 5, -3, 17};
+    testModel(lits, JobResult::INT);
+    // Zero entries apart from position 0 and non-zero entries at position 0
+    // do not belong to a model either
+    testModel({0, 1, 0, -3}, JobResult::INT);
+    testModel({2, 1, -2}, JobResult::INT);
+}
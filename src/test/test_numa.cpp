@@ -0,0 +1,74 @@
+
+#include <vector>
+#include <sstream>
+#include <cstring>
+#include <unistd.h>
+
+#include "util/assert.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "util/sys/proc.hpp"
+
+void testParseCpuOrNodeList() {
+    assert(Proc::parseCpuOrNodeList("0") == std::vector<int>({0}));
+    assert(Proc::parseCpuOrNodeList("0-3") == std::vector<int>({0, 1, 2, 3}));
+    assert(Proc::parseCpuOrNodeList("0-1,4,6-7") == std::vector<int>({0, 1, 4, 6, 7}));
+    assert(Proc::parseCpuOrNodeList("2,,5") == std::vector<int>({2, 5}));
+    assert(Proc::parseCpuOrNodeList("").empty());
+}
+
+void testParseNumaMaps() {
+    std::istringstream numaMaps(
+        "7f2c3a000000 interleave:0-1 file=/dev/shm/x mapped=512 N0=256 N1=256 kernelpagesize_kB=4\n"
+        "7f2c3b000000 default anon=3 dirty=3 N1=3 kernelpagesize_kB=4\n"
+        "7f2c3c000000 prefer:3 anon=10 dirty=10 N3=10 kernelpagesize_kB=4\n"
+        "7f2c3d000000 default file=/usr/lib/libNAME.so mapped=2 N0=2 kernelpagesize_kB=4\n"
+    );
+    auto pages = Proc::getNumaPagesPerNode(numaMaps);
+    assert(pages == std::vector<unsigned long>({258, 259, 0, 10}));
+}
+
+void testPagesOfThisProcess() {
+    auto nodes = Proc::getNumaNodes();
+    assert(!nodes.empty());
+    LOG(V2_INFO, "%lu NUMA node(s), %lu CPUs on node %i\n", nodes.size(),
+        Proc::getNumaNodeCpus(nodes[0]).size(), nodes[0]);
+
+    auto sumOfPages = [](const std::vector<unsigned long>& pages) {
+        unsigned long sum = 0;
+        for (auto num : pages) sum += num;
+        return sum;
+    };
+    auto pagesBefore = Proc::getNumaPagesPerNode(Proc::getPid());
+
+    // Memory placed on the first node, touched only after the placement
+    const size_t pageSize = sysconf(_SC_PAGESIZE);
+    const size_t numPages = 1000;
+    char* data = (char*) Proc::allocateOnNumaNodes(numPages * pageSize, {nodes[0]});
+    if (data == nullptr) {
+        LOG(V1_WARN, "[WARN] NUMA placement not permitted here - skipping\n");
+        return;
+    }
+    memset(data, 1, numPages * pageSize);
+    auto pagesAfter = Proc::getNumaPagesPerNode(Proc::getPid());
+    assert(pagesAfter.size() > nodes[0]);
+    assert(sumOfPages(pagesAfter) >= sumOfPages(pagesBefore) + numPages);
+    unsigned long pagesOnNodeBefore = pagesBefore.size() > nodes[0] ? pagesBefore[nodes[0]] : 0;
+    assert(pagesAfter[nodes[0]] >= pagesOnNodeBefore + numPages);
+
+    // Present pages can be placed, too
+    assert(Proc::placeMemoryOnNumaNodes(data, numPages * pageSize, {nodes[0]}));
+    Proc::freeOnNumaNodes(data, numPages * pageSize);
+
+    assert(Proc::setPreferredNumaNodeOfThisThread(nodes[0]));
+    assert(Proc::setPreferredNumaNodeOfThisThread(-1));
+}
+
+int main() {
+    Timer::init();
+    Logger::init(0, V5_DEBG);
+
+    testParseCpuOrNodeList();
+    testParseNumaMaps();
+    testPagesOfThisProcess();
+}
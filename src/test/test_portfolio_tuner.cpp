@@ -0,0 +1,119 @@
+
+#include <vector>
+#include <string>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "app/sat/execution/portfolio_tuner.hpp"
+
+// Lets the tuner repeatedly pick one of several solver configurations with different
+// (noisy) mean rewards and checks that it converges to the best configuration,
+// and that its statistics carry over to a later tuner of the same formula family.
+
+const std::string file = "/tmp/mallob_test_portfolio_tuner.txt";
+
+std::vector<PortfolioTuner::Arm> getArms() {
+    std::vector<PortfolioTuner::Arm> arms;
+    for (char type : {'k', 'c'}) for (int div = 0; div < 4; div++) arms.push_back({type, div});
+    return arms;
+}
+
+double getMeanReward(int arm) {
+    return arm == 5 ? 0.8 : 0.3 + 0.05 * (arm % 4);
+}
+
+std::vector<int> run(PortfolioTuner& tuner, int numRounds) {
+    std::vector<int> numSelections(tuner.getArms().size(), 0);
+    for (int i = 0; i < numRounds; i++) {
+        int arm = tuner.select();
+        assert(arm >= 0);
+        numSelections[arm]++;
+        tuner.reward(arm, getMeanReward(arm) + 0.2 * (Random::rand() - 0.5));
+    }
+    return numSelections;
+}
+
+void testConvergence() {
+    PortfolioTuner tuner(file, "familyA", getArms());
+    assert(tuner.getArmIndex('c', 1) == 5);
+    assert(tuner.getArmIndex('l', 0) == -1);
+    auto numSelections = run(tuner, 2000);
+    for (size_t arm = 0; arm < numSelections.size(); arm++) {
+        assert(numSelections[arm] > 0); // each arm was tried
+        assert(arm == 5 || numSelections[arm] < numSelections[5]);
+    }
+    LOG(V2_INFO, "best arm selected %i/2000 times, mean reward %.3f\n", numSelections[5], tuner.getMeanReward(5));
+
+    // Excluded arms are not selected
+    for (int i = 0; i < 100; i++) assert(tuner.select({5}) != 5);
+    assert(tuner.save());
+}
+
+void testPersistence() {
+    // Same family: the best arm is known from the start
+    PortfolioTuner tuner(file, "familyA", getArms());
+    assert(tuner.getNumPulls(5) > 1000);
+    auto numSelections = run(tuner, 100);
+    assert(numSelections[5] > 50);
+
+    // Another family: nothing is known
+    PortfolioTuner other(file, "familyB", getArms());
+    for (size_t arm = 0; arm < getArms().size(); arm++) assert(other.getNumPulls(arm) == 0);
+    run(other, 100);
+
+    // Both tuners add their statistics to the file
+    unsigned long pullsBefore = tuner.getNumPulls(5);
+    assert(tuner.save());
+    assert(other.save());
+    PortfolioTuner reloaded(file, "familyA", getArms());
+    assert(reloaded.getNumPulls(5) == pullsBefore);
+    PortfolioTuner reloadedOther(file, "familyB", getArms());
+    unsigned long totalPulls = 0;
+    for (size_t arm = 0; arm < getArms().size(); arm++) totalPulls += reloadedOther.getNumPulls(arm);
+    assert(totalPulls == 100);
+}
+
+void testConcurrentSaves() {
+    // Several processes repeatedly add a single pull of the same family to the file
+    const int numProcesses = 4, numSaves = 25;
+    std::vector<pid_t> children;
+    for (int p = 0; p < numProcesses; p++) {
+        pid_t pid = fork();
+        assert(pid >= 0);
+        if (pid == 0) {
+            for (int i = 0; i < numSaves; i++) {
+                PortfolioTuner tuner(file, "familyC", getArms());
+                tuner.reward(p, 1);
+                if (!tuner.save()) _exit(1);
+            }
+            _exit(0);
+        }
+        children.push_back(pid);
+    }
+    for (pid_t pid : children) {
+        int status;
+        assert(waitpid(pid, &status, 0) == pid);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+    // No update was lost
+    PortfolioTuner reloaded(file, "familyC", getArms());
+    for (int p = 0; p < numProcesses; p++) assert(reloaded.getNumPulls(p) == numSaves);
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    std::remove(file.c_str());
+    testConvergence();
+    testPersistence();
+    testConcurrentSaves();
+    std::remove(file.c_str());
+    std::remove((file + ".lock").c_str());
+}
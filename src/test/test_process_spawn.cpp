@@ -0,0 +1,128 @@
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "util/assert.hpp"
+#include "util/sys/timer.hpp"
+#include "util/sys/process.hpp"
+#include "util/logger.hpp"
+
+// Launches short-lived programs from a process holding a large heap (like a worker
+// with a large job cache), either by fork+exec (as done before) or by posix_spawn.
+
+// Returns the amount of memory committed system-wide in kB
+long getCommittedMemory() {
+    std::ifstream ifs("/proc/meminfo");
+    std::string key;
+    long value;
+    std::string unit;
+    while (ifs >> key >> value) {
+        if (key == "Committed_AS:") return value;
+        std::getline(ifs, unit);
+    }
+    return -1;
+}
+
+pid_t forkAndExec(char* const argv[]) {
+    pid_t pid = Process::createChild();
+    if (pid == 0) {
+        execvp(argv[0], argv);
+        _exit(1);
+    }
+    return pid;
+}
+
+void awaitChild(pid_t pid) {
+    while (!Process::didChildExit(pid)) usleep(100);
+}
+
+void testLaunchLatency(bool spawn, int numLaunches) {
+    const char* argv[] = {"true", nullptr};
+    float sumLatency = 0, maxLatency = 0;
+    for (int i = 0; i < numLaunches; i++) {
+        float time = Timer::elapsedSeconds();
+        pid_t pid = spawn ? Process::spawnChild((char* const*) argv) : forkAndExec((char* const*) argv);
+        time = Timer::elapsedSeconds() - time;
+        assert(pid > 0);
+        awaitChild(pid);
+        sumLatency += time;
+        maxLatency = std::max(maxLatency, time);
+    }
+    LOG(V2_INFO, "%s: %i launches, avg %.1fus, max %.1fus\n", spawn ? "posix_spawn" : "fork+exec",
+        numLaunches, 1e6 * sumLatency / numLaunches, 1e6 * maxLatency);
+}
+
+// Reports how much additional memory is committed while a child process exists
+// and has not executed its program yet (fork) or has just been launched (spawn)
+void testCommittedMemory(bool spawn) {
+    long before = getCommittedMemory();
+    long during;
+    if (spawn) {
+        const char* argv[] = {"sleep", "0.5", nullptr};
+        pid_t pid = Process::spawnChild((char* const*) argv);
+        assert(pid > 0);
+        during = getCommittedMemory();
+        awaitChild(pid);
+    } else {
+        int fds[2];
+        int res = pipe(fds);
+        assert(res == 0);
+        pid_t pid = Process::createChild();
+        if (pid == 0) {
+            // Wait for the parent to take its measurement
+            char c;
+            ssize_t numRead = read(fds[0], &c, 1);
+            _exit(numRead == 1 ? 0 : 1);
+        }
+        during = getCommittedMemory();
+        ssize_t numWritten = write(fds[1], "x", 1);
+        assert(numWritten == 1);
+        awaitChild(pid);
+        close(fds[0]);
+        close(fds[1]);
+    }
+    LOG(V2_INFO, "%s: committed memory +%.1f MB during launch\n", spawn ? "posix_spawn" : "fork+exec",
+        (during - before) / 1024.0);
+}
+
+void testSpawnWithOutput() {
+    int fds[2];
+    int res = pipe2(fds, O_CLOEXEC);
+    assert(res == 0);
+    const char* argv[] = {"echo", "mallob", nullptr};
+    pid_t pid = Process::spawnChild((char* const*) argv, fds[1]);
+    assert(pid > 0);
+    close(fds[1]);
+    char buf[16] = {'\0'};
+    ssize_t numRead = read(fds[0], buf, sizeof(buf)-1);
+    close(fds[0]);
+    awaitChild(pid);
+    assert(numRead == 7);
+    assert(std::string(buf) == "mallob\n");
+
+    // Unknown program
+    const char* argvInvalid[] = {"/nonexistent/mallob_program", nullptr};
+    pid = Process::spawnChild((char* const*) argvInvalid);
+    assert(pid == -1);
+}
+
+int main() {
+    Timer::init();
+    Logger::init(0, V5_DEBG);
+
+    testSpawnWithOutput();
+
+    // Hold (and touch) a large heap
+    std::vector<char> heap(1UL << 30, 1);
+    for (size_t i = 0; i < heap.size(); i += 4096) heap[i] = (char) i;
+    LOG(V2_INFO, "Holding %.1f MB of heap\n", heap.size() / 1048576.0);
+
+    for (bool spawn : {false, true}) {
+        testLaunchLatency(spawn, 100);
+        testCommittedMemory(spawn);
+    }
+}
@@ -0,0 +1,351 @@
+
+#include <iostream>
+#include "util/assert.hpp"
+#include <vector>
+#include <string>
+#include <thread>
+#include <atomic>
+
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "util/sys/proc.hpp"
+#include "app/sat/sharing/buffer/adaptive_clause_database.hpp"
+#include "app/sat/sharing/filter/produced_clause_filter.hpp"
+#include "app/sat/sharing/export_buffer.hpp"
+
+std::vector<std::vector<int>> getClauses(int numClauses) {
+    std::vector<std::vector<int>> clauses(numClauses);
+    for (auto& cls : clauses) {
+        int size = 1 + (int) (Random::rand()*30);
+        for (int i = 0; i < size; i++) {
+            int lit = 1 + (int) (Random::rand()*1000000);
+            cls.push_back(Random::rand() < 0.5 ? -lit : lit);
+        }
+    }
+    return clauses;
+}
+
+void testConcurrentExport(int numShards, int numThreads, const std::vector<std::vector<int>>& clauses) {
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 30;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 1000000000;
+    AdaptiveClauseDatabase cdb(setup);
+    ProducedClauseFilter filter(/*epochHorizon=*/20, /*reshareImprovedLbd=*/false, numShards);
+
+    std::atomic_int numAdmitted {0};
+    std::atomic_int numFiltered {0};
+
+    // Each thread exports all clauses (in a different order),
+    // so each clause must be admitted exactly once
+    float time = Timer::elapsedSeconds();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t]() {
+            for (size_t i = 0; i < clauses.size(); i++) {
+                auto& cls = clauses[(i + t*clauses.size()/numThreads) % clauses.size()];
+                ProducedClauseCandidate pcc((int*) cls.data(), cls.size(),
+                    cls.size() == 1 ? 1 : 2, /*producerId=*/t, /*epoch=*/0);
+                auto result = filter.tryRegisterAndInsert(pcc, cdb);
+                if (result == ProducedClauseFilter::ADMITTED) numAdmitted++;
+                if (result == ProducedClauseFilter::FILTERED) numFiltered++;
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    time = Timer::elapsedSeconds() - time;
+
+    LOG(V2_INFO, "%i shards, %i threads : %.3f Mcls/s exported (%i admitted, %i filtered)\n",
+        numShards, numThreads, numThreads*clauses.size() / time / 1e6, numAdmitted.load(), numFiltered.load());
+
+    // Random clauses may coincide (as sets of literals), so allow for some slack
+    assert(numAdmitted <= clauses.size());
+    assert(numAdmitted >= 0.99 * clauses.size());
+    assert(numAdmitted + numFiltered == numThreads * clauses.size());
+
+    // Each clause must now have all threads as producers
+    for (auto& cls : clauses) {
+        std::vector<int> copy(cls);
+        Mallob::Clause c(copy.data(), copy.size(), copy.size() == 1 ? 1 : 2);
+        uint8_t expected = (1 << numThreads) - 1;
+        assert(filter.getProducers(c) == expected);
+    }
+}
+
+// Each thread exports all clauses via an export buffer in batches of (up to) 
+// the given number of integers, as solvers flush their learned clauses
+void testBatchedExport(int numThreads, int maxBatchSize, const std::vector<std::vector<int>>& clauses) {
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 30;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 1000000000;
+    AdaptiveClauseDatabase cdb(setup);
+    ProducedClauseFilter filter(/*epochHorizon=*/20, /*reshareImprovedLbd=*/false, 4*numThreads);
+    std::vector<SolverStatistics*> solverStats(numThreads, nullptr);
+    ExportBuffer exportBuffer(filter, cdb, solverStats, setup.maxClauseLength);
+
+    float time = Timer::elapsedSeconds();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; t++) {
+        threads.emplace_back([&, t]() {
+            std::vector<int> batch;
+            for (size_t i = 0; i < clauses.size(); i++) {
+                auto& cls = clauses[(i + t*clauses.size()/numThreads) % clauses.size()];
+                batch.push_back(cls.size());
+                batch.push_back(cls.size() == 1 ? 1 : 2);
+                batch.insert(batch.end(), cls.begin(), cls.end());
+                if (batch.size() >= maxBatchSize || i+1 == clauses.size()) {
+                    exportBuffer.produce(batch.data(), batch.size(), /*producerId=*/t, /*epoch=*/0);
+                    batch.clear();
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    time = Timer::elapsedSeconds() - time;
+
+    auto numAdmitted = exportBuffer.getAdmittedHistogram().getTotal();
+    auto numFiltered = exportBuffer.getFailedFilterHistogram().getTotal();
+    LOG(V2_INFO, "%i threads, batches of %i ints : %.3f Mcls/s exported (%llu admitted, %llu filtered)\n",
+        numThreads, maxBatchSize, numThreads*clauses.size() / time / 1e6, numAdmitted, numFiltered);
+
+    // Clauses may remain in the backlog if their filter shard was busy
+    assert(numAdmitted <= clauses.size());
+    assert(numAdmitted + numFiltered <= numThreads * clauses.size());
+    if (numThreads == 1) {
+        assert(numAdmitted >= 0.99 * clauses.size());
+        assert(numAdmitted + numFiltered == clauses.size());
+    }
+}
+
+struct CommutativeHasher {
+    static size_t hash(const int* lits, int size) {return Mallob::commutativeHash(lits, size, 3);}
+};
+
+void testLargeClauseTable(std::vector<std::vector<int>>& clauses) {
+
+    for (auto& cls : clauses) std::sort(cls.begin(), cls.end());
+
+    // Inline table
+    double rss = Proc::getRuntimeInfo(Proc::getPid(), Proc::FLAT).residentSetSize;
+    float time = Timer::elapsedSeconds();
+    InlineClauseTable<ClauseInfo, CommutativeHasher> table;
+    size_t numInserted = 0;
+    for (auto& cls : clauses) {
+        if (cls.size() < 3) continue;
+        size_t hash = CommutativeHasher::hash(cls.data(), cls.size());
+        if (table.find(cls.data(), cls.size(), hash) != nullptr) continue;
+        ClauseInfo info; info.producers = 1;
+        table.insert(cls.data(), cls.size(), hash, info);
+        numInserted++;
+    }
+    float insertTime = Timer::elapsedSeconds() - time;
+    time = Timer::elapsedSeconds();
+    for (auto& cls : clauses) {
+        if (cls.size() < 3) continue;
+        auto info = table.find(cls.data(), cls.size(), CommutativeHasher::hash(cls.data(), cls.size()));
+        assert(info != nullptr && info->producers == 1);
+    }
+    float findTime = Timer::elapsedSeconds() - time;
+    double rssDelta = Proc::getRuntimeInfo(Proc::getPid(), Proc::FLAT).residentSetSize - rss;
+    assert(table.size() == numInserted);
+    LOG(V2_INFO, "InlineClauseTable: %lu clauses, insert %.4fs, find %.4fs, %.1f MB allocated, RSS +%.1f MB\n",
+        table.size(), insertTime, findTime, table.getAllocatedBytes()/1e6, rssDelta/1000);
+
+    // Erase every other clause (as a garbage collection would), then insert new clauses:
+    // the emptied chunks of the arena are recycled
+    size_t allocatedBefore = table.getAllocatedBytes();
+    int parity = 0;
+    size_t numErased = table.eraseIf([&](ClauseInfo& info) {return (parity++ % 2) == 0;});
+    assert(numErased == (numInserted+1) / 2);
+    size_t allocatedAfterErase = table.getAllocatedBytes();
+    assert(allocatedAfterErase < allocatedBefore);
+    size_t numReinserted = 0;
+    for (auto& cls : clauses) {
+        if (cls.size() < 3) continue;
+        size_t hash = CommutativeHasher::hash(cls.data(), cls.size());
+        if (table.find(cls.data(), cls.size(), hash) != nullptr) continue;
+        ClauseInfo info; info.producers = 2;
+        table.insert(cls.data(), cls.size(), hash, info);
+        numReinserted++;
+    }
+    assert(numReinserted == numErased);
+    assert(table.size() == numInserted);
+    assert(table.getAllocatedBytes() <= allocatedBefore);
+    LOG(V2_INFO, "InlineClauseTable: %lu erased (%.1f MB allocated), %lu re-inserted (%.1f MB allocated)\n",
+        numErased, allocatedAfterErase/1e6, numReinserted, table.getAllocatedBytes()/1e6);
+
+    // Map of heap-allocated clauses
+    rss = Proc::getRuntimeInfo(Proc::getPid(), Proc::FLAT).residentSetSize;
+    time = Timer::elapsedSeconds();
+    tsl::robin_map<ProducedLargeClause, ClauseInfo, ProducedClauseHasher<ProducedLargeClause>, 
+        ProducedClauseEqualsCommutative<ProducedLargeClause>> map;
+    for (auto& cls : clauses) {
+        if (cls.size() < 3) continue;
+        Mallob::Clause c(cls.data(), cls.size(), 2);
+        ProducedLargeClause pc(c);
+        if (map.count(pc)) continue;
+        map.insert({std::move(pc), ClauseInfo()});
+    }
+    insertTime = Timer::elapsedSeconds() - time;
+    time = Timer::elapsedSeconds();
+    for (auto& cls : clauses) {
+        if (cls.size() < 3) continue;
+        ProducedLargeClause pc;
+        pc.size = cls.size();
+        pc.data = cls.data();
+        assert(map.count(pc));
+        pc.data = nullptr;
+    }
+    findTime = Timer::elapsedSeconds() - time;
+    rssDelta = Proc::getRuntimeInfo(Proc::getPid(), Proc::FLAT).residentSetSize - rss;
+    LOG(V2_INFO, "robin_map<ProducedLargeClause>: %lu clauses, insert %.4fs, find %.4fs, RSS +%.1f MB\n",
+        map.size(), insertTime, findTime, rssDelta/1000);
+}
+
+void testGarbageCollection(const std::vector<std::vector<int>>& clauses, size_t bloomFilterBits) {
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 30;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 1000000000;
+    AdaptiveClauseDatabase cdb(setup);
+    const int horizon = 4;
+    ProducedClauseFilter filter(horizon, /*reshareImprovedLbd=*/false, /*numShards=*/8, 
+        /*maxMemoryBytes=*/0, bloomFilterBits);
+
+    // Export each clause in a single epoch only (clauses i with i % numEpochs == epoch)
+    const int numEpochs = 3*horizon;
+    for (int epoch = 0; epoch < numEpochs; epoch++) {
+        for (size_t i = epoch; i < clauses.size(); i += numEpochs) {
+            auto& cls = clauses[i];
+            ProducedClauseCandidate pcc((int*) cls.data(), cls.size(), cls.size() == 1 ? 1 : 2, 0, epoch);
+            filter.tryRegisterAndInsert(pcc, cdb);
+        }
+        filter.collectGarbage(epoch);
+    }
+    LOG(V2_INFO, "GC (%lu Bloom filter bits): %lu clauses evicted, %.1f MB\n", bloomFilterBits, 
+        filter.getNumEvictedClauses(), filter.getMemoryUsage()/1e6);
+    // The Bloom filter counts towards the memory usage
+    assert(filter.getMemoryUsage() >= bloomFilterBits / 8);
+    // ... and takes at most a quarter of a memory limit
+    ProducedClauseFilter cappedFilter(horizon, /*reshareImprovedLbd=*/false, /*numShards=*/8, 
+        /*maxMemoryBytes=*/1<<20, bloomFilterBits);
+    assert(cappedFilter.getMemoryUsage() <= (1<<20) / 4);
+
+    // Clauses from recent epochs must be retained, clauses from old epochs must be gone
+    // (up to random clauses which coincide with a more recent clause)
+    const int lastEpoch = numEpochs-1;
+    size_t numOld = 0, numOldRetained = 0;
+    for (size_t i = 0; i < clauses.size(); i++) {
+        int age = lastEpoch - (i % numEpochs);
+        std::vector<int> copy(clauses[i]);
+        Mallob::Clause c(copy.data(), copy.size(), copy.size() == 1 ? 1 : 2);
+        if (age <= horizon) assert(filter.getProducers(c) == 1);
+        if (age > 2*horizon) {
+            numOld++;
+            if (filter.getProducers(c) != 0) numOldRetained++;
+        }
+    }
+    assert(numOldRetained <= 0.001 * numOld || log_return_false("%lu/%lu old clauses retained!\n", numOldRetained, numOld));
+    assert(filter.getNumEvictedClauses() > 0);
+
+    // Memory limit: entries are evicted until the limit is met. Each epoch sweeps a bounded
+    // number of shards, so the limit may be exceeded for a few epochs in a row
+    size_t limit = filter.getMemoryUsage() / 4;
+    ProducedClauseFilter limitedFilter(/*epochHorizon=*/-1, /*reshareImprovedLbd=*/false, /*numShards=*/8, limit);
+    int numEpochsOverLimit = 0;
+    size_t maxMemoryUsage = 0;
+    for (int epoch = 0; epoch < numEpochs; epoch++) {
+        for (size_t i = epoch; i < clauses.size(); i += numEpochs) {
+            auto& cls = clauses[i];
+            ProducedClauseCandidate pcc((int*) cls.data(), cls.size(), cls.size() == 1 ? 1 : 2, 0, epoch);
+            limitedFilter.tryRegisterAndInsert(pcc, cdb);
+        }
+        limitedFilter.collectGarbage(epoch);
+        if (limitedFilter.getMemoryUsage() > limit) numEpochsOverLimit++;
+        maxMemoryUsage = std::max(maxMemoryUsage, limitedFilter.getMemoryUsage());
+    }
+    // ... but not by much
+    assert(maxMemoryUsage <= 2*limit || log_return_false("%lu > 2*%lu bytes!\n", maxMemoryUsage, limit));
+    // The limit is met after a few more garbage collections
+    int numAdditionalEpochs = 0;
+    while (limitedFilter.getMemoryUsage() > limit) {
+        limitedFilter.collectGarbage(lastEpoch);
+        numAdditionalEpochs++;
+        assert(numAdditionalEpochs <= 16 || log_return_false("%lu > %lu bytes!\n", limitedFilter.getMemoryUsage(), limit));
+    }
+    LOG(V2_INFO, "GC with limit %.1f MB: %lu clauses evicted, %.1f MB (max. %.1f MB), %i/%i epochs over limit, +%i epochs\n", 
+        limit/1e6, limitedFilter.getNumEvictedClauses(), limitedFilter.getMemoryUsage()/1e6, maxMemoryUsage/1e6, 
+        numEpochsOverLimit, numEpochs, numAdditionalEpochs);
+    // Clauses of the most recent epoch are never evicted
+    for (size_t i = lastEpoch; i < clauses.size(); i += numEpochs) {
+        std::vector<int> copy(clauses[i]);
+        Mallob::Clause c(copy.data(), copy.size(), copy.size() == 1 ? 1 : 2);
+        assert(limitedFilter.getProducers(c) == 1);
+    }
+}
+
+// Looks up registered clauses while another thread keeps rebuilding the Bloom filter
+// (after each full sweep of the shards): no lookup may miss a registered clause.
+void testLookupsDuringBloomFilterRebuild(const std::vector<std::vector<int>>& clauses) {
+
+    AdaptiveClauseDatabase::Setup setup;
+    setup.maxClauseLength = 30;
+    setup.maxLbdPartitionedSize = 2;
+    setup.numLiterals = 1000000000;
+    AdaptiveClauseDatabase cdb(setup);
+    // (each call of collectGarbage sweeps all shards, but evicts nothing)
+    const int numEpochs = 100;
+    ProducedClauseFilter filter(/*epochHorizon=*/numEpochs, /*reshareImprovedLbd=*/false, /*numShards=*/1, 
+        /*maxMemoryBytes=*/0, ClauseFilter::getNumBitsFor(clauses.size()));
+    for (auto& cls : clauses) {
+        ProducedClauseCandidate pcc((int*) cls.data(), cls.size(), cls.size() == 1 ? 1 : 2, 0, 0);
+        filter.tryRegisterAndInsert(pcc, cdb);
+    }
+
+    std::atomic_bool done {false};
+    std::thread gcThread([&]() {
+        for (int epoch = 1; epoch <= numEpochs; epoch++) filter.collectGarbage(epoch);
+        done = true;
+    });
+    size_t numLookups = 0;
+    while (!done) {
+        auto& cls = clauses[numLookups++ % clauses.size()];
+        std::vector<int> copy(cls);
+        Mallob::Clause c(copy.data(), copy.size(), copy.size() == 1 ? 1 : 2);
+        assert(filter.getProducers(c) == 1 || log_return_false("Registered clause missed after %lu lookups!\n", numLookups));
+    }
+    gcThread.join();
+    assert(filter.getNumEvictedClauses() == 0);
+    LOG(V2_INFO, "%lu lookups during %i Bloom filter rebuilds\n", numLookups, numEpochs);
+}
+
+int main() {
+    Timer::init();
+    Random::init(rand(), rand());
+    Logger::init(0, V5_DEBG);
+
+    auto clauses = getClauses(100000);
+    for (int numThreads : {1, 4}) {
+        for (int numShards : {1, 4*numThreads}) {
+            testConcurrentExport(numShards, numThreads, clauses);
+        }
+    }
+
+    for (int numThreads : {1, 4}) {
+        for (int maxBatchSize : {1, 4096}) {
+            testBatchedExport(numThreads, maxBatchSize, clauses);
+        }
+    }
+
+    testGarbageCollection(clauses, 0);
+    testGarbageCollection(clauses, ClauseFilter::getNumBitsFor(/*expectedNumClauses=*/50000));
+    testLookupsDuringBloomFilterRebuild(clauses);
+
+    auto largeClauses = getClauses(1000000);
+    testLargeClauseTable(largeClauses);
+}
@@ -0,0 +1,198 @@
+
+#include <vector>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <unistd.h>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/params.hpp"
+#include "util/sys/timer.hpp"
+#include "util/sys/threading.hpp"
+#include "app/sat/solvers/portfolio_solver_interface.hpp"
+#include "app/sat/sharing/sharing_manager.hpp"
+#include "app/sat/execution/solver_thread.hpp"
+
+// Lets a solver of an incremental job learn clauses, hands the clauses retained by
+// its process over to a "restarted" process via the retained clauses file,
+// and checks that they arrive at a solver thread created by the new process.
+// Also checks that a sharing makes solvers hand over their pending learned clauses.
+
+class DummySolver : public PortfolioSolverInterface {
+
+private:
+    LearnedClauseCallback _callback;
+    Mutex _mtx;
+    std::vector<int> _added_lits;
+    std::atomic_bool _interrupted {false};
+
+public:
+    DummySolver(const SolverSetup& setup) : PortfolioSolverInterface(setup) {}
+
+    // Reports a learned clause to the sharing layer
+    void learn(const std::vector<int>& lits, int lbd) {
+        _callback(Mallob::Clause((int*) lits.data(), lits.size(), lbd), getLocalId());
+    }
+    std::vector<int> getAddedLiterals() {
+        auto lock = _mtx.getLock();
+        return _added_lits;
+    }
+
+    int getVariablesCount() override {return 0;}
+    int getSplittingVariable() override {return 0;}
+    void setPhase(const int var, const bool phase) override {}
+    SatResult solve(size_t numAssumptions, const int* assumptions) override {
+        while (!_interrupted) usleep(1000);
+        return UNKNOWN;
+    }
+    std::vector<int> getSolution() override {return std::vector<int>();}
+    std::set<int> getFailedAssumptions() override {return std::set<int>();}
+    void addLiteral(int lit) override {
+        auto lock = _mtx.getLock();
+        _added_lits.push_back(lit);
+    }
+    void setLearnedClauseCallback(const LearnedClauseCallback& callback) override {_callback = callback;}
+    void writeStatistics(SolverStatistics& stats) override {}
+    void diversify(int seed) override {}
+    int getNumOriginalDiversifications() override {return 1;}
+    bool supportsIncrementalSat() override {return false;}
+    bool exportsConditionalClauses() override {return false;}
+    void setSolverInterrupt() override {_interrupted = true;}
+    void unsetSolverInterrupt() override {_interrupted = false;}
+    void setSolverSuspend() override {}
+    void unsetSolverSuspend() override {}
+};
+
+SolverSetup getSetup(const Parameters& params) {
+    SolverSetup setup;
+    setup.logger = &Logger::getMainInstance();
+    setup.globalId = 0;
+    setup.localId = 0;
+    setup.jobname = "#1";
+    setup.diversificationIndex = 0;
+    setup.isJobIncremental = true;
+    setup.doIncrementalSolving = false;
+    setup.hasPseudoincrementalSolvers = true;
+    setup.solverType = 'c';
+    setup.solverRevision = 0;
+    setup.minNumChunksPerSolver = params.minNumChunksForImportPerSolver();
+    setup.numBufferedClsGenerations = params.bufferedImportedClsGenerations();
+    setup.strictClauseLengthLimit = params.strictClauseLengthLimit();
+    setup.strictLbdLimit = params.strictLbdLimit();
+    setup.qualityClauseLengthLimit = params.qualityClauseLengthLimit();
+    setup.qualityLbdLimit = params.qualityLbdLimit();
+    setup.clauseBaseBufferSize = params.clauseBufferBaseSize();
+    setup.anticipatedLitsToImportPerCycle = 1000;
+    setup.skipClauseSharingDiagonally = false;
+    return setup;
+}
+
+std::set<std::vector<int>> getClauseSet(const std::vector<int>& clauses) {
+    std::set<std::vector<int>> set;
+    for (size_t pos = 0; pos < clauses.size(); pos += 2+clauses[pos]) {
+        std::vector<int> lits(clauses.begin()+pos+2, clauses.begin()+pos+2+clauses[pos]);
+        std::sort(lits.begin(), lits.end());
+        set.insert(lits);
+    }
+    return set;
+}
+
+// A solver learns a few clauses, which remain in its export batch (neither full
+// nor checked for its age yet), until a sharing requests them: the solver then hands
+// them over along with its next clause.
+void testRequestedExportFlush(const Parameters& params) {
+    std::vector<std::shared_ptr<PortfolioSolverInterface>> solvers;
+    auto solver = std::make_shared<DummySolver>(getSetup(params));
+    solvers.push_back(solver);
+    SharingManager sharingManager(solvers, params, Logger::getMainInstance(), 1000, 0);
+    std::vector<std::vector<int>> learned {{-3}, {4, -5}, {1, 6, -8}};
+    for (auto& lits : learned) solver->learn(lits, std::min(2, (int)lits.size()));
+
+    sharingManager.prepareSharing(1000);
+    assert(sharingManager.getStatistics().exportedClauses == 0);
+
+    learned.push_back({2, -7, 9, 10});
+    solver->learn(learned.back(), 2);
+    sharingManager.prepareSharing(1000);
+    auto numExported = sharingManager.getStatistics().exportedClauses;
+    assert(numExported == learned.size() || log_return_false("[ERROR] %lu/%lu clauses exported\n",
+        numExported, learned.size()));
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    Parameters params;
+    params.retainedClauseLiterals.set(1000);
+    std::string filename = "/tmp/mallob_test_retained_clauses." + std::to_string(getpid());
+
+    testRequestedExportFlush(params);
+
+    // "Old" process: one solver learns a few clauses
+    std::vector<std::vector<int>> learned {{5}, {-1, 2}, {3, -4, 6}, {-2, 7, 8, -9}};
+    {
+        std::vector<std::shared_ptr<PortfolioSolverInterface>> solvers;
+        auto solver = std::make_shared<DummySolver>(getSetup(params));
+        solvers.push_back(solver);
+        SharingManager sharingManager(solvers, params, Logger::getMainInstance(), 1000, 0);
+        for (auto& lits : learned) solver->learn(lits, std::min(2, (int)lits.size()));
+        solver->flushLearnedClauses();
+
+        auto retained = getClauseSet(sharingManager.getRetainedClauses());
+        assert(retained.size() == learned.size());
+        // retained clauses remain retained
+        assert(getClauseSet(sharingManager.getRetainedClauses()) == retained);
+        assert(sharingManager.writeRetainedClauses(filename));
+    }
+
+    // "New" process: reads the clauses and hands them to a new solver thread
+    std::vector<std::shared_ptr<PortfolioSolverInterface>> solvers;
+    auto solver = std::make_shared<DummySolver>(getSetup(params));
+    solvers.push_back(solver);
+    SharingManager sharingManager(solvers, params, Logger::getMainInstance(), 1000, 0);
+    sharingManager.readRetainedClauses(filename);
+    assert(access(filename.c_str(), F_OK) != 0); // file was consumed
+    auto retained = sharingManager.getRetainedClauses();
+    assert(getClauseSet(retained).size() == learned.size());
+
+    std::vector<int> formula {1, 2, 0, -1, 0};
+    SatProcessConfig config;
+    config.apprank = 0;
+    config.mpisize = 1;
+    config.threads = 1;
+    SolverThread thread(params, config, solver, formula.size(), formula.data(), 0, nullptr, 0);
+    thread.setRetainedClauses(std::move(retained));
+    thread.start();
+
+    // Wait until the solver received the retained clauses and the formula
+    std::vector<int> added;
+    float time = Timer::elapsedSeconds();
+    while (added.size() < formula.size() + 4 + 1+2+3+4 && Timer::elapsedSeconds() - time < 10) {
+        usleep(1000);
+        added = solver->getAddedLiterals();
+    }
+    thread.setTerminate();
+    solver->interrupt();
+    thread.tryJoin();
+
+    std::set<std::vector<int>> addedClauses;
+    std::vector<int> lits;
+    for (int lit : added) {
+        if (lit != 0) {
+            lits.push_back(lit);
+            continue;
+        }
+        std::sort(lits.begin(), lits.end());
+        addedClauses.insert(lits);
+        lits.clear();
+    }
+    for (auto lits : learned) {
+        std::sort(lits.begin(), lits.end());
+        assert(addedClauses.count(lits));
+    }
+    LOG(V2_INFO, "%lu literals reached the new solver\n", added.size());
+}
@@ -0,0 +1,70 @@
+
+#include <vector>
+#include <list>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "util/ring_allocator.hpp"
+
+void testBasic() {
+    RingAllocator alloc(10);
+    long a = alloc.allocate(4);
+    long b = alloc.allocate(4);
+    assert(a == 0 && b == 4);
+    assert(alloc.allocate(4) == -1); // only 2 left at the end, no space at the front
+    alloc.release(a);
+    long c = alloc.allocate(3); // wraps around
+    assert(c == 0);
+    assert(alloc.allocate(2) == -1); // [3,4) is too small
+    // Released out of order: space becomes free only with the oldest region
+    alloc.release(c);
+    assert(alloc.getNumAllocatedRegions() == 2);
+    alloc.release(b);
+    assert(alloc.getNumAllocatedRegions() == 0);
+    assert(alloc.allocate(10) == 0);
+}
+
+void testRandomized() {
+    const size_t capacity = 1000;
+    RingAllocator alloc(capacity);
+    std::vector<int> owner(capacity, -1);
+    struct Region {long offset; size_t size; int id;};
+    std::list<Region> regions;
+    int numAllocated = 0, numFailed = 0;
+    for (int i = 0; i < 100000; i++) {
+        if (Random::rand() < 0.5 || regions.empty()) {
+            size_t size = 1 + (size_t) (Random::rand() * 200);
+            long offset = alloc.allocate(size);
+            if (offset < 0) {
+                numFailed++;
+                continue;
+            }
+            assert(offset + size <= capacity);
+            for (size_t j = offset; j < offset+size; j++) {
+                assert(owner[j] == -1 || log_return_false("Overlap at %lu\n", j));
+                owner[j] = i;
+            }
+            regions.push_back(Region{offset, size, i});
+            numAllocated++;
+        } else {
+            // Release some region, preferably an old one
+            auto it = regions.begin();
+            while (std::next(it) != regions.end() && Random::rand() < 0.3) ++it;
+            for (size_t j = it->offset; j < it->offset + it->size; j++) owner[j] = -1;
+            alloc.release(it->offset);
+            regions.erase(it);
+        }
+    }
+    LOG(V2_INFO, "%i allocations, %i failed\n", numAllocated, numFailed);
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    testBasic();
+    testRandomized();
+}
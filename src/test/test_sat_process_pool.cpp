@@ -0,0 +1,146 @@
+
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "util/assert.hpp"
+#include "util/logger.hpp"
+#include "util/params.hpp"
+#include "util/sys/timer.hpp"
+#include "util/sys/process.hpp"
+#include "util/sys/proc.hpp"
+#include "util/sys/shared_memory.hpp"
+#include "util/sys/thread_pool.hpp"
+#include "comm/mympi.hpp"
+#include "app/sat/job/sat_process_config.hpp"
+#include "app/sat/job/sat_process_pool.hpp"
+
+// Measures the time from a job's launch of its SAT process until the process runs
+// the job's code, for a cold start (launching a new process, as without -spps) and
+// for a pooled start (adopting a pre-started process). This test program itself acts
+// as the SAT process: it performs the startup of the SAT process' main function and
+// then reports the time when it would construct the SAT process.
+
+const int numJobs = 20;
+
+std::string getStartedShmemId(pid_t parentPid, int jobId) {
+    return "/edu.kit.iti.mallob." + std::to_string(parentPid) + ".poolstart." + std::to_string(jobId);
+}
+
+// Startup as in app/sat/main.cpp
+int runAsSatProcess(int argc, char** argv) {
+    Parameters params;
+    params.init(argc, argv);
+    SatProcessConfig config(params.satEngineConfig());
+    timespec t;
+    t.tv_sec = config.starttimeSecs;
+    t.tv_nsec = config.starttimeNsecs;
+    Timer::init(t);
+    ProcessWideThreadPool::init(1);
+    Process::init(config.mpirank, params.traceDirectory(), /*leafProcess=*/true);
+    Logger::init(config.mpirank, params.verbosity());
+
+    if (params.satProcessPoolSlot.isSet()) {
+        if (!SatProcessPool::awaitAdoption(params.satProcessPoolSlot(), params)) {
+            Process::doExit(0);
+        }
+        config = SatProcessConfig(params.satEngineConfig());
+    }
+
+    // Report the time at which the job's code would begin
+    float* started = (float*) SharedMemory::access(getStartedShmemId(Proc::getParentPid(), config.jobid), sizeof(float));
+    assert(started != nullptr);
+    *((volatile float*) started) = Timer::elapsedSeconds();
+    Process::doExit(0);
+    return 0;
+}
+
+Parameters getJobParams(const Parameters& params, int jobId) {
+    SatProcessConfig config;
+    auto t = Timer::getStartTime();
+    config.starttimeSecs = t.tv_sec;
+    config.starttimeNsecs = t.tv_nsec;
+    config.mpirank = 0;
+    config.mpisize = 1;
+    config.apprank = 0;
+    config.jobid = jobId;
+    config.incremental = false;
+    config.firstrev = 0;
+    config.threads = 1;
+    config.maxBroadcastedLitsPerCycle = config.recoveryIndex = 0;
+    Parameters jobParams(params);
+    jobParams.satEngineConfig.set(config.toString());
+    return jobParams;
+}
+
+// Returns the time from the launch or adoption of the process until it reports
+float measureStart(const Parameters& params, const std::string& program, int jobId, bool pooled) {
+    std::string shmemId = getStartedShmemId(Proc::getPid(), jobId);
+    volatile float* started = (volatile float*) SharedMemory::create(shmemId, sizeof(float));
+    *started = 0;
+
+    Parameters jobParams = getJobParams(params, jobId);
+    float launchTime = Timer::elapsedSeconds();
+    pid_t pid;
+    if (pooled) {
+        pid = SatProcessPool::adopt(jobParams);
+    } else {
+        char* const* argv = jobParams.asCArgs(program.c_str());
+        pid = Process::spawnChild(argv);
+        delete[] ((const char**) argv);
+    }
+    assert(pid > 0);
+    while (*started == 0) usleep(10);
+    float latency = *started - launchTime;
+
+    if (pooled) SatProcessPool::replenish();
+    while (!Process::didChildExit(pid)) usleep(100);
+    SharedMemory::free(shmemId, (char*) started, sizeof(float));
+    return latency;
+}
+
+void report(const char* label, std::vector<float>& latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    float sum = 0;
+    for (float l : latencies) sum += l;
+    LOG(V2_INFO, "%s start: median %.3fms, avg %.3fms, max %.3fms (%lu jobs)\n", label,
+        1000 * latencies[latencies.size()/2], 1000 * sum / latencies.size(), 1000 * latencies.back(),
+        latencies.size());
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1) return runAsSatProcess(argc, argv);
+
+    MPI_Init(&argc, &argv);
+    Timer::init();
+    Logger::init(0, V5_DEBG);
+    Process::init(0, "", /*leafProcess=*/false);
+
+    char program[4096];
+    ssize_t len = readlink("/proc/self/exe", program, sizeof(program)-1);
+    assert(len > 0);
+    program[len] = '\0';
+
+    Parameters params;
+    params.verbosity.set(0);
+    params.satProcessPoolSize.set(2);
+
+    std::vector<float> cold, pooled;
+    for (int i = 0; i < numJobs; i++) cold.push_back(measureStart(params, program, i, false));
+
+    SatProcessPool::init(params, program);
+    for (int i = 0; i < numJobs; i++) {
+        // Adopt once the replacement of the previously adopted process is ready
+        usleep(100'000);
+        pooled.push_back(measureStart(params, program, numJobs+i, true));
+    }
+    SatProcessPool::shutdown();
+
+    report("cold", cold);
+    report("pooled", pooled);
+    std::sort(cold.begin(), cold.end());
+    assert(pooled[pooled.size()/2] < cold[cold.size()/2]);
+
+    MPI_Finalize();
+}
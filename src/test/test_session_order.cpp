@@ -0,0 +1,163 @@
+
+#include <list>
+#include <vector>
+
+#include "util/assert.hpp"
+#include "util/random.hpp"
+#include "util/logger.hpp"
+#include "util/sys/timer.hpp"
+#include "app/sat/job/session_order.hpp"
+
+// Simulates a job with several job-wide sharing sessions (epochs) in flight at once,
+// whose all-reductions finish after random delays and thus out of order, plus
+// host-level sessions in between. Checks that the sessions take the job's prepared
+// clauses in the order of their creation and that only one session at a time filters
+// and digests its clauses, in the order of the epochs.
+
+struct FakeSession {
+    int _seq;
+    int epoch;
+    bool hostLevel;
+    bool hasClauses {false};
+    int roundsOfReduction;
+    bool filtering {false};
+    int roundsOfFiltering;
+    bool concluded {false};
+
+    bool isValid() const {return !concluded;}
+    bool isLocallyDigested() const {return concluded;}
+};
+
+struct FakeJob {
+    bool preparingClauses {false};
+    bool hasPreparedClauses {false};
+    const FakeSession* filteringSession {nullptr};
+    std::vector<int> seqsTakingClauses;
+    std::vector<int> epochsFiltering;
+    std::vector<int> epochsDigesting;
+};
+
+void takeClauses(FakeJob& job, FakeSession& session, bool oldestWithoutClauses) {
+    if (session.hasClauses || !oldestWithoutClauses) return;
+    if (!job.hasPreparedClauses) {
+        // Clauses become available in the next round
+        job.preparingClauses = true;
+        return;
+    }
+    job.hasPreparedClauses = false;
+    job.seqsTakingClauses.push_back(session._seq);
+    session.hasClauses = true;
+}
+
+void advance(FakeJob& job, FakeSession& session, bool oldestWithoutClauses, bool mayFilter) {
+    takeClauses(job, session, oldestWithoutClauses);
+    if (!session.hasClauses) return;
+    if (session.roundsOfReduction > 0) {
+        session.roundsOfReduction--;
+        return;
+    }
+    if (!session.filtering) {
+        if (!mayFilter) return;
+        // The job filters and digests one sharing at a time
+        assert(job.filteringSession == nullptr || log_return_false("[ERROR] epoch %i filters while epoch %i does\n",
+            session.epoch, job.filteringSession->epoch));
+        job.filteringSession = &session;
+        job.epochsFiltering.push_back(session.epoch);
+        session.filtering = true;
+        return;
+    }
+    if (session.roundsOfFiltering > 0) {
+        session.roundsOfFiltering--;
+        return;
+    }
+    assert(job.filteringSession == &session);
+    job.filteringSession = nullptr;
+    job.epochsDigesting.push_back(session.epoch);
+    session.concluded = true;
+}
+
+void advanceHost(FakeJob& job, FakeSession& session, bool oldestWithoutClauses) {
+    takeClauses(job, session, oldestWithoutClauses);
+    if (!session.hasClauses) return;
+    if (session.roundsOfReduction > 0) {
+        session.roundsOfReduction--;
+        return;
+    }
+    session.concluded = true;
+}
+
+void testOverlappingEpochs(int maxSessionsInFlight, int numEpochs) {
+    FakeJob job;
+    std::list<FakeSession> sessions, hostSessions;
+    int nextSeq = 0, nextEpoch = 0;
+    int maxValidSessions = 0;
+    int numHostSessions = 0;
+    int round = 0;
+
+    auto getNumValid = [&]() {
+        int num = 0;
+        for (auto& s : sessions) if (s.isValid()) num++;
+        return num;
+    };
+
+    while (nextEpoch < numEpochs || getNumValid() > 0) {
+        assert(round < 100'000);
+
+        // Initiate new sessions
+        if (nextEpoch < numEpochs && getNumValid() < maxSessionsInFlight && Random::rand() < 0.5) {
+            sessions.push_back(FakeSession {nextSeq++, nextEpoch++, false});
+            sessions.back().roundsOfReduction = (int) (Random::rand() * 20);
+            sessions.back().roundsOfFiltering = (int) (Random::rand() * 5);
+        }
+        if (hostSessions.empty() && Random::rand() < 0.2) {
+            hostSessions.push_back(FakeSession {nextSeq++, -1, true});
+            hostSessions.back().roundsOfReduction = (int) (Random::rand() * 5);
+            numHostSessions++;
+        }
+        maxValidSessions = std::max(maxValidSessions, getNumValid());
+
+        SessionOrder::advance(sessions, hostSessions,
+            [&](const FakeSession& session) {return session.isValid() && !session.hasClauses;},
+            [&](FakeSession& session, bool oldestWithoutClauses, bool mayFilter) {
+                advance(job, session, oldestWithoutClauses, mayFilter);
+            },
+            [&](FakeSession& session, bool oldestWithoutClauses) {
+                advanceHost(job, session, oldestWithoutClauses);
+            }
+        );
+
+        if (job.preparingClauses) {
+            job.preparingClauses = false;
+            job.hasPreparedClauses = true;
+        }
+        while (!sessions.empty() && !sessions.front().isValid()) sessions.pop_front();
+        while (!hostSessions.empty() && !hostSessions.front().isValid()) hostSessions.pop_front();
+        round++;
+    }
+
+    // Clauses were taken by each session in the order of creation
+    assert(job.seqsTakingClauses.size() >= numEpochs);
+    for (size_t i = 1; i < job.seqsTakingClauses.size(); i++)
+        assert(job.seqsTakingClauses[i-1] < job.seqsTakingClauses[i]);
+    // Each epoch filtered and digested exactly once, in the order of the epochs
+    assert(job.epochsFiltering.size() == numEpochs);
+    assert(job.epochsDigesting.size() == numEpochs);
+    for (int e = 0; e < numEpochs; e++) {
+        assert(job.epochsFiltering[e] == e);
+        assert(job.epochsDigesting[e] == e);
+    }
+    // The sessions did overlap
+    assert(maxSessionsInFlight == 1 || maxValidSessions > 1);
+    LOG(V2_INFO, "%i epochs, up to %i (%i) in flight, %i host-level sessions: %i rounds\n",
+        numEpochs, maxValidSessions, maxSessionsInFlight, numHostSessions, round);
+}
+
+int main() {
+    Timer::init();
+    Random::init(1, 1);
+    Logger::init(0, V5_DEBG);
+
+    for (int maxSessionsInFlight : {1, 2, 4, 8}) {
+        for (int i = 0; i < 10; i++) testOverlappingEpochs(maxSessionsInFlight, 100);
+    }
+}
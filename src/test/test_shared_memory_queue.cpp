@@ -0,0 +1,102 @@
+
+#include <unistd.h>
+#include <sys/wait.h>
+#include <new>
+#include <string>
+
+#include "util/assert.hpp"
+#include "util/sys/timer.hpp"
+#include "util/sys/shared_memory.hpp"
+#include "util/sys/shared_memory_queue.hpp"
+#include "util/sys/futex.hpp"
+#include "util/logger.hpp"
+
+// Parent and child process exchange tasks and responses via shared memory,
+// either blocking on doorbells or polling with short sleeps (as done before).
+
+struct Channel {
+    SharedMemoryQueue<int, 16> tasks;
+    SharedMemoryQueue<int, 16> responses;
+    SharedMemoryDoorbell childDoorbell;
+    SharedMemoryDoorbell parentDoorbell;
+};
+
+void testQueueInProcess() {
+    SharedMemoryQueue<int, 8> queue;
+    int elem;
+    assert(queue.empty());
+    assert(!queue.pop(elem)); // no side effect on an empty queue
+    for (int round = 0; round < 5; round++) {
+        for (int i = 0; i < 8; i++) {
+            bool success = queue.push(8*round+i);
+            assert(success);
+        }
+        bool success = queue.push(-1);
+        assert(!success);
+        for (int i = 0; i < 8; i++) {
+            success = queue.pop(elem);
+            assert(success);
+            assert(elem == 8*round+i);
+        }
+        assert(queue.empty());
+    }
+}
+
+// Returns the value of the next element popped from the queue
+template <typename Q>
+int awaitElement(Q& queue, SharedMemoryDoorbell& doorbell, bool polling) {
+    int elem;
+    while (true) {
+        int rings = doorbell.peek();
+        if (queue.pop(elem)) return elem;
+        if (polling) usleep(1000);
+        else doorbell.waitUntilRung(rings, 1);
+    }
+}
+
+void testRoundTrips(bool polling, int numRoundTrips) {
+
+    std::string shmemId = "/edu.kit.iti.mallob.test_shmem_queue." + std::to_string(getpid());
+    auto channel = new (SharedMemory::create(shmemId, sizeof(Channel))) Channel();
+
+    pid_t child = fork();
+    if (child == 0) {
+        // Echo each task back to the parent until receiving -1
+        while (true) {
+            int task = awaitElement(channel->tasks, channel->childDoorbell, polling);
+            channel->responses.push(task);
+            channel->parentDoorbell.ring();
+            if (task == -1) _exit(0);
+        }
+    }
+
+    float sumLatency = 0, maxLatency = 0;
+    for (int i = 0; i <= numRoundTrips; i++) {
+        int task = i == numRoundTrips ? -1 : i;
+        float time = Timer::elapsedSeconds();
+        bool success = channel->tasks.push(task);
+        assert(success);
+        channel->childDoorbell.ring();
+        int response = awaitElement(channel->responses, channel->parentDoorbell, polling);
+        assert(response == task);
+        time = Timer::elapsedSeconds() - time;
+        sumLatency += time;
+        maxLatency = std::max(maxLatency, time);
+    }
+    int status;
+    waitpid(child, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    SharedMemory::free(shmemId, (char*) channel, sizeof(Channel));
+
+    LOG(V2_INFO, "%s: %i round trips, avg %.1fus, max %.1fus\n", polling ? "polling" : "doorbell",
+        numRoundTrips, 1e6 * sumLatency / (numRoundTrips+1), 1e6 * maxLatency);
+}
+
+int main() {
+    Timer::init();
+    Logger::init(0, V5_DEBG);
+
+    testQueueInProcess();
+    testRoundTrips(/*polling=*/false, 10000);
+    testRoundTrips(/*polling=*/true, 200);
+}
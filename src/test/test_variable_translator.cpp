@@ -11,6 +11,40 @@
 #include "util/sys/timer.hpp"
 #include "app/sat/execution/variable_translator.hpp"
 
+// Former translator which scans all extra variables for each literal
+class LinearVariableTranslator {
+
+private:
+    std::vector<int> _extra_variables;
+
+public:
+    void addExtraVariable(int latestOrigMaxVar) {
+        int tldMaxVar = getTldLit(latestOrigMaxVar);
+        do tldMaxVar++; while (!_extra_variables.empty() && _extra_variables.back() >= tldMaxVar);
+        _extra_variables.push_back(tldMaxVar);
+    }
+    int getTldLit(int origLit) {
+        int absLit = std::abs(origLit);
+        for (int tldExtraVar : _extra_variables) {
+            if (tldExtraVar > absLit) break;
+            absLit++;
+        }
+        return (origLit>0?1:-1) * absLit;
+    }
+    int getOrigLitOrZero(int tldLit) {
+        int absLit = std::abs(tldLit);
+        int shift = 0;
+        for (int tldExtraVar : _extra_variables) {
+            if (tldExtraVar >= absLit) {
+                if (tldExtraVar == absLit) return 0; // is an extra var!
+                break;
+            }
+            shift++;
+        }
+        return (tldLit>0?1:-1) * (absLit-shift);
+    }
+};
+
 void test() {
     LOG(V2_INFO, "Testing variable translator ...\n");
     
@@ -88,9 +122,54 @@ void test() {
     assert(vt.getOrigLitOrZero(35) == 31);
 }
 
+// Many revisions, some of which (the given share) introduce no new variables:
+// compare both translators and measure the time per translated literal
+void testManyRevisions(int numRevisions, float shareWithoutNewVars) {
+    LOG(V2_INFO, "Testing %i revisions ...\n", numRevisions);
+
+    VariableTranslator vt;
+    LinearVariableTranslator linearVt;
+    int maxVar = 0;
+    for (int r = 0; r < numRevisions; r++) {
+        if (Random::rand() >= shareWithoutNewVars) maxVar += (int) (Random::rand() * 100);
+        vt.addExtraVariable(maxVar);
+        linearVt.addExtraVariable(maxVar);
+    }
+    int maxTldVar = vt.getTldLit(maxVar) + 10;
+    for (int var = 0; var <= maxVar + 10; var++) {
+        assert(vt.getTldLit(var) == linearVt.getTldLit(var));
+        assert(vt.getTldLit(-var) == linearVt.getTldLit(-var));
+    }
+    for (int var = 0; var <= maxTldVar; var++) {
+        assert(vt.getOrigLitOrZero(var) == linearVt.getOrigLitOrZero(var));
+        assert(vt.getOrigLitOrZero(-var) == linearVt.getOrigLitOrZero(-var));
+    }
+
+    // Translate random literals of the original formula back and forth
+    std::vector<int> lits;
+    for (int i = 0; i < 1000000; i++) {
+        int var = 1 + (int) (Random::rand() * maxVar);
+        lits.push_back(Random::rand() < 0.5 ? -var : var);
+    }
+    long checksum = 0;
+    float time = Timer::elapsedSeconds();
+    for (int lit : lits) checksum += vt.getOrigLitOrZero(vt.getTldLit(lit));
+    time = Timer::elapsedSeconds() - time;
+    float linearTime = Timer::elapsedSeconds();
+    long linearChecksum = 0;
+    for (int lit : lits) linearChecksum += linearVt.getOrigLitOrZero(linearVt.getTldLit(lit));
+    linearTime = Timer::elapsedSeconds() - linearTime;
+    assert(checksum == linearChecksum);
+    LOG(V2_INFO, "%i revisions, %i vars: %.4fs (rank/select) vs. %.4fs (linear) for %lu lits, %.2f bits per var\n", 
+        numRevisions, maxVar, time, linearTime, lits.size(), 8.0 * vt.getMemoryBytes() / maxTldVar);
+}
+
 int main() {
     Timer::init();
     Random::init(rand(), rand());
     Logger::init(0, V5_DEBG);
     test();
+    for (int numRevisions : {1, 10, 100, 10000}) testManyRevisions(numRevisions, 0.2);
+    // Long runs of consecutive extra variables
+    for (float shareWithoutNewVars : {0.9f, 0.999f}) testManyRevisions(10000, shareWithoutNewVars);
 }
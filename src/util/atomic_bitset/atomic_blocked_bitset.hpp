@@ -0,0 +1,93 @@
+
+#pragma once
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+/*
+ * An atomic bitset organized in cache-line sized blocks of 512 bits each.
+ * All operations work on a single block at a time with a full 512-bit mask,
+ * which allows to query or set several bits with a single cache miss.
+ */
+class AtomicBlockedBitset {
+
+public:
+    static constexpr size_t WORDS_PER_BLOCK = 8;
+    static constexpr size_t BITS_PER_BLOCK = 64 * WORDS_PER_BLOCK;
+
+    struct Mask {
+        uint64_t words[WORDS_PER_BLOCK] = {0};
+    };
+
+private:
+    struct alignas(64) Block {
+        std::atomic<uint64_t> words[WORDS_PER_BLOCK];
+        Block() {
+            for (size_t i = 0; i < WORDS_PER_BLOCK; i++) words[i].store(0, std::memory_order_relaxed);
+        }
+        Block(const Block& other) {
+            for (size_t i = 0; i < WORDS_PER_BLOCK; i++)
+                words[i].store(other.words[i].load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    };
+    static_assert(sizeof(Block) == 64);
+
+    std::vector<Block> _blocks;
+
+public:
+    AtomicBlockedBitset(size_t numBlocks) : _blocks(numBlocks == 0 ? 1 : numBlocks) {}
+
+    size_t getNumBlocks() const {return _blocks.size();}
+    size_t size() const {return _blocks.size() * BITS_PER_BLOCK;}
+
+    // Returns true iff all bits of the mask are set in the specified block.
+    // The check is performed with relaxed memory order.
+    bool testMask(size_t blockIdx, const Mask& mask) const {
+        const Block& block = _blocks[blockIdx];
+#if defined(__AVX2__)
+        // Relaxed, possibly torn 256-bit loads: each 64-bit lane is read atomically on x86-64,
+        // which is all we need since the bits are only ever set within a word.
+        const __m256i* data = reinterpret_cast<const __m256i*>(block.words);
+        const __m256i* maskData = reinterpret_cast<const __m256i*>(mask.words);
+        __m256i lo = _mm256_load_si256(data);
+        __m256i hi = _mm256_load_si256(data+1);
+        // testc: returns 1 iff (~block & mask) == 0
+        return _mm256_testc_si256(lo, _mm256_loadu_si256(maskData))
+            && _mm256_testc_si256(hi, _mm256_loadu_si256(maskData+1));
+#else
+        uint64_t missing = 0;
+        for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+            missing |= mask.words[i] & ~block.words[i].load(std::memory_order_relaxed);
+        }
+        return missing == 0;
+#endif
+    }
+
+    // Sets all bits of the mask in the specified block. Returns true iff at least one
+    // of these bits was previously unset (i.e., this call changed the bitset).
+    bool setMask(size_t blockIdx, const Mask& mask) {
+        Block& block = _blocks[blockIdx];
+        bool changed = false;
+        for (size_t i = 0; i < WORDS_PER_BLOCK; i++) {
+            if (mask.words[i] == 0) continue;
+            // Only write to words which are actually missing bits
+            if ((block.words[i].load(std::memory_order_relaxed) & mask.words[i]) == mask.words[i]) continue;
+            uint64_t prev = block.words[i].fetch_or(mask.words[i], std::memory_order_relaxed);
+            changed |= (prev & mask.words[i]) != mask.words[i];
+        }
+        return changed;
+    }
+
+    void reset() {
+        for (auto& block : _blocks) {
+            for (size_t i = 0; i < WORDS_PER_BLOCK; i++)
+                block.words[i].store(0, std::memory_order_relaxed);
+        }
+    }
+};
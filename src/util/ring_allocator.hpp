@@ -0,0 +1,68 @@
+
+#pragma once
+
+#include <list>
+#include <algorithm>
+#include "util/assert.hpp"
+#include "util/logger.hpp"
+
+// Allocates contiguous regions of an array of fixed capacity in a circular fashion:
+// new regions are placed behind the most recently allocated region (or at the beginning
+// of the array if the remaining space at its end does not suffice). Regions can be released
+// in any order, but the space of a region is only reused once all regions allocated
+// before it have been released as well. The array itself is not managed by this class,
+// so it can reside e.g. in shared memory.
+class RingAllocator {
+
+private:
+    struct Region {
+        size_t offset;
+        size_t size;
+        bool released;
+    };
+    size_t _capacity;
+    // All regions which occupy space, in order of allocation
+    std::list<Region> _regions;
+
+public:
+    RingAllocator(size_t capacity = 0) : _capacity(capacity) {}
+
+    // Returns the offset of a newly allocated region of the given size
+    // or -1 if there is not enough contiguous space right now.
+    long allocate(size_t size) {
+        size = std::max(size, (size_t) 1); // each region has a unique offset
+        if (_regions.empty()) return place(0, size);
+        size_t head = _regions.front().offset;
+        size_t end = _regions.back().offset + _regions.back().size;
+        if (_regions.back().offset >= head) {
+            // Occupied space does not wrap around: [head, end)
+            if (_capacity - end >= size) return place(end, size);
+            if (head > size) return place(0, size); // keep head != end to tell "full" apart
+            return -1;
+        }
+        // Occupied space wraps around: [head, capacity) and [0, end)
+        if (head - end > size) return place(end, size);
+        return -1;
+    }
+
+    void release(size_t offset) {
+        bool found = false;
+        for (auto& region : _regions) if (region.offset == offset && !region.released) {
+            region.released = true;
+            found = true;
+            break;
+        }
+        assert(found || log_return_false("Region at %lu not allocated\n", offset));
+        while (!_regions.empty() && _regions.front().released) _regions.pop_front();
+    }
+
+    size_t getCapacity() const {return _capacity;}
+    size_t getNumAllocatedRegions() const {return _regions.size();}
+
+private:
+    long place(size_t offset, size_t size) {
+        if (offset + size > _capacity) return -1;
+        _regions.push_back(Region{offset, size, false});
+        return offset;
+    }
+};
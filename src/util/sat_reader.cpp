@@ -10,17 +10,33 @@
 
 #include "sat_reader.hpp"
 #include "util/sys/terminator.hpp"
+#include "util/sys/process.hpp"
 
 bool SatReader::read(JobDescription& desc) {
 
 	FILE* pipe = nullptr;
 	int namedpipe = -1;
+	pid_t decompressorPid = -1;
 	if ((_filename.size() > 3 && _filename.substr(_filename.size()-3, 3) == ".xz")
 		|| (_filename.size() > 5 && _filename.substr(_filename.size()-5, 5) == ".lzma")) {
 		// Decompress, read output
-		auto command = "xz -c -d " + _filename;
-		pipe = popen(command.c_str(), "r");
-		if (pipe == nullptr) return false;
+		// (spawned instead of popen'd, which would fork this process)
+		int fds[2];
+		if (pipe2(fds, O_CLOEXEC) == -1) return false;
+		const char* argv[] = {"xz", "-c", "-d", _filename.c_str(), nullptr};
+		decompressorPid = Process::spawnChild((char* const*) argv, fds[1]);
+		close(fds[1]);
+		if (decompressorPid == -1) {
+			close(fds[0]);
+			return false;
+		}
+		pipe = fdopen(fds[0], "r");
+		if (pipe == nullptr) {
+			close(fds[0]);
+			Process::hardkill(decompressorPid);
+			while (!Process::didChildExit(decompressorPid)) usleep(1000);
+			return false;
+		}
 	} else if (_filename.size() > 5 && _filename.substr(_filename.size()-5, 5) == ".pipe") {
 		// Named pipe!
 		namedpipe = open(_filename.c_str(), O_RDONLY);
@@ -113,7 +129,8 @@ bool SatReader::read(JobDescription& desc) {
 
 	desc.endInitialization();
 
-	if (pipe != nullptr) pclose(pipe);
+	if (pipe != nullptr) fclose(pipe);
+	if (decompressorPid != -1) while (!Process::didChildExit(decompressorPid)) usleep(1000);
 	if (namedpipe != -1) close(namedpipe);
 
 	return isValidInput();
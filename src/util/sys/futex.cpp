@@ -0,0 +1,27 @@
+
+#include "futex.hpp"
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <time.h>
+
+namespace Futex {
+
+    int* address(std::atomic_int& word) {
+        static_assert(sizeof(std::atomic_int) == sizeof(int));
+        return reinterpret_cast<int*>(&word);
+    }
+
+    void wait(std::atomic_int& word, int expected, float timeoutSeconds) {
+        timespec timeout;
+        timeout.tv_sec = (time_t) timeoutSeconds;
+        timeout.tv_nsec = (long) ((timeoutSeconds - timeout.tv_sec) * 1000*1000*1000);
+        // Returns upon a wake-up, timeout, signal, or if the word differs from the expected value
+        syscall(SYS_futex, address(word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    }
+
+    void wake(std::atomic_int& word, int maxNumWaiters) {
+        syscall(SYS_futex, address(word), FUTEX_WAKE, maxNumWaiters, nullptr, nullptr, 0);
+    }
+}
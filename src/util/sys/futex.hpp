@@ -0,0 +1,46 @@
+
+#pragma once
+
+#include <atomic>
+#include <climits>
+
+// Blocking wait and notification on a 32-bit word via the Linux futex system call.
+// Since the futex operations used are not process-private, the word may reside in
+// shared memory which is mapped by several processes.
+namespace Futex {
+
+    // Blocks the calling thread as long as the word holds the expected value,
+    // until a wake() on the word or until the timeout (in seconds) expires.
+    // Returns immediately if the word does not hold the expected value.
+    void wait(std::atomic_int& word, int expected, float timeoutSeconds);
+
+    // Wakes up at most the given number of threads blocked on the word.
+    void wake(std::atomic_int& word, int maxNumWaiters = INT_MAX);
+}
+
+// A doorbell in shared memory: a producer rings it after making some state change
+// visible, and a consumer blocks until it is rung. The consumer first memorizes the
+// current ring count (peek()), then checks all state of interest, and then blocks
+// with waitUntilRung(memorizedCount) if nothing is to be done, so no ring can get lost.
+// The futex system call is skipped for rings if nobody is blocked on the doorbell.
+struct SharedMemoryDoorbell {
+
+    std::atomic_int numRings {0};
+    std::atomic_int numSleepers {0};
+
+    int peek() const {
+        return numRings.load(std::memory_order_seq_cst);
+    }
+
+    void ring() {
+        numRings.fetch_add(1, std::memory_order_seq_cst);
+        if (numSleepers.load(std::memory_order_seq_cst) > 0) Futex::wake(numRings);
+    }
+
+    void waitUntilRung(int lastSeenNumRings, float timeoutSeconds) {
+        numSleepers.fetch_add(1, std::memory_order_seq_cst);
+        Futex::wait(numRings, lastSeenNumRings, timeoutSeconds);
+        numSleepers.fetch_sub(1, std::memory_order_seq_cst);
+    }
+};
+static_assert(std::atomic_int::is_always_lock_free);
@@ -6,6 +6,8 @@
 #include <sys/resource.h>
 #include <sys/syscall.h>
 #include <sys/sysinfo.h>
+#include <sys/mman.h>
+#include <errno.h>
 #include <map>
 #include "util/assert.hpp"
 #include <ios>
@@ -13,7 +15,10 @@
 #include <fstream>
 #include <string>
 #include <set>
+#include <sstream>
+#include <cctype>
 #include <pthread.h>
+#include <linux/mempolicy.h>
 
 #include "util/sys/fileutils.hpp"
 #include "proc.hpp"
@@ -112,6 +117,20 @@ float Proc::getUptime() {
     return uptime;
 }
 
+int Proc::getNumRunningThreads() {
+    std::ifstream stat_stream("/proc/stat", std::ios_base::in);
+    std::string key;
+    while (stat_stream >> key) {
+        if (key == "procs_running") {
+            int numRunning;
+            stat_stream >> numRunning;
+            return numRunning;
+        }
+        std::getline(stat_stream, key);
+    }
+    return -1;
+}
+
 bool Proc::getThreadCpuRatio(long tid, double& cpuRatio, float& sysShare) {
    
     using std::ios_base;
@@ -258,3 +277,117 @@ long Proc::getRecursiveProportionalSetSizeKbs(pid_t pid) {
 
     return memory;
 }
+
+// Parses a list of the form "0-3,8,10-11"
+std::vector<int> Proc::parseCpuOrNodeList(const std::string& list) {
+    std::vector<int> elems;
+    std::istringstream iss(list);
+    std::string range;
+    while (std::getline(iss, range, ',')) {
+        if (range.empty() || !std::isdigit(range[0])) continue;
+        auto dashPos = range.find('-');
+        int first = std::stoi(range.substr(0, dashPos));
+        int last = dashPos == std::string::npos ? first : std::stoi(range.substr(dashPos+1));
+        for (int i = first; i <= last; i++) elems.push_back(i);
+    }
+    return elems;
+}
+
+std::vector<int> Proc::getNumaNodes() {
+    std::ifstream nodesStream("/sys/devices/system/node/online", std::ios_base::in);
+    std::string list;
+    std::vector<int> nodes;
+    if (nodesStream >> list) nodes = parseCpuOrNodeList(list);
+    if (nodes.empty()) nodes.push_back(0);
+    return nodes;
+}
+
+std::vector<int> Proc::getNumaNodeCpus(int node) {
+    std::ifstream cpusStream("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist", std::ios_base::in);
+    std::string list;
+    if (!(cpusStream >> list)) return std::vector<int>();
+    return parseCpuOrNodeList(list);
+}
+
+bool Proc::pinThisThreadToNumaNode(int node) {
+    auto cpus = getNumaNodeCpus(node);
+    if (cpus.empty() || node < 0 || node >= 8*(int)sizeof(unsigned long)) return false;
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    for (int cpu : cpus) CPU_SET(cpu, &cpuSet);
+    if (sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0) return false;
+    return setPreferredNumaNodeOfThisThread(node);
+}
+
+bool Proc::setPreferredNumaNodeOfThisThread(int node) {
+    if (node < 0) return syscall(SYS_set_mempolicy, MPOL_DEFAULT, nullptr, 0) == 0;
+    if (node >= 8*(int)sizeof(unsigned long)) return false;
+    unsigned long nodeMask = 1ul << node;
+    return syscall(SYS_set_mempolicy, MPOL_PREFERRED, &nodeMask, 8*sizeof(nodeMask)+1) == 0;
+}
+
+static bool getNumaNodeMask(const std::vector<int>& nodes, unsigned long& nodeMask) {
+    nodeMask = 0;
+    for (int node : nodes) {
+        if (node < 0 || node >= 8*(int)sizeof(unsigned long)) return false;
+        nodeMask |= 1ul << node;
+    }
+    return nodeMask != 0;
+}
+
+bool Proc::placeMemoryOnNumaNodes(const void* addr, size_t size, const std::vector<int>& nodes) {
+    unsigned long nodeMask;
+    if (!getNumaNodeMask(nodes, nodeMask) || size == 0) return false;
+    // The region must begin at a page boundary
+    size_t pageSize = sysconf(_SC_PAGESIZE);
+    size_t begin = ((size_t) addr) / pageSize * pageSize;
+    size_t length = ((size_t) addr) + size - begin;
+    int mode = nodes.size() == 1 ? MPOL_PREFERRED : MPOL_INTERLEAVE;
+    // MPOL_MF_MOVE skips the pages mapped by other processes as well, e.g., the pages
+    // of a formula in shared memory. MPOL_MF_MOVE_ALL migrates them but requires
+    // CAP_SYS_NICE. With MPOL_MF_STRICT, the call fails if pages remain misplaced.
+    if (syscall(SYS_mbind, begin, length, mode, &nodeMask, 8*sizeof(nodeMask)+1, 
+            MPOL_MF_MOVE_ALL | MPOL_MF_STRICT) == 0) return true;
+    if (errno != EPERM) return false;
+    return syscall(SYS_mbind, begin, length, mode, &nodeMask, 8*sizeof(nodeMask)+1, 
+        MPOL_MF_MOVE | MPOL_MF_STRICT) == 0;
+}
+
+void* Proc::allocateOnNumaNodes(size_t size, const std::vector<int>& nodes) {
+    unsigned long nodeMask;
+    if (!getNumaNodeMask(nodes, nodeMask) || size == 0) return nullptr;
+    void* addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (addr == MAP_FAILED) return nullptr;
+    // No pages are present yet: they are placed as they are touched
+    int mode = nodes.size() == 1 ? MPOL_PREFERRED : MPOL_INTERLEAVE;
+    if (syscall(SYS_mbind, addr, size, mode, &nodeMask, 8*sizeof(nodeMask)+1, 0) != 0) {
+        munmap(addr, size);
+        return nullptr;
+    }
+    return addr;
+}
+
+void Proc::freeOnNumaNodes(void* addr, size_t size) {
+    if (addr != nullptr) munmap(addr, size);
+}
+
+std::vector<unsigned long> Proc::getNumaPagesPerNode(pid_t pid) {
+    std::ifstream numaMaps("/proc/" + std::to_string(pid) + "/numa_maps", std::ios_base::in);
+    return getNumaPagesPerNode(numaMaps);
+}
+
+std::vector<unsigned long> Proc::getNumaPagesPerNode(std::istream& numaMaps) {
+    std::vector<unsigned long> pages;
+    // Each line describes one mapping, e.g.:
+    // "7f2c3a000000 interleave:0-1 file=/dev/shm/x mapped=512 N0=256 N1=256 kernelpagesize_kB=4"
+    std::string word;
+    while (numaMaps >> word) {
+        if (word.size() < 4 || word[0] != 'N' || !std::isdigit(word[1])) continue;
+        auto eqPos = word.find('=');
+        if (eqPos == std::string::npos) continue;
+        size_t node = std::stoul(word.substr(1, eqPos-1));
+        if (node >= pages.size()) pages.resize(node+1, 0);
+        pages[node] += std::stoul(word.substr(eqPos+1));
+    }
+    return pages;
+}
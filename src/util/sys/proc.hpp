@@ -4,6 +4,9 @@
 
 #include <unistd.h>
 #include <map>
+#include <vector>
+#include <string>
+#include <istream>
 
 #include "util/sys/threading.hpp"
 
@@ -47,6 +50,36 @@ public:
 
     static float getUptime();
 
+    // Returns the number of threads currently runnable on this machine (or -1 on failure).
+    static int getNumRunningThreads();
+
+    // NUMA topology and placement. Nodes are numbered as in /sys/devices/system/node.
+    // Returns the online NUMA nodes of this machine (a single node 0 if unknown).
+    static std::vector<int> getNumaNodes();
+    // Returns the CPUs belonging to the given NUMA node.
+    static std::vector<int> getNumaNodeCpus(int node);
+    // Restricts the calling thread to the CPUs of the given node and lets its
+    // future memory allocations prefer this node. Returns false on failure.
+    static bool pinThisThreadToNumaNode(int node);
+    // Lets the future memory allocations of the calling thread prefer the given node,
+    // or restores the default policy if node < 0. Returns false on failure.
+    static bool setPreferredNumaNodeOfThisThread(int node);
+    // Places the pages of the given memory region on the given node(s) -
+    // interleaved if there are several nodes - and migrates the pages already present,
+    // including pages shared with other processes where permitted. Returns false
+    // if the policy could not be set or some pages could not be migrated.
+    static bool placeMemoryOnNumaNodes(const void* addr, size_t size, const std::vector<int>& nodes);
+    // Maps private memory of the given size whose pages will be placed on the given node(s)
+    // as in placeMemoryOnNumaNodes. Returns nullptr on failure.
+    static void* allocateOnNumaNodes(size_t size, const std::vector<int>& nodes);
+    static void freeOnNumaNodes(void* addr, size_t size);
+    // Returns the number of pages of the given process which reside on each NUMA node.
+    static std::vector<unsigned long> getNumaPagesPerNode(pid_t pid);
+    // Same, reading the contents of a numa_maps file from the given stream.
+    static std::vector<unsigned long> getNumaPagesPerNode(std::istream& numaMaps);
+    // Parses a list of CPUs or nodes as in sysfs, e.g. "0-3,8,10-11".
+    static std::vector<int> parseCpuOrNodeList(const std::string& list);
+
 };
 
 #endif
\ No newline at end of file
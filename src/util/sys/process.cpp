@@ -9,6 +9,7 @@
 #include <execinfo.h>
 #include <signal.h>
 #include <sys/syscall.h>
+#include <spawn.h>
 
 #include "util/assert.hpp"
 
@@ -119,6 +120,46 @@ pid_t Process::createChild() {
     return res;
 }
 
+pid_t Process::spawnChild(char* const argv[], int stdoutFd) {
+
+    // posix_spawn creates the child without duplicating this process' page tables
+    // (glibc uses clone(CLONE_VM|CLONE_VFORK)), so the cost of launching a program
+    // does not grow with the memory held by this process, and no copy-on-write
+    // overcommit is charged to the system in between fork and exec.
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (stdoutFd >= 0 && stdoutFd != STDOUT_FILENO) {
+        posix_spawn_file_actions_adddup2(&actions, stdoutFd, STDOUT_FILENO);
+    }
+#if __GLIBC_PREREQ(2, 34)
+    // Only pass stdin, stdout and stderr (not, e.g., MPI's sockets and shared memory)
+    posix_spawn_file_actions_addclosefrom_np(&actions, STDERR_FILENO+1);
+#endif
+
+    // Start with an empty signal mask and default signal handling
+    posix_spawnattr_t attr;
+    posix_spawnattr_init(&attr);
+    sigset_t sigs;
+    sigemptyset(&sigs);
+    posix_spawnattr_setsigmask(&attr, &sigs);
+    sigfillset(&sigs);
+    posix_spawnattr_setsigdefault(&attr, &sigs);
+    posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF);
+
+    pid_t res;
+    int err = posix_spawnp(&res, argv[0], &actions, &attr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attr);
+
+    if (err != 0) {
+        LOG(V0_CRIT, "[ERROR] spawning %s failed, errno %i\n", argv[0], err);
+        return -1;
+    }
+    auto lock = _children_mutex.getLock();
+    _children.insert(res);
+    return res;
+}
+
 void Process::terminate(pid_t childpid) {
     sendSignal(childpid, SIGTERM);
 }
@@ -29,6 +29,11 @@ public:
     static void init(int rank, const std::string& traceDir = ".", bool leafProcess = false);
     
     static int createChild();
+    // Launches the program argv[0] (searched in PATH if it has no slash) with the
+    // given arguments in a new child process without forking this process.
+    // Only stdin, stdout (or stdoutFd, if given) and stderr are passed on.
+    // Returns the child's PID or -1 if the program could not be launched.
+    static pid_t spawnChild(char* const argv[], int stdoutFd = -1);
     
     static void terminate(pid_t childpid);
     static void hardkill(pid_t childpid);
@@ -0,0 +1,46 @@
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Bounded FIFO queue of trivially copyable records which resides in shared memory,
+// with a single producer and a single consumer which may live in different processes.
+// Pushing and popping are wait-free; blocking until there is something to pop
+// can be realized with a SharedMemoryDoorbell (see futex.hpp).
+template <typename T, int Capacity>
+struct SharedMemoryQueue {
+
+    static_assert(std::is_trivially_copyable<T>::value);
+    static_assert(Capacity > 0 && (Capacity & (Capacity-1)) == 0, "capacity must be a power of two");
+    static_assert(std::atomic<uint32_t>::is_always_lock_free);
+
+    // Number of records ever popped (written by the consumer only)
+    std::atomic<uint32_t> numPopped {0};
+    // Number of records ever pushed (written by the producer only)
+    std::atomic<uint32_t> numPushed {0};
+    T slots[Capacity];
+
+    // Returns false (without effect) if the queue is full.
+    bool push(const T& record) {
+        uint32_t pushed = numPushed.load(std::memory_order_relaxed);
+        if (pushed - numPopped.load(std::memory_order_acquire) >= Capacity) return false;
+        slots[pushed % Capacity] = record;
+        numPushed.store(pushed+1, std::memory_order_release);
+        return true;
+    }
+
+    // Returns false (without effect) if the queue is empty.
+    bool pop(T& record) {
+        uint32_t popped = numPopped.load(std::memory_order_relaxed);
+        if (popped == numPushed.load(std::memory_order_acquire)) return false;
+        record = slots[popped % Capacity];
+        numPopped.store(popped+1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const {
+        return numPopped.load(std::memory_order_acquire) == numPushed.load(std::memory_order_acquire);
+    }
+};
@@ -301,6 +301,7 @@ void Worker::checkStats(float time) {
         if (_job_db.hasActiveJob()) {
             Job& job = _job_db.getActive();
             job.appl_dumpStats();
+            if (_params.adaptSolverThreads()) adaptNumThreads(job);
             if (job.getJobTree().isRoot()) {
                 std::string commStr = "";
                 for (size_t i = 0; i < job.getJobComm().size(); i++) {
@@ -322,6 +323,23 @@ void Worker::checkStats(float time) {
     }
 }
 
+void Worker::adaptNumThreads(Job& job) {
+    // Threads runnable right now on this machine, except for this thread
+    int numRunning = Proc::getNumRunningThreads() - 1;
+    if (numRunning < 0) return;
+    int numIdleCores = (int) std::thread::hardware_concurrency() - numRunning;
+    int nbThreads = job.getNumActiveThreads();
+    if (numIdleCores < 0 && nbThreads > 1) {
+        // Machine is oversubscribed: give up a thread
+        job.setNumActiveThreads(nbThreads-1);
+    } else if (numIdleCores > 0 && nbThreads < job.getNumThreads()) {
+        // Some core is idle: take it
+        job.setNumActiveThreads(nbThreads+1);
+    } else return;
+    LOG(V4_VVER, "%s : %i runnable threads, %i cores - use %i threads\n", job.toStr(), 
+        numRunning, (int) std::thread::hardware_concurrency(), job.getNumActiveThreads());
+}
+
 void Worker::checkJobs() {
 
     // Load and try to adopt pending root reactivation request
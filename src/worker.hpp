@@ -99,6 +99,7 @@ private:
 
     void checkStats(float time);
     void checkJobs();
+    void adaptNumThreads(Job& job);
     void checkActiveJob();
     void publishAndResetSysState();
 